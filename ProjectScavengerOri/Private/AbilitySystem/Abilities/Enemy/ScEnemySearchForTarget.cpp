@@ -10,7 +10,12 @@
 #include "GameplayTags/ScGameplayTags.h"
 #include "Abilities/Tasks/AbilityTask_WaitDelay.h"
 #include "Libraries/ScGASFunctionLibrary.h"
+#include "Managers/CharactersManager.h"
+#include "Managers/AISignificanceManager.h"
+#include "Managers/EnemyPathService.h"
+#include "Managers/FlowFieldManager.h"
 #include "Tasks/AITask_MoveTo.h"
+#include "TimerManager.h"
 
 UScEnemySearchForTarget::UScEnemySearchForTarget()
 {
@@ -37,14 +42,35 @@ void UScEnemySearchForTarget::ActivateAbility(const FGameplayAbilitySpecHandle H
 	WaitGameplayEventTask->StartActivation();
 }
 
+void UScEnemySearchForTarget::EndAbility(const FGameplayAbilitySpecHandle Handle,
+	const FGameplayAbilityActorInfo* ActorInfo, const FGameplayAbilityActivationInfo ActivationInfo,
+	bool bReplicateEndAbility, bool bWasCancelled)
+{
+	// 清理计时器和休眠登记，避免技能结束后仍被回调。
+	if (OwningEnemy.IsValid())
+	{
+		OwningEnemy->GetWorldTimerManager().ClearTimer(SearchDelayTimer);
+	}
+	CancelSleep();
+	StopPathRequest();
+	StopFlowFieldChase();
+	Super::EndAbility(Handle, ActorInfo, ActivationInfo, bReplicateEndAbility, bWasCancelled);
+}
+
 void UScEnemySearchForTarget::StartSearch()
 {
 	if (bDrawDebugs) GEngine->AddOnScreenDebugMessage(-1, 3.0f, FColor::Red, FString::Printf(TEXT("C++ Start Search.")));
 	if (!OwningEnemy.IsValid()) return;
-	const float SearchDelay = FMath::RandRange(OwningEnemy->MinAttackDelay, OwningEnemy->MaxAttackDelay);
-	SearchDelayTask = UAbilityTask_WaitDelay::WaitDelay(this, SearchDelay);
-	SearchDelayTask->OnFinish.AddDynamic(this, &ThisClass::SearchOn);
-	SearchDelayTask->Activate();	
+	// 被其他事件提前唤醒时，先取消休眠登记。
+	CancelSleep();
+	StopFlowFieldChase();
+	float SearchDelay = FMath::RandRange(OwningEnemy->MinAttackDelay, OwningEnemy->MaxAttackDelay);
+	// 远离玩家或不可见的敌人按重要度放慢索敌节奏。
+	if (const UAISignificanceManager* SignificanceManager = OwningEnemy->GetWorld()->GetSubsystem<UAISignificanceManager>())
+	{
+		SearchDelay *= SignificanceManager->GetSearchDelayScale(OwningEnemy.Get());
+	}
+	OwningEnemy->GetWorldTimerManager().SetTimer(SearchDelayTimer, this, &ThisClass::SearchOn, SearchDelay, false);
 }
 
 void UScEnemySearchForTarget::EndAttackEventReceived(FGameplayEventData Payload)
@@ -60,16 +86,47 @@ void UScEnemySearchForTarget::SearchOn()
 	const FVector SearchOrigin = GetAvatarActorFromActorInfo()->GetActorLocation();
 	FClosestActorWithTagResult ClosestActorResult = UScGASFunctionLibrary::FindClosestActorWithTag(GetAvatarActorFromActorInfo(), SearchOrigin, ScTags::Player);
 	TargetBaseCharacter = Cast<AScCharacterBase>(ClosestActorResult.Actor);
-	if (!TargetBaseCharacter.IsValid())
+	// 找不到存活的目标时休眠，不再重复创建延迟任务轮询。
+	if (!TargetBaseCharacter.IsValid() || !TargetBaseCharacter->IsAlive())
+	{
+		SleepUntilTargetAvailable();
+		return;
+	}
+	MoveToTargetAndAttack();
+}
+
+void UScEnemySearchForTarget::SleepUntilTargetAvailable()
+{
+	if (!OwningEnemy.IsValid()) return;
+	UCharactersManager* CharactersManager = OwningEnemy->GetWorld()->GetSubsystem<UCharactersManager>();
+	// 管理器无效时退回到延迟重试。
+	if (!IsValid(CharactersManager))
 	{
 		StartSearch();
 		return;
 	}
-	if (TargetBaseCharacter->IsAlive())
+	bWaitingForTarget = true;
+	CharactersManager->AddSearchWaiter(OwningEnemy.Get(), FSimpleDelegate::CreateUObject(this, &ThisClass::OnTargetAvailable));
+	if (bDrawDebugs) GEngine->AddOnScreenDebugMessage(-1, 3.0f, FColor::Red, FString::Printf(TEXT("C++ Search Sleep.")));
+}
+
+void UScEnemySearchForTarget::CancelSleep()
+{
+	if (!bWaitingForTarget) return;
+	bWaitingForTarget = false;
+	if (!OwningEnemy.IsValid()) return;
+	if (UCharactersManager* CharactersManager = OwningEnemy->GetWorld()->GetSubsystem<UCharactersManager>())
 	{
-		MoveToTargetAndAttack();
+		CharactersManager->RemoveSearchWaiter(OwningEnemy.Get());
 	}
-	else
+}
+
+void UScEnemySearchForTarget::OnTargetAvailable()
+{
+	// 管理器唤醒时已经移除了登记。
+	bWaitingForTarget = false;
+	// 被击飞中的敌人会在着陆时通过EndAttack事件重新搜索。
+	if (OwningEnemy.IsValid() && !OwningEnemy->bIsBeingLaunched)
 	{
 		StartSearch();
 	}
@@ -83,11 +140,129 @@ void UScEnemySearchForTarget::MoveToTargetAndAttack()
 		StartSearch();
 		return;
 	}
+	if (OwningEnemy->bUseFlowField && StartFlowFieldChase()) return;
+	RequestChasePath();
+}
+
+void UScEnemySearchForTarget::RequestChasePath()
+{
+	// 优先使用寻路服务，同一帧追击同一玩家的敌人合并为少量异步寻路。
+	UEnemyPathService* PathService = OwningEnemy->GetWorld()->GetSubsystem<UEnemyPathService>();
+	if (IsValid(PathService) && PathService->RequestPath(OwningAIController.Get(), TargetBaseCharacter.Get(), FOnEnemyPathReady::CreateUObject(this, &ThisClass::OnPathReady)))
+	{
+		return;
+	}
 	MoveToLocationOrActorTask = UAITask_MoveTo::AIMoveTo(OwningAIController.Get(), FVector(), TargetBaseCharacter.Get(), OwningEnemy->AcceptanceRadius);
 	MoveToLocationOrActorTask->OnMoveTaskFinished.AddUObject(this, &ThisClass::AttackTarget);
 	MoveToLocationOrActorTask->ConditionalPerformMove();
 }
 
+bool UScEnemySearchForTarget::StartFlowFieldChase()
+{
+	UFlowFieldManager* FlowFieldManager = OwningEnemy->GetWorld()->GetSubsystem<UFlowFieldManager>();
+	if (!IsValid(FlowFieldManager)) return false;
+	FVector Waypoint;
+	if (!FlowFieldManager->GetWaypoint(OwningEnemy->GetNavAgentLocation(), FlowFieldLookAheadCells, Waypoint)) return false;
+	OwningEnemy->GetWorldTimerManager().SetTimer(FlowFieldChaseTimer, this, &ThisClass::FlowFieldChaseStep, FlowFieldStepInterval, true);
+	FlowFieldChaseStep();
+	return true;
+}
+
+void UScEnemySearchForTarget::FlowFieldChaseStep()
+{
+	if (!OwningEnemy.IsValid() || !OwningAIController.IsValid())
+	{
+		StopFlowFieldChase();
+		return;
+	}
+	// 被击飞中的敌人会在着陆时通过EndAttack事件重新搜索。
+	if (OwningEnemy->bIsBeingLaunched)
+	{
+		StopFlowFieldChase();
+		return;
+	}
+	if (!OwningEnemy->IsAlive() || !TargetBaseCharacter.IsValid() || !TargetBaseCharacter->IsAlive())
+	{
+		StartSearch();
+		return;
+	}
+	// 进入接受半径后停下攻击，与MoveTo成功的处理一致。
+	if (FVector::Dist2D(OwningEnemy->GetActorLocation(), TargetBaseCharacter->GetActorLocation()) <= OwningEnemy->AcceptanceRadius)
+	{
+		StopFlowFieldChase();
+		OwningAIController->StopMovement();
+		AttackTarget(EPathFollowingResult::Success, OwningAIController.Get());
+		return;
+	}
+	// 目标点就在前方几个格子，直接移动，不需要寻路。
+	UFlowFieldManager* FlowFieldManager = OwningEnemy->GetWorld()->GetSubsystem<UFlowFieldManager>();
+	FVector Waypoint;
+	if (!IsValid(FlowFieldManager) || !FlowFieldManager->GetWaypoint(OwningEnemy->GetNavAgentLocation(), FlowFieldLookAheadCells, Waypoint))
+	{
+		StopFlowFieldChase();
+		RequestChasePath();
+		return;
+	}
+	OwningAIController->MoveToLocation(Waypoint, -1.0f, false, false);
+}
+
+void UScEnemySearchForTarget::StopFlowFieldChase()
+{
+	if (!OwningEnemy.IsValid()) return;
+	OwningEnemy->GetWorldTimerManager().ClearTimer(FlowFieldChaseTimer);
+}
+
+void UScEnemySearchForTarget::OnPathReady(FNavPathSharedPtr Path)
+{
+	if (!IsActive()) return;
+	if (!OwningEnemy.IsValid() || !OwningAIController.IsValid() || !TargetBaseCharacter.IsValid()) return;
+	// 寻路失败时与AIMoveTo失败一样重新搜索。
+	if (!Path.IsValid())
+	{
+		StartSearch();
+		return;
+	}
+	// 与AIMoveTo的默认设置保持一致。
+	FAIMoveRequest MoveRequest(TargetBaseCharacter.Get());
+	MoveRequest.SetAcceptanceRadius(OwningEnemy->AcceptanceRadius);
+	// 新请求会中止旧的移动，先清空ID，避免把中止回调当成自己的结果。
+	MoveRequestID = FAIRequestID::InvalidRequest;
+	MoveRequestID = OwningAIController->RequestMove(MoveRequest, Path);
+	if (!MoveRequestID.IsValid())
+	{
+		StartSearch();
+		return;
+	}
+	UPathFollowingComponent* PathFollowingComp = OwningAIController->GetPathFollowingComponent();
+	if (IsValid(PathFollowingComp) && !MoveFinishedHandle.IsValid())
+	{
+		MoveFinishedHandle = PathFollowingComp->OnRequestFinished.AddUObject(this, &ThisClass::OnMoveRequestFinished);
+	}
+}
+
+void UScEnemySearchForTarget::OnMoveRequestFinished(FAIRequestID RequestID, const FPathFollowingResult& Result)
+{
+	// 路径跟随组件是共享的，只处理自己发起的请求。
+	if (!MoveRequestID.IsValid() || RequestID != MoveRequestID) return;
+	MoveRequestID = FAIRequestID::InvalidRequest;
+	AttackTarget(Result.Code, OwningAIController.Get());
+}
+
+void UScEnemySearchForTarget::StopPathRequest()
+{
+	MoveRequestID = FAIRequestID::InvalidRequest;
+	if (!OwningAIController.IsValid()) return;
+	if (UEnemyPathService* PathService = OwningAIController->GetWorld()->GetSubsystem<UEnemyPathService>())
+	{
+		PathService->CancelRequests(OwningAIController.Get());
+	}
+	if (UPathFollowingComponent* PathFollowingComp = OwningAIController->GetPathFollowingComponent())
+	{
+		PathFollowingComp->OnRequestFinished.Remove(MoveFinishedHandle);
+	}
+	MoveFinishedHandle.Reset();
+}
+
 void UScEnemySearchForTarget::AttackTarget(TEnumAsByte<EPathFollowingResult::Type> Result, AAIController* AIController)
 {
 	// 如果敌人因某种原因失败，返回并重新搜索。
@@ -15,8 +15,8 @@ AScCharacterBase::AScCharacterBase()
 {
 	PrimaryActorTick.bCanEverTick = false;
 
-	// Tick and refresh bone transforms whether rendered or not - for bone updates on a dedicated sever.
-	GetMesh()->VisibilityBasedAnimTickOption = EVisibilityBasedAnimTickOption::AlwaysTickPoseAndRefreshBones;
+	// 不被渲染时（包括专用服务器）只在播放蒙太奇时Tick和刷新骨骼，需要时在BeginPlay中按bAlwaysRefreshBones切换。
+	GetMesh()->VisibilityBasedAnimTickOption = EVisibilityBasedAnimTickOption::OnlyTickMontagesAndRefreshBonesWhenPlayingMontages;
 
 }
 
@@ -36,6 +36,11 @@ UAbilitySystemComponent* AScCharacterBase::GetAbilitySystemComponent() const
 void AScCharacterBase::HandleRespawn()
 {
 	bAlive = true;
+	// 通知管理器，玩家复活时会唤醒休眠的索敌者。
+	if (UCharactersManager* Subsystem = GetWorld()->GetSubsystem<UCharactersManager>())
+	{
+		Subsystem->NotifyCharacterRespawned(this);
+	}
 }
 
 void AScCharacterBase::ResetAttributes()
@@ -99,6 +104,11 @@ void AScCharacterBase::HandleDeath()
 void AScCharacterBase::BeginPlay()
 {
 	Super::BeginPlay();
+	// 放在注册之前，这样各管理器缓存的是最终的默认值。
+	if (bAlwaysRefreshBones)
+	{
+		GetMesh()->VisibilityBasedAnimTickOption = EVisibilityBasedAnimTickOption::AlwaysTickPoseAndRefreshBones;
+	}
 	// 注册到管理器。
 	if (UCharactersManager* Subsystem = GetWorld()->GetSubsystem<UCharactersManager>())
 	{
@@ -7,6 +7,7 @@
 #include "AbilitySystem/ScAbilitySystemComponent.h"
 #include "AbilitySystem/ScAttributeSet.h"
 #include "Managers/CharactersManager.h"
+#include "Managers/AISignificanceManager.h"
 #include "AIController.h"
 #include "GameplayTags/ScGameplayTags.h"
 
@@ -61,6 +62,11 @@ void AScEnemyCharacter::HandleDeath()
 void AScEnemyCharacter::BeginPlay()
 {
 	Super::BeginPlay();
+	// 注册到重要度管理器，按与玩家的距离和可见性降低更新频率。
+	if (UAISignificanceManager* SignificanceManager = GetWorld()->GetSubsystem<UAISignificanceManager>())
+	{
+		SignificanceManager->RegCharacter(this);
+	}
 
 	if (IsValid(GetAbilitySystemComponent()))
 	{
@@ -102,6 +108,10 @@ void AScEnemyCharacter::EndPlay(const EEndPlayReason::Type EndPlayReason)
 	{
 		Subsystem->DeregEnemyCharacter(this);
 	}
+	if (UAISignificanceManager* SignificanceManager = GetWorld()->GetSubsystem<UAISignificanceManager>())
+	{
+		SignificanceManager->DeregCharacter(this);
+	}
 	Super::EndPlay(EndPlayReason);
 }
 
@@ -14,6 +14,8 @@
 AScPlayerCharacter::AScPlayerCharacter()
 {
 	PrimaryActorTick.bCanEverTick = false;
+	// 玩家数量少，技能可能随时读取插槽位置，保持始终刷新骨骼。
+	bAlwaysRefreshBones = true;
 
 	GetCapsuleComponent()->InitCapsuleSize(42.0f, 96.0f);
 
@@ -0,0 +1,309 @@
+// Copyright (C) 2026 Kahyee Studio. All rights reserved.
+
+
+#include "Managers/AISignificanceManager.h"
+#include "AIController.h"
+#include "BrainComponent.h"
+#include "Components/SkeletalMeshComponent.h"
+#include "Engine/World.h"
+#include "GameFramework/Character.h"
+#include "GameFramework/CharacterMovementComponent.h"
+#include "GameFramework/PlayerController.h"
+#include "TimerManager.h"
+
+UAISignificanceManager::UAISignificanceManager()
+{
+	// 默认值，可在DefaultGame.ini中覆盖。
+	HighSettings.MaxDistance = 2500.0f;
+	
+	MediumSettings.MaxDistance = 6000.0f;
+	MediumSettings.SearchDelayScale = 2.0f;
+	MediumSettings.MovementTickInterval = 1.0f / 30.0f;
+	MediumSettings.AnimTickInterval = 1.0f / 30.0f;
+	MediumSettings.bOverrideAnimTickOption = true;
+	// 播放蒙太奇（攻击）时仍刷新骨骼，近战插槽依然可用。
+	MediumSettings.AnimTickOption = EVisibilityBasedAnimTickOption::OnlyTickMontagesAndRefreshBonesWhenPlayingMontages;
+	MediumSettings.BrainTickInterval = 0.1f;
+	
+	LowSettings.SearchDelayScale = 4.0f;
+	LowSettings.MovementTickInterval = 0.1f;
+	LowSettings.AnimTickInterval = 0.25f;
+	LowSettings.bOverrideAnimTickOption = true;
+	// 不可见时只推进蒙太奇，攻击等蒙太奇的通知和结束回调照常触发，不会卡住AI。
+	LowSettings.AnimTickOption = EVisibilityBasedAnimTickOption::OnlyTickMontagesWhenNotRendered;
+	LowSettings.BrainTickInterval = 0.5f;
+}
+
+void UAISignificanceManager::RegCharacter(ACharacter* InCharacter)
+{
+	if (!IsValid(InCharacter)) return;
+	if (EntryIndices.Contains(InCharacter)) return;
+	FAISignificanceEntry& Entry = Entries.AddDefaulted_GetRef();
+	Entry.Character = InCharacter;
+	Entry.Key = InCharacter;
+	if (const USkeletalMeshComponent* Mesh = InCharacter->GetMesh())
+	{
+		Entry.DefaultAnimTickOption = Mesh->VisibilityBasedAnimTickOption;
+	}
+	EntryIndices.Add(InCharacter, Entries.Num() - 1);
+	// 第一个角色注册时才启动计时器，编辑器世界等没有AI的世界不产生开销。
+	UWorld* World = GetWorld();
+	if (IsValid(World) && !World->GetTimerManager().IsTimerActive(UpdateTimer))
+	{
+		World->GetTimerManager().SetTimer(UpdateTimer, this, &ThisClass::UpdateSignificance, UpdateInterval, true);
+	}
+}
+
+void UAISignificanceManager::DeregCharacter(ACharacter* InCharacter)
+{
+	if (const int32* Index = EntryIndices.Find(InCharacter))
+	{
+		RemoveEntryAt(*Index);
+	}
+}
+
+EAISignificance UAISignificanceManager::GetSignificance(const ACharacter* InCharacter) const
+{
+	const int32* Index = EntryIndices.Find(InCharacter);
+	return Index ? Entries[*Index].Significance : EAISignificance::High;
+}
+
+float UAISignificanceManager::GetSearchDelayScale(const ACharacter* InCharacter) const
+{
+	const int32* Index = EntryIndices.Find(InCharacter);
+	return Index ? GetSettings(Entries[*Index].Significance).SearchDelayScale : 1.0f;
+}
+
+const FAISignificanceSettings& UAISignificanceManager::GetSettings(EAISignificance InSignificance) const
+{
+	switch (InSignificance)
+	{
+	case EAISignificance::High: return HighSettings;
+	case EAISignificance::Medium: return MediumSettings;
+	default: return LowSettings;
+	}
+}
+
+void UAISignificanceManager::Deinitialize()
+{
+	if (UWorld* World = GetWorld())
+	{
+		World->GetTimerManager().ClearTimer(UpdateTimer);
+	}
+	Entries.Empty();
+	EntryIndices.Empty();
+	FullRateBoneRefreshCount = 0;
+	Super::Deinitialize();
+}
+
+void UAISignificanceManager::UpdateSignificance()
+{
+	UWorld* World = GetWorld();
+	if (!IsValid(World)) return;
+	if (Entries.IsEmpty())
+	{
+		World->GetTimerManager().ClearTimer(UpdateTimer);
+		return;
+	}
+	// 收集所有玩家Pawn的位置，服务器上包括远程玩家。
+	TArray<FVector, TInlineAllocator<4>> PlayerLocations;
+	for (FConstPlayerControllerIterator It = World->GetPlayerControllerIterator(); It; ++It)
+	{
+		const APlayerController* PlayerController = It->Get();
+		if (!IsValid(PlayerController)) continue;
+		if (const APawn* PlayerPawn = PlayerController->GetPawn())
+		{
+			PlayerLocations.Add(PlayerPawn->GetActorLocation());
+		}
+	}
+	// 倒序遍历，RemoveEntryAt会把末尾元素换到当前位置。
+	for (int32 Index = Entries.Num() - 1; Index >= 0; --Index)
+	{
+		FAISignificanceEntry& Entry = Entries[Index];
+		const ACharacter* Character = Entry.Character.Get();
+		if (!IsValid(Character))
+		{
+			RemoveEntryAt(Index);
+			continue;
+		}
+		const EAISignificance NewSignificance = CalculateSignificance(Character, PlayerLocations);
+		// 只在换桶时修改组件设置，有骨骼刷新申请的角色按最新的渲染状态重新计算刷新间隔。
+		if (NewSignificance == Entry.Significance)
+		{
+			if (Entry.BoneRefreshRequests > 0)
+			{
+				ApplyAnimSettings(Entry);
+			}
+			continue;
+		}
+		Entry.Significance = NewSignificance;
+		ApplySettings(Entry);
+	}
+}
+
+EAISignificance UAISignificanceManager::CalculateSignificance(const ACharacter* InCharacter, TConstArrayView<FVector> PlayerLocations) const
+{
+	// 没有玩家时全部降到最低。
+	if (PlayerLocations.IsEmpty()) return EAISignificance::Low;
+	// 比较距离时不开平方。
+	const FVector Location = InCharacter->GetActorLocation();
+	float ClosestDistanceSq = TNumericLimits<float>::Max();
+	for (const FVector& PlayerLocation : PlayerLocations)
+	{
+		ClosestDistanceSq = FMath::Min(ClosestDistanceSq, FVector::DistSquared(Location, PlayerLocation));
+	}
+	EAISignificance Significance = EAISignificance::Low;
+	if (ClosestDistanceSq <= FMath::Square(HighSettings.MaxDistance))
+	{
+		Significance = EAISignificance::High;
+	}
+	else if (ClosestDistanceSq <= FMath::Square(MediumSettings.MaxDistance))
+	{
+		Significance = EAISignificance::Medium;
+	}
+	// 屏幕上可见的角色提升一个桶。
+	if (Significance != EAISignificance::High && InCharacter->WasRecentlyRendered(RecentlyRenderedTolerance))
+	{
+		Significance = static_cast<EAISignificance>(static_cast<uint8>(Significance) - 1);
+	}
+	return Significance;
+}
+
+void UAISignificanceManager::ApplySettings(const FAISignificanceEntry& Entry) const
+{
+	ACharacter* Character = Entry.Character.Get();
+	if (!IsValid(Character)) return;
+	const FAISignificanceSettings& Settings = GetSettings(Entry.Significance);
+	if (UCharacterMovementComponent* MovementComp = Character->GetCharacterMovement())
+	{
+		MovementComp->SetComponentTickInterval(Settings.MovementTickInterval);
+	}
+	ApplyAnimSettings(Entry);
+	// StateTree和行为树都继承自BrainComponent，挂在AIController上。
+	AAIController* AIController = Cast<AAIController>(Character->GetController());
+	if (!AIController) return;
+	// 自己管理Tick间隔的控制器由它合并桶的间隔，这里不再直接修改。
+	if (IAISignificanceBrainTickOwner* TickOwner = Cast<IAISignificanceBrainTickOwner>(AIController))
+	{
+		TickOwner->OnSignificanceChanged(Entry.Significance);
+	}
+	else if (UBrainComponent* BrainComp = AIController->FindComponentByClass<UBrainComponent>())
+	{
+		BrainComp->SetComponentTickInterval(Settings.BrainTickInterval);
+	}
+}
+
+void UAISignificanceManager::ApplyAnimSettings(const FAISignificanceEntry& Entry) const
+{
+	ACharacter* Character = Entry.Character.Get();
+	if (!IsValid(Character)) return;
+	USkeletalMeshComponent* Mesh = Character->GetMesh();
+	if (!IsValid(Mesh)) return;
+	const FAISignificanceSettings& Settings = GetSettings(Entry.Significance);
+	// 有骨骼刷新申请时，无论是否被渲染都刷新骨骼，占用全速预算的角色每帧刷新。
+	if (Entry.BoneRefreshRequests > 0)
+	{
+		Mesh->VisibilityBasedAnimTickOption = EVisibilityBasedAnimTickOption::AlwaysTickPoseAndRefreshBones;
+		// 超出预算时只对没有被渲染的角色或专用服务器降低频率，且不高于桶本身的频率。
+		const bool bThrottle = !Entry.bFullRateBoneRefresh
+			&& (Character->GetNetMode() == NM_DedicatedServer || !Mesh->WasRecentlyRendered(RecentlyRenderedTolerance));
+		const float Interval = Entry.bFullRateBoneRefresh ? 0.0f : Settings.AnimTickInterval;
+		Mesh->SetComponentTickInterval(bThrottle ? FMath::Max(Interval, OverBudgetBoneRefreshInterval) : Interval);
+		return;
+	}
+	Mesh->SetComponentTickInterval(Settings.AnimTickInterval);
+	const bool bUseDefault = Entry.Significance == EAISignificance::High || !Settings.bOverrideAnimTickOption;
+	Mesh->VisibilityBasedAnimTickOption = bUseDefault ? Entry.DefaultAnimTickOption : Settings.AnimTickOption;
+}
+
+void UAISignificanceManager::AcquireBoneRefresh(ACharacter* InCharacter)
+{
+	const int32* Index = EntryIndices.Find(InCharacter);
+	if (!Index) return;
+	FAISignificanceEntry& Entry = Entries[*Index];
+	// 重叠的申请只计数。
+	if (Entry.BoneRefreshRequests++ > 0) return;
+	// 预算已满时，从重要度更低的角色手里抢占全速预算。
+	if (FullRateBoneRefreshCount >= MaxFullRateBoneRefreshes)
+	{
+		FAISignificanceEntry* WorstEntry = nullptr;
+		for (FAISignificanceEntry& Other : Entries)
+		{
+			if (!Other.bFullRateBoneRefresh || Other.Significance <= Entry.Significance) continue;
+			if (!WorstEntry || Other.Significance > WorstEntry->Significance)
+			{
+				WorstEntry = &Other;
+			}
+		}
+		if (WorstEntry)
+		{
+			WorstEntry->bFullRateBoneRefresh = false;
+			--FullRateBoneRefreshCount;
+			ApplyAnimSettings(*WorstEntry);
+		}
+	}
+	Entry.bFullRateBoneRefresh = FullRateBoneRefreshCount < MaxFullRateBoneRefreshes;
+	if (Entry.bFullRateBoneRefresh)
+	{
+		++FullRateBoneRefreshCount;
+	}
+	ApplyAnimSettings(Entry);
+}
+
+void UAISignificanceManager::ReleaseBoneRefresh(ACharacter* InCharacter)
+{
+	const int32* Index = EntryIndices.Find(InCharacter);
+	if (!Index) return;
+	FAISignificanceEntry& Entry = Entries[*Index];
+	if (Entry.BoneRefreshRequests <= 0) return;
+	if (--Entry.BoneRefreshRequests > 0) return;
+	const bool bFreedBudget = Entry.bFullRateBoneRefresh;
+	Entry.bFullRateBoneRefresh = false;
+	ApplyAnimSettings(Entry);
+	if (bFreedBudget)
+	{
+		--FullRateBoneRefreshCount;
+		PromoteWaitingBoneRefresh();
+	}
+}
+
+void UAISignificanceManager::PromoteWaitingBoneRefresh()
+{
+	if (FullRateBoneRefreshCount >= MaxFullRateBoneRefreshes) return;
+	// 只在有等待者时才遍历，重要度越高越优先。
+	FAISignificanceEntry* BestEntry = nullptr;
+	for (FAISignificanceEntry& Entry : Entries)
+	{
+		if (Entry.BoneRefreshRequests <= 0 || Entry.bFullRateBoneRefresh) continue;
+		if (!BestEntry || Entry.Significance < BestEntry->Significance)
+		{
+			BestEntry = &Entry;
+		}
+	}
+	if (!BestEntry) return;
+	BestEntry->bFullRateBoneRefresh = true;
+	++FullRateBoneRefreshCount;
+	ApplyAnimSettings(*BestEntry);
+}
+
+void UAISignificanceManager::RemoveEntryAt(int32 Index)
+{
+	if (!Entries.IsValidIndex(Index)) return;
+	// 被移除的角色如果占用了全速预算，归还预算。
+	const bool bFreedBudget = Entries[Index].bFullRateBoneRefresh;
+	if (bFreedBudget)
+	{
+		--FullRateBoneRefreshCount;
+	}
+	EntryIndices.Remove(Entries[Index].Key);
+	Entries.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+	// 末尾元素被换到了Index，更新它的下标。
+	if (Entries.IsValidIndex(Index))
+	{
+		EntryIndices.Add(Entries[Index].Key, Index);
+	}
+	if (bFreedBudget)
+	{
+		PromoteWaitingBoneRefresh();
+	}
+}
@@ -5,6 +5,8 @@
 #include "Characters/ScCharacterBase.h"
 #include "Characters/ScPlayerCharacter.h"
 #include "Characters/ScEnemyCharacter.h"
+#include "Engine/World.h"
+#include "TimerManager.h"
 
 void UCharactersManager::RegCharacter(AScCharacterBase* InCharacter)
 {
@@ -39,11 +41,15 @@ void UCharactersManager::RegPlayerCharacter(AScPlayerCharacter* InPlayerCharacte
 	if (!IsValid(InPlayerCharacter)) return;
 	PlayerCharacters.AddUnique(InPlayerCharacter);
 	//UE_LOG(LogTemp, Warning, TEXT("%s 已注册到PlayerCharacters。"), *InPlayerCharacter->GetName());
+	// 有新玩家加入，唤醒所有休眠的索敌者。
+	WakeAllSearchWaiters();
 }
 
 void UCharactersManager::DeregPlayerCharacter(AScPlayerCharacter* InPlayerCharacter)
 {
 	PlayerCharacters.Remove(InPlayerCharacter);
+	// 没有存活玩家时停止范围检查。
+	UpdateWaiterRangeCheckTimer();
 }
 
 TArray<AScPlayerCharacter*> UCharactersManager::BP_GetPlayerCharacters()
@@ -89,6 +95,7 @@ void UCharactersManager::RegEnemyCharacter(AScEnemyCharacter* InEnemyCharacter)
 void UCharactersManager::DeregEnemyCharacter(AScEnemyCharacter* InEnemyCharacter)
 {
 	EnemyCharacters.Remove(InEnemyCharacter);
+	RemoveSearchWaiter(InEnemyCharacter);
 }
 
 TArray<AScEnemyCharacter*> UCharactersManager::BP_GetEnemyCharacters()
@@ -105,3 +112,126 @@ TArray<AScEnemyCharacter*> UCharactersManager::BP_GetEnemyCharacters()
 	}
 	return OutArray;
 }
+
+void UCharactersManager::NotifyCharacterRespawned(AScCharacterBase* InCharacter)
+{
+	// 只有玩家复活才会产生新的目标。
+	if (!IsValid(Cast<AScPlayerCharacter>(InCharacter))) return;
+	WakeAllSearchWaiters();
+}
+
+void UCharactersManager::AddSearchWaiter(AScEnemyCharacter* InEnemy, const FSimpleDelegate& InWakeDelegate)
+{
+	if (!IsValid(InEnemy)) return;
+	// 同一个敌人只保留一条登记。
+	RemoveSearchWaiter(InEnemy);
+	FScSearchWaiter& Waiter = SearchWaiters.AddDefaulted_GetRef();
+	Waiter.Enemy = InEnemy;
+	Waiter.WakeDelegate = InWakeDelegate;
+	UpdateWaiterRangeCheckTimer();
+}
+
+void UCharactersManager::RemoveSearchWaiter(AScEnemyCharacter* InEnemy)
+{
+	// 顺序无关，使用RemoveAllSwap避免移动数组元素。
+	SearchWaiters.RemoveAllSwap([InEnemy](const FScSearchWaiter& Waiter)
+	{
+		return !Waiter.Enemy.IsValid() || Waiter.Enemy.Get() == InEnemy;
+	}, EAllowShrinking::No);
+	UpdateWaiterRangeCheckTimer();
+}
+
+void UCharactersManager::Deinitialize()
+{
+	if (UWorld* World = GetWorld())
+	{
+		World->GetTimerManager().ClearTimer(WaiterRangeCheckTimer);
+	}
+	SearchWaiters.Empty();
+	Super::Deinitialize();
+}
+
+void UCharactersManager::WakeAllSearchWaiters()
+{
+	// 先把数组移出再执行，唤醒回调中可能会重新登记。
+	TArray<FScSearchWaiter> WokenWaiters = MoveTemp(SearchWaiters);
+	SearchWaiters.Reset();
+	for (const FScSearchWaiter& Waiter : WokenWaiters)
+	{
+		if (!Waiter.Enemy.IsValid()) continue;
+		Waiter.WakeDelegate.ExecuteIfBound();
+	}
+	UpdateWaiterRangeCheckTimer();
+}
+
+void UCharactersManager::UpdateWaiterRangeCheckTimer()
+{
+	UWorld* World = GetWorld();
+	if (!IsValid(World)) return;
+	FTimerManager& TimerManager = World->GetTimerManager();
+	const bool bShouldRun = SearchWaiters.Num() > 0 && HasAlivePlayer();
+	if (bShouldRun && !TimerManager.IsTimerActive(WaiterRangeCheckTimer))
+	{
+		TimerManager.SetTimer(WaiterRangeCheckTimer, this, &ThisClass::CheckSearchWaitersInRange, WaiterRangeCheckInterval, true);
+	}
+	else if (!bShouldRun)
+	{
+		TimerManager.ClearTimer(WaiterRangeCheckTimer);
+	}
+}
+
+void UCharactersManager::CheckSearchWaitersInRange()
+{
+	// 收集存活玩家的位置，一次检查共用。
+	TArray<FVector, TInlineAllocator<4>> PlayerLocations;
+	for (const TWeakObjectPtr<AScPlayerCharacter>& PlayerCharacter : PlayerCharacters)
+	{
+		if (!PlayerCharacter.IsValid() || !PlayerCharacter->IsAlive()) continue;
+		PlayerLocations.Add(PlayerCharacter->GetActorLocation());
+	}
+	// 玩家全部死亡时停止检查，等待复活事件。
+	if (PlayerLocations.IsEmpty())
+	{
+		UpdateWaiterRangeCheckTimer();
+		return;
+	}
+	TArray<FSimpleDelegate, TInlineAllocator<8>> WakeDelegates;
+	for (int32 Index = SearchWaiters.Num() - 1; Index >= 0; --Index)
+	{
+		AScEnemyCharacter* Enemy = SearchWaiters[Index].Enemy.Get();
+		bool bWake = !IsValid(Enemy);
+		if (IsValid(Enemy))
+		{
+			// 搜索范围小于等于0时为全场范围。
+			const float RangeSq = Enemy->SearchRange > 0.0f ? FMath::Square(Enemy->SearchRange) : TNumericLimits<float>::Max();
+			const FVector EnemyLocation = Enemy->GetActorLocation();
+			for (const FVector& PlayerLocation : PlayerLocations)
+			{
+				if (FVector::DistSquared(EnemyLocation, PlayerLocation) <= RangeSq)
+				{
+					WakeDelegates.Add(SearchWaiters[Index].WakeDelegate);
+					bWake = true;
+					break;
+				}
+			}
+		}
+		if (bWake)
+		{
+			SearchWaiters.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+		}
+	}
+	for (const FSimpleDelegate& WakeDelegate : WakeDelegates)
+	{
+		WakeDelegate.ExecuteIfBound();
+	}
+	UpdateWaiterRangeCheckTimer();
+}
+
+bool UCharactersManager::HasAlivePlayer() const
+{
+	for (const TWeakObjectPtr<AScPlayerCharacter>& PlayerCharacter : PlayerCharacters)
+	{
+		if (PlayerCharacter.IsValid() && PlayerCharacter->IsAlive()) return true;
+	}
+	return false;
+}
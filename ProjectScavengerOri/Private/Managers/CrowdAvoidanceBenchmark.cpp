@@ -0,0 +1,149 @@
+// Copyright (C) 2026 Kahyee Studio. All rights reserved.
+
+
+#include "Managers/CrowdAvoidanceBenchmark.h"
+#include "AIController.h"
+#include "Engine/World.h"
+#include "GameFramework/Character.h"
+
+ACrowdAvoidanceBenchmark::ACrowdAvoidanceBenchmark()
+{
+	PrimaryActorTick.bCanEverTick = true;
+	RootComponent = CreateDefaultSubobject<USceneComponent>(TEXT("Root"));
+}
+
+void ACrowdAvoidanceBenchmark::BeginPlay()
+{
+	Super::BeginPlay();
+	if (!AgentClass || GetNumRuns() == 0)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("CrowdAvoidanceBenchmark：未设置AgentClass、AgentCounts或Backends。"));
+		SetActorTickEnabled(false);
+		return;
+	}
+	RunIndex = 0;
+	StartRun();
+}
+
+void ACrowdAvoidanceBenchmark::Tick(float DeltaSeconds)
+{
+	Super::Tick(DeltaSeconds);
+	if (RunIndex == INDEX_NONE || RunIndex >= GetNumRuns()) return;
+	const double Now = FPlatformTime::Seconds();
+	const double FrameMs = (Now - LastFrameTime) * 1000.0;
+	LastFrameTime = Now;
+	RunTime += DeltaSeconds;
+	// 预热期间代理刚开始移动，寻路请求集中，不计入统计。
+	if (RunTime < WarmupTime) return;
+	++SampledFrames;
+	FrameMsSum += FrameMs;
+	MaxFrameMs = FMath::Max(MaxFrameMs, FrameMs);
+	if (const UCrowdAvoidanceManager* Manager = GetWorld()->GetSubsystem<UCrowdAvoidanceManager>())
+	{
+		AvoidanceMsSum += Manager->GetLastUpdateMs();
+	}
+	if (RunTime >= WarmupTime + SampleTime)
+	{
+		FinishRun();
+		++RunIndex;
+		if (RunIndex < GetNumRuns())
+		{
+			StartRun();
+		}
+	}
+}
+
+void ACrowdAvoidanceBenchmark::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	DestroyAgents();
+	Super::EndPlay(EndPlayReason);
+}
+
+void ACrowdAvoidanceBenchmark::StartRun()
+{
+	const int32 NumAgents = AgentCounts[RunIndex / Backends.Num()];
+	const ECrowdAvoidanceBackend Backend = Backends[RunIndex % Backends.Num()];
+	if (UCrowdAvoidanceManager* Manager = GetWorld()->GetSubsystem<UCrowdAvoidanceManager>())
+	{
+		Manager->SetBackend(Backend);
+	}
+	DestroyAgents();
+	SpawnAgents(NumAgents);
+	RunTime = 0.0f;
+	SampledFrames = 0;
+	FrameMsSum = 0.0;
+	MaxFrameMs = 0.0;
+	AvoidanceMsSum = 0.0;
+	LastFrameTime = FPlatformTime::Seconds();
+}
+
+void ACrowdAvoidanceBenchmark::FinishRun()
+{
+	FRunResult& Result = Results.AddDefaulted_GetRef();
+	Result.NumAgents = SpawnedAgents.Num();
+	Result.Backend = Backends[RunIndex % Backends.Num()];
+	Result.AverageFrameMs = SampledFrames > 0 ? FrameMsSum / SampledFrames : 0.0;
+	Result.MaxFrameMs = MaxFrameMs;
+	Result.AverageAvoidanceMs = SampledFrames > 0 ? AvoidanceMsSum / SampledFrames : 0.0;
+	const FString BackendName = StaticEnum<ECrowdAvoidanceBackend>()->GetNameStringByValue(static_cast<int64>(Result.Backend));
+	UE_LOG(LogTemp, Display, TEXT("CrowdAvoidanceBenchmark：%d个代理，%s，平均每帧%.2fms，最大%.2fms，ORCA更新%.2fms。"),
+		Result.NumAgents, *BackendName, Result.AverageFrameMs, Result.MaxFrameMs, Result.AverageAvoidanceMs);
+	// 最后一轮结束后输出汇总，并清理代理。
+	if (RunIndex + 1 < GetNumRuns()) return;
+	UE_LOG(LogTemp, Display, TEXT("CrowdAvoidanceBenchmark汇总："));
+	for (const FRunResult& Run : Results)
+	{
+		UE_LOG(LogTemp, Display, TEXT("  %5d  %-4s  %7.2fms  (max %7.2fms, ORCA %6.2fms)"), Run.NumAgents,
+			*StaticEnum<ECrowdAvoidanceBackend>()->GetNameStringByValue(static_cast<int64>(Run.Backend)), Run.AverageFrameMs, Run.MaxFrameMs, Run.AverageAvoidanceMs);
+	}
+	DestroyAgents();
+}
+
+void ACrowdAvoidanceBenchmark::SpawnAgents(int32 NumAgents)
+{
+	UWorld* World = GetWorld();
+	if (!IsValid(World)) return;
+	const FVector Origin = GetActorLocation();
+	const FVector Forward = GetActorForwardVector().GetSafeNormal2D();
+	const FVector Right = FVector::CrossProduct(FVector::UpVector, Forward);
+	// 两组代理分别排成方阵，隔着CrossingDistance相对。
+	const int32 GroupSize = FMath::DivideAndRoundUp(NumAgents, 2);
+	const int32 Columns = FMath::Max(FMath::CeilToInt(FMath::Sqrt(static_cast<float>(GroupSize))), 1);
+	FActorSpawnParameters SpawnParams;
+	SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AdjustIfPossibleButAlwaysSpawn;
+	SpawnedAgents.Reserve(NumAgents);
+	for (int32 Index = 0; Index < NumAgents; ++Index)
+	{
+		const int32 Group = Index % 2;
+		const int32 Slot = Index / 2;
+		const float Side = Group == 0 ? -1.0f : 1.0f;
+		const FVector Offset = Right * ((Slot % Columns) - (Columns - 1) * 0.5f) * AgentSpacing
+			+ Forward * Side * (CrossingDistance * 0.5f + (Slot / Columns) * AgentSpacing);
+		const FVector Location = Origin + Offset;
+		// 每个代理走到对面一组中镜像的位置，两组在中间交汇。
+		const FVector Goal = Location - Forward * Side * CrossingDistance;
+		ACharacter* Agent = World->SpawnActor<ACharacter>(AgentClass, Location, (Goal - Location).Rotation(), SpawnParams);
+		if (!IsValid(Agent)) continue;
+		SpawnedAgents.Add(Agent);
+		if (!Agent->GetController())
+		{
+			Agent->SpawnDefaultController();
+		}
+		if (AAIController* AIController = Cast<AAIController>(Agent->GetController()))
+		{
+			AIController->MoveToLocation(Goal, 50.0f, true, true, false, false);
+		}
+	}
+}
+
+void ACrowdAvoidanceBenchmark::DestroyAgents()
+{
+	for (const TWeakObjectPtr<ACharacter>& Agent : SpawnedAgents)
+	{
+		if (Agent.IsValid())
+		{
+			Agent->Destroy();
+		}
+	}
+	SpawnedAgents.Reset();
+}
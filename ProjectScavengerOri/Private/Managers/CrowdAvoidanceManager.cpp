@@ -0,0 +1,378 @@
+// Copyright (C) 2026 Kahyee Studio. All rights reserved.
+
+
+#include "Managers/CrowdAvoidanceManager.h"
+#include "Managers/CrowdAvoidanceMovementComponent.h"
+#include "Async/ParallelFor.h"
+
+DECLARE_CYCLE_STAT(TEXT("ORCA Update"), STAT_CrowdAvoidanceUpdate, STATGROUP_CrowdAvoidance);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Agents"), STAT_CrowdAvoidanceAgents, STATGROUP_CrowdAvoidance);
+
+namespace CrowdAvoidance
+{
+	// ORCA约束线：Point + t * Direction，允许的速度在Direction的左侧。
+	struct FLine
+	{
+		FVector2D Point;
+		FVector2D Direction;
+	};
+
+	using FLineArray = TArray<FLine, TInlineAllocator<16>>;
+
+	constexpr double Epsilon = 1.e-5;
+
+	double Det(const FVector2D& A, const FVector2D& B)
+	{
+		return A.X * B.Y - A.Y * B.X;
+	}
+
+	// 在第LineNo条约束线上，满足之前所有约束且在速度圆内，求离OptVelocity最近（或沿方向最远）的点。
+	bool LinearProgram1(const FLineArray& Lines, int32 LineNo, double Radius, const FVector2D& OptVelocity, bool bDirectionOpt, FVector2D& Result)
+	{
+		const FLine& Line = Lines[LineNo];
+		const double Dot = Line.Point | Line.Direction;
+		const double Discriminant = FMath::Square(Dot) + FMath::Square(Radius) - Line.Point.SizeSquared();
+		// 约束线与速度圆不相交。
+		if (Discriminant < 0.0) return false;
+		const double SqrtDiscriminant = FMath::Sqrt(Discriminant);
+		double TLeft = -Dot - SqrtDiscriminant;
+		double TRight = -Dot + SqrtDiscriminant;
+		for (int32 Index = 0; Index < LineNo; ++Index)
+		{
+			const double Denominator = Det(Line.Direction, Lines[Index].Direction);
+			const double Numerator = Det(Lines[Index].Direction, Line.Point - Lines[Index].Point);
+			// 两条线平行，如果在另一条线的禁止一侧则无解。
+			if (FMath::Abs(Denominator) <= Epsilon)
+			{
+				if (Numerator < 0.0) return false;
+				continue;
+			}
+			const double T = Numerator / Denominator;
+			if (Denominator >= 0.0)
+			{
+				TRight = FMath::Min(TRight, T);
+			}
+			else
+			{
+				TLeft = FMath::Max(TLeft, T);
+			}
+			if (TLeft > TRight) return false;
+		}
+		if (bDirectionOpt)
+		{
+			Result = Line.Point + Line.Direction * ((OptVelocity | Line.Direction) > 0.0 ? TRight : TLeft);
+		}
+		else
+		{
+			const double T = Line.Direction | (OptVelocity - Line.Point);
+			Result = Line.Point + Line.Direction * FMath::Clamp(T, TLeft, TRight);
+		}
+		return true;
+	}
+
+	// 依次加入约束求解，返回第一条无法满足的约束的下标，全部满足时返回Lines.Num()。
+	int32 LinearProgram2(const FLineArray& Lines, double Radius, const FVector2D& OptVelocity, bool bDirectionOpt, FVector2D& Result)
+	{
+		if (bDirectionOpt)
+		{
+			Result = OptVelocity * Radius;
+		}
+		else if (OptVelocity.SizeSquared() > FMath::Square(Radius))
+		{
+			Result = OptVelocity.GetSafeNormal() * Radius;
+		}
+		else
+		{
+			Result = OptVelocity;
+		}
+		for (int32 Index = 0; Index < Lines.Num(); ++Index)
+		{
+			// 当前结果违反了这条约束，在约束线上重新求解。
+			if (Det(Lines[Index].Direction, Lines[Index].Point - Result) > 0.0)
+			{
+				const FVector2D PreviousResult = Result;
+				if (!LinearProgram1(Lines, Index, Radius, OptVelocity, bDirectionOpt, Result))
+				{
+					Result = PreviousResult;
+					return Index;
+				}
+			}
+		}
+		return Lines.Num();
+	}
+
+	// 约束无解（过于拥挤）时，求最小化最大违反距离的速度。
+	void LinearProgram3(const FLineArray& Lines, int32 BeginLine, double Radius, FVector2D& Result)
+	{
+		double Distance = 0.0;
+		FLineArray ProjectedLines;
+		for (int32 Index = BeginLine; Index < Lines.Num(); ++Index)
+		{
+			if (Det(Lines[Index].Direction, Lines[Index].Point - Result) <= Distance) continue;
+			ProjectedLines.Reset();
+			for (int32 Other = 0; Other < Index; ++Other)
+			{
+				FLine Line;
+				const double Determinant = Det(Lines[Index].Direction, Lines[Other].Direction);
+				if (FMath::Abs(Determinant) <= Epsilon)
+				{
+					// 同向平行的约束不产生新的限制。
+					if ((Lines[Index].Direction | Lines[Other].Direction) > 0.0) continue;
+					Line.Point = (Lines[Index].Point + Lines[Other].Point) * 0.5;
+				}
+				else
+				{
+					Line.Point = Lines[Index].Point + Lines[Index].Direction * (Det(Lines[Other].Direction, Lines[Index].Point - Lines[Other].Point) / Determinant);
+				}
+				Line.Direction = (Lines[Other].Direction - Lines[Index].Direction).GetSafeNormal();
+				ProjectedLines.Add(Line);
+			}
+			const FVector2D PreviousResult = Result;
+			// 理论上不会失败，失败只可能来自浮点误差，此时保留之前的结果。
+			if (LinearProgram2(ProjectedLines, Radius, FVector2D(-Lines[Index].Direction.Y, Lines[Index].Direction.X), true, Result) < ProjectedLines.Num())
+			{
+				Result = PreviousResult;
+			}
+			Distance = Det(Lines[Index].Direction, Lines[Index].Point - Result);
+		}
+	}
+}
+
+void UCrowdAvoidanceManager::RegAgent(UCrowdAvoidanceMovementComponent* InAgent)
+{
+	if (!IsValid(InAgent)) return;
+	if (AgentIndices.Contains(InAgent)) return;
+	FCrowdAvoidanceAgent& Agent = Agents.AddDefaulted_GetRef();
+	Agent.Component = InAgent;
+	Agent.Key = InAgent;
+	AgentIndices.Add(InAgent, Agents.Num() - 1);
+}
+
+void UCrowdAvoidanceManager::DeregAgent(UCrowdAvoidanceMovementComponent* InAgent)
+{
+	if (const int32* Index = AgentIndices.Find(InAgent))
+	{
+		RemoveAgentAt(*Index);
+	}
+}
+
+bool UCrowdAvoidanceManager::GetAvoidanceVelocity(const UCrowdAvoidanceMovementComponent* InAgent, FVector2D& OutVelocity) const
+{
+	const int32* Index = AgentIndices.Find(InAgent);
+	if (!Index || !Agents[*Index].bHasResult) return false;
+	OutVelocity = Agents[*Index].AvoidanceVelocity;
+	return true;
+}
+
+void UCrowdAvoidanceManager::SetBackend(ECrowdAvoidanceBackend InBackend)
+{
+	Backend = InBackend;
+	// 切换后丢弃旧的结果，切回ORCA时不会使用过期的速度。
+	for (FCrowdAvoidanceAgent& Agent : Agents)
+	{
+		Agent.bHasResult = false;
+		if (UCrowdAvoidanceMovementComponent* Component = Agent.Component.Get())
+		{
+			Component->ApplyAvoidanceBackend(Backend);
+		}
+	}
+	LastUpdateMs = 0.0f;
+}
+
+void UCrowdAvoidanceManager::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+	SET_DWORD_STAT(STAT_CrowdAvoidanceAgents, Agents.Num());
+	if (Backend != ECrowdAvoidanceBackend::Grid || Agents.IsEmpty() || DeltaTime <= 0.0f) return;
+	SCOPE_CYCLE_COUNTER(STAT_CrowdAvoidanceUpdate);
+	const double StartTime = FPlatformTime::Seconds();
+	// 在帧末尾（所有角色移动之后）快照，结果在下一帧移动时使用。
+	const float MaxConsiderationRadius = GatherAgents();
+	// 格子边长不小于最大的考虑半径，每个代理最多查询3x3个格子。
+	Grid.Build(FMath::Max(MaxConsiderationRadius, MinCellSize), Agents.Num(), [this](int32 Index, FVector2D& OutLocation)
+	{
+		OutLocation = Agents[Index].Position;
+		return Agents[Index].bActive;
+	});
+	// 每个任务只写自己负责的代理，其他代理只读。
+	const int32 NumChunks = FMath::DivideAndRoundUp(Agents.Num(), FMath::Max(ChunkSize, 1));
+	ParallelFor(NumChunks, [this, DeltaTime](int32 ChunkIndex)
+	{
+		const int32 Start = ChunkIndex * FMath::Max(ChunkSize, 1);
+		const int32 End = FMath::Min(Start + FMath::Max(ChunkSize, 1), Agents.Num());
+		for (int32 Index = Start; Index < End; ++Index)
+		{
+			ComputeAgent(Index, DeltaTime);
+		}
+	});
+	LastUpdateMs = static_cast<float>((FPlatformTime::Seconds() - StartTime) * 1000.0);
+}
+
+TStatId UCrowdAvoidanceManager::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UCrowdAvoidanceManager, STATGROUP_Tickables);
+}
+
+void UCrowdAvoidanceManager::Deinitialize()
+{
+	Agents.Empty();
+	AgentIndices.Empty();
+	Grid.Reset();
+	Super::Deinitialize();
+}
+
+float UCrowdAvoidanceManager::GatherAgents()
+{
+	float MaxConsiderationRadius = 0.0f;
+	// 倒序遍历，RemoveAgentAt会把末尾元素换到当前位置。
+	for (int32 Index = Agents.Num() - 1; Index >= 0; --Index)
+	{
+		FCrowdAvoidanceAgent& Agent = Agents[Index];
+		const UCrowdAvoidanceMovementComponent* Component = Agent.Component.Get();
+		if (!IsValid(Component))
+		{
+			RemoveAgentAt(Index);
+			continue;
+		}
+		// 池内休眠的角色关闭了组件Tick，不参与避让。
+		Agent.bActive = Component->IsActive() && Component->IsComponentTickEnabled() && Component->UpdatedComponent && Component->bUseCrowdAvoidance;
+		if (!Agent.bActive) continue;
+		const FVector Location = Component->GetActorFeetLocation();
+		Agent.Position = FVector2D(Location);
+		Agent.Z = Location.Z;
+		Agent.Velocity = FVector2D(Component->Velocity);
+		Agent.PreferredVelocity = FVector2D(Component->GetPreferredVelocity());
+		Agent.Radius = Component->GetAgentRadius();
+		Agent.HalfHeight = Component->GetAgentHalfHeight();
+		Agent.MaxSpeed = Component->GetMaxSpeed();
+		Agent.ConsiderationRadius = Component->AvoidanceConsiderationRadius;
+		Agent.Weight = Component->AvoidanceWeight;
+		Agent.GroupMask = Component->GetAvoidanceGroupMask();
+		Agent.GroupsToAvoid = Component->GetGroupsToAvoidMask();
+		Agent.GroupsToIgnore = Component->GetGroupsToIgnoreMask();
+		MaxConsiderationRadius = FMath::Max(MaxConsiderationRadius, Agent.ConsiderationRadius);
+	}
+	return MaxConsiderationRadius;
+}
+
+void UCrowdAvoidanceManager::ComputeAgent(int32 Index, float DeltaTime)
+{
+	using namespace CrowdAvoidance;
+	FCrowdAvoidanceAgent& Agent = Agents[Index];
+	Agent.bHasResult = false;
+	// 不打算移动的代理不做避让，只作为其他代理的障碍。
+	if (!Agent.bActive || Agent.PreferredVelocity.IsNearlyZero()) return;
+	// 在周围的格子中找出最近的MaxNeighbors个邻居，按距离升序保存。
+	const int32 NeighborLimit = FMath::Max(MaxNeighbors, 1);
+	const double RangeSq = FMath::Square(Agent.ConsiderationRadius);
+	TArray<TPair<double, int32>, TInlineAllocator<16>> Neighbors;
+	const FVector2D Extent(Agent.ConsiderationRadius);
+	Grid.ForEachInBox(Agent.Position - Extent, Agent.Position + Extent, [&](int32 Other)
+	{
+		if (Other == Index) return;
+		const FCrowdAvoidanceAgent& OtherAgent = Agents[Other];
+		if (!(Agent.GroupsToAvoid & OtherAgent.GroupMask) || (Agent.GroupsToIgnore & OtherAgent.GroupMask)) return;
+		// 不在同一层的代理互不避让。
+		if (FMath::Abs(OtherAgent.Z - Agent.Z) > Agent.HalfHeight + OtherAgent.HalfHeight) return;
+		const double DistSq = FVector2D::DistSquared(Agent.Position, OtherAgent.Position);
+		if (DistSq > RangeSq) return;
+		if (Neighbors.Num() == NeighborLimit && DistSq >= Neighbors.Last().Key) return;
+		int32 InsertIndex = Neighbors.Num();
+		while (InsertIndex > 0 && Neighbors[InsertIndex - 1].Key > DistSq)
+		{
+			--InsertIndex;
+		}
+		Neighbors.Insert(TPair<double, int32>(DistSq, Other), InsertIndex);
+		if (Neighbors.Num() > NeighborLimit)
+		{
+			Neighbors.Pop(EAllowShrinking::No);
+		}
+	});
+	// 没有邻居时直接使用期望速度。
+	if (Neighbors.IsEmpty())
+	{
+		Agent.AvoidanceVelocity = Agent.PreferredVelocity;
+		Agent.bHasResult = true;
+		return;
+	}
+	// 为每个邻居生成一条ORCA约束。
+	const double InvTimeHorizon = 1.0 / FMath::Max(TimeHorizon, UE_KINDA_SMALL_NUMBER);
+	const double InvTimeStep = 1.0 / DeltaTime;
+	FLineArray Lines;
+	for (const TPair<double, int32>& Neighbor : Neighbors)
+	{
+		const FCrowdAvoidanceAgent& OtherAgent = Agents[Neighbor.Value];
+		const FVector2D RelativePosition = OtherAgent.Position - Agent.Position;
+		const FVector2D RelativeVelocity = Agent.Velocity - OtherAgent.Velocity;
+		const double DistSq = Neighbor.Key;
+		const double CombinedRadius = Agent.Radius + OtherAgent.Radius;
+		const double CombinedRadiusSq = FMath::Square(CombinedRadius);
+		FLine Line;
+		FVector2D U;
+		if (DistSq > CombinedRadiusSq)
+		{
+			// 尚未碰撞：W为相对速度到截断圆圆心的向量。
+			const FVector2D W = RelativeVelocity - RelativePosition * InvTimeHorizon;
+			const double WLengthSq = W.SizeSquared();
+			const double Dot1 = W | RelativePosition;
+			if (Dot1 < 0.0 && FMath::Square(Dot1) > CombinedRadiusSq * WLengthSq)
+			{
+				// 投影到截断圆上。
+				const double WLength = FMath::Sqrt(WLengthSq);
+				const FVector2D UnitW = W / WLength;
+				Line.Direction = FVector2D(UnitW.Y, -UnitW.X);
+				U = UnitW * (CombinedRadius * InvTimeHorizon - WLength);
+			}
+			else
+			{
+				// 投影到速度障碍的两条边上。
+				const double Leg = FMath::Sqrt(DistSq - CombinedRadiusSq);
+				if (Det(RelativePosition, W) > 0.0)
+				{
+					Line.Direction = FVector2D(RelativePosition.X * Leg - RelativePosition.Y * CombinedRadius, RelativePosition.X * CombinedRadius + RelativePosition.Y * Leg) / DistSq;
+				}
+				else
+				{
+					Line.Direction = -FVector2D(RelativePosition.X * Leg + RelativePosition.Y * CombinedRadius, -RelativePosition.X * CombinedRadius + RelativePosition.Y * Leg) / DistSq;
+				}
+				U = Line.Direction * (RelativeVelocity | Line.Direction) - RelativeVelocity;
+			}
+		}
+		else
+		{
+			// 已经重叠：在一帧内分开。
+			const FVector2D W = RelativeVelocity - RelativePosition * InvTimeStep;
+			const double WLength = W.Size();
+			if (WLength <= Epsilon) continue;
+			const FVector2D UnitW = W / WLength;
+			Line.Direction = FVector2D(UnitW.Y, -UnitW.X);
+			U = UnitW * (CombinedRadius * InvTimeStep - WLength);
+		}
+		// 按AvoidanceWeight分担避让，权重较大的一方让得较少，相同时各让一半。
+		const double TotalWeight = Agent.Weight + OtherAgent.Weight;
+		const double Responsibility = TotalWeight > UE_KINDA_SMALL_NUMBER ? OtherAgent.Weight / TotalWeight : 0.5;
+		Line.Point = Agent.Velocity + U * Responsibility;
+		Lines.Add(Line);
+	}
+	// 在最大速度内求满足所有约束且最接近期望速度的速度，无解时退而求违反最小的速度。
+	FVector2D NewVelocity;
+	const int32 FailedLine = LinearProgram2(Lines, Agent.MaxSpeed, Agent.PreferredVelocity, false, NewVelocity);
+	if (FailedLine < Lines.Num())
+	{
+		LinearProgram3(Lines, FailedLine, Agent.MaxSpeed, NewVelocity);
+	}
+	Agent.AvoidanceVelocity = NewVelocity;
+	Agent.bHasResult = true;
+}
+
+void UCrowdAvoidanceManager::RemoveAgentAt(int32 Index)
+{
+	if (!Agents.IsValidIndex(Index)) return;
+	AgentIndices.Remove(Agents[Index].Key);
+	Agents.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+	// 末尾元素被换到了Index，更新它的下标。
+	if (Agents.IsValidIndex(Index))
+	{
+		AgentIndices.Add(Agents[Index].Key, Index);
+	}
+}
@@ -0,0 +1,80 @@
+// Copyright (C) 2026 Kahyee Studio. All rights reserved.
+
+
+#include "Managers/CrowdAvoidanceMovementComponent.h"
+#include "Managers/CrowdAvoidanceManager.h"
+#include "Components/CapsuleComponent.h"
+#include "Engine/World.h"
+#include "GameFramework/Character.h"
+
+UCrowdAvoidanceMovementComponent::UCrowdAvoidanceMovementComponent()
+{
+	// 引擎RVO在BeginPlay时按后端开启，ORCA后端的角色不会注册到引擎的避让管理器。
+	bUseRVOAvoidance = false;
+}
+
+float UCrowdAvoidanceMovementComponent::GetAgentRadius() const
+{
+	const ACharacter* Character = GetCharacterOwner();
+	return Character && Character->GetCapsuleComponent() ? Character->GetCapsuleComponent()->GetScaledCapsuleRadius() : 0.0f;
+}
+
+float UCrowdAvoidanceMovementComponent::GetAgentHalfHeight() const
+{
+	const ACharacter* Character = GetCharacterOwner();
+	return Character && Character->GetCapsuleComponent() ? Character->GetCapsuleComponent()->GetScaledCapsuleHalfHeight() : 0.0f;
+}
+
+void UCrowdAvoidanceMovementComponent::BeginPlay()
+{
+	Super::BeginPlay();
+	if (UWorld* World = GetWorld())
+	{
+		CrowdAvoidanceManager = World->GetSubsystem<UCrowdAvoidanceManager>();
+	}
+	if (UCrowdAvoidanceManager* Manager = CrowdAvoidanceManager.Get())
+	{
+		Manager->RegAgent(this);
+		ApplyAvoidanceBackend(Manager->GetBackend());
+	}
+	else
+	{
+		ApplyAvoidanceBackend(ECrowdAvoidanceBackend::RVO);
+	}
+}
+
+void UCrowdAvoidanceMovementComponent::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if (UCrowdAvoidanceManager* Manager = CrowdAvoidanceManager.Get())
+	{
+		Manager->DeregAgent(this);
+	}
+	Super::EndPlay(EndPlayReason);
+}
+
+void UCrowdAvoidanceMovementComponent::ApplyAvoidanceBackend(ECrowdAvoidanceBackend InBackend)
+{
+	SetAvoidanceEnabled(bUseCrowdAvoidance && InBackend == ECrowdAvoidanceBackend::RVO);
+}
+
+void UCrowdAvoidanceMovementComponent::CalcVelocity(float DeltaTime, float Friction, bool bFluid, float BrakingDeceleration)
+{
+	// RVO后端由Super在末尾调用CalcAvoidanceVelocity，ORCA后端关闭了bUseRVOAvoidance，在同一位置使用管理器的结果。
+	Super::CalcVelocity(DeltaTime, Friction, bFluid, BrakingDeceleration);
+	if (bUseRVOAvoidance || !bUseCrowdAvoidance) return;
+	PreferredVelocity = Velocity;
+	const UCrowdAvoidanceManager* Manager = CrowdAvoidanceManager.Get();
+	if (!Manager || Manager->GetBackend() != ECrowdAvoidanceBackend::Grid) return;
+	// 结果来自上一帧末尾的快照，期望停下时不再使用。
+	FVector2D AvoidanceVelocity;
+	if (Velocity.IsNearlyZero() || !Manager->GetAvoidanceVelocity(this, AvoidanceVelocity)) return;
+	Velocity.X = AvoidanceVelocity.X;
+	Velocity.Y = AvoidanceVelocity.Y;
+}
+
+void UCrowdAvoidanceMovementComponent::CalcAvoidanceVelocity(float DeltaTime)
+{
+	// 记录避让前的期望速度，切换到ORCA后端时以此作为首选速度。
+	PreferredVelocity = Velocity;
+	Super::CalcAvoidanceVelocity(DeltaTime);
+}
@@ -0,0 +1,216 @@
+// Copyright (C) 2026 Kahyee Studio. All rights reserved.
+
+
+#include "Managers/CursorService.h"
+#include "Engine/LocalPlayer.h"
+#include "Engine/World.h"
+#include "GameFramework/PlayerController.h"
+
+UCursorService* UCursorService::Get(const APlayerController* PlayerController)
+{
+	if (!IsValid(PlayerController)) return nullptr;
+	return ULocalPlayer::GetSubsystem<UCursorService>(PlayerController->GetLocalPlayer());
+}
+
+bool UCursorService::GetCursorHit(ETraceTypeQuery TraceChannel, FHitResult& OutHit)
+{
+	FCursorTraceChannel& Entry = FindOrAddChannel(UEngineTypes::ConvertToCollisionChannel(TraceChannel));
+	Entry.LastQueryTime = FPlatformTime::Seconds();
+	ResolveChannel(Entry);
+	OutHit = Entry.Hit;
+	return Entry.bHit;
+}
+
+bool UCursorService::GetCursorLocation(ETraceTypeQuery TraceChannel, FVector& OutLocation)
+{
+	FHitResult Hit;
+	if (!GetCursorHit(TraceChannel, Hit)) return false;
+	OutLocation = Hit.Location;
+	return true;
+}
+
+bool UCursorService::GetCursorRay(FVector& OutOrigin, FVector& OutDirection) const
+{
+	const APlayerController* PlayerController = GetPlayerController();
+	if (!PlayerController) return false;
+	FVector2D MousePosition;
+	if (!PlayerController->GetMousePosition(MousePosition.X, MousePosition.Y)) return false;
+	return PlayerController->DeprojectScreenPositionToWorld(MousePosition.X, MousePosition.Y, OutOrigin, OutDirection);
+}
+
+void UCursorService::SetTraceMode(ECursorTraceMode InTraceMode)
+{
+	if (TraceMode == InTraceMode) return;
+	TraceMode = InTraceMode;
+	// 切换模式后丢弃旧的结果和未完成的检测。
+	for (FCursorTraceChannel& Entry : Channels)
+	{
+		Entry.HitFrame = 0;
+		Entry.ResolvedFrame = 0;
+		Entry.PendingTrace.Invalidate();
+	}
+}
+
+void UCursorService::SetGroundPlaneHeight(float InHeight)
+{
+	GroundPlaneHeight = InHeight;
+	if (TraceMode != ECursorTraceMode::Plane) return;
+	for (FCursorTraceChannel& Entry : Channels)
+	{
+		Entry.ResolvedFrame = 0;
+	}
+}
+
+void UCursorService::Deinitialize()
+{
+	Channels.Empty();
+	Super::Deinitialize();
+}
+
+void UCursorService::Tick(float DeltaTime)
+{
+	// 为最近被查询过的通道保持每帧一次的异步检测，下一帧的查询直接使用结果。
+	const double Now = FPlatformTime::Seconds();
+	for (FCursorTraceChannel& Entry : Channels)
+	{
+		if (Now - Entry.LastQueryTime > IdleTimeout) continue;
+		ConsumeAsyncTrace(Entry);
+		if (!Entry.PendingTrace.IsValid())
+		{
+			IssueAsyncTrace(Entry);
+		}
+	}
+}
+
+bool UCursorService::IsTickable() const
+{
+	return TraceMode == ECursorTraceMode::Async && !Channels.IsEmpty() && !HasAnyFlags(RF_ClassDefaultObject);
+}
+
+UWorld* UCursorService::GetTickableGameObjectWorld() const
+{
+	const ULocalPlayer* LocalPlayer = GetLocalPlayer();
+	return LocalPlayer ? LocalPlayer->GetWorld() : nullptr;
+}
+
+TStatId UCursorService::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UCursorService, STATGROUP_Tickables);
+}
+
+APlayerController* UCursorService::GetPlayerController() const
+{
+	const ULocalPlayer* LocalPlayer = GetLocalPlayer();
+	return LocalPlayer ? LocalPlayer->GetPlayerController(LocalPlayer->GetWorld()) : nullptr;
+}
+
+FCursorTraceChannel& UCursorService::FindOrAddChannel(ECollisionChannel InChannel)
+{
+	for (FCursorTraceChannel& Entry : Channels)
+	{
+		if (Entry.Channel == InChannel) return Entry;
+	}
+	FCursorTraceChannel& Entry = Channels.AddDefaulted_GetRef();
+	Entry.Channel = InChannel;
+	return Entry;
+}
+
+void UCursorService::ResolveChannel(FCursorTraceChannel& Entry)
+{
+	if (Entry.ResolvedFrame == GFrameCounter) return;
+	Entry.ResolvedFrame = GFrameCounter;
+	switch (TraceMode)
+	{
+	case ECursorTraceMode::Plane:
+		TracePlane(Entry);
+		break;
+	case ECursorTraceMode::Async:
+		ConsumeAsyncTrace(Entry);
+		// 刚开始查询或停止检测一段时间后没有可用的结果，同步检测一次。
+		if (GFrameCounter - Entry.HitFrame > static_cast<uint64>(FMath::Max(MaxAsyncResultAge, 0)))
+		{
+			TraceSync(Entry);
+		}
+		break;
+	default:
+		TraceSync(Entry);
+		break;
+	}
+}
+
+void UCursorService::TraceSync(FCursorTraceChannel& Entry)
+{
+	Entry.Hit = FHitResult();
+	Entry.bHit = false;
+	Entry.HitFrame = GFrameCounter;
+	const APlayerController* PlayerController = GetPlayerController();
+	if (!PlayerController) return;
+	FVector2D MousePosition;
+	if (!PlayerController->GetMousePosition(MousePosition.X, MousePosition.Y)) return;
+	Entry.bHit = PlayerController->GetHitResultAtScreenPosition(MousePosition, Entry.Channel, true, Entry.Hit);
+}
+
+void UCursorService::TracePlane(FCursorTraceChannel& Entry)
+{
+	Entry.Hit = FHitResult();
+	Entry.bHit = false;
+	Entry.HitFrame = GFrameCounter;
+	FVector Origin, Direction;
+	// 射线朝上或与地面平行时没有交点。
+	if (!GetCursorRay(Origin, Direction) || Direction.Z > -UE_KINDA_SMALL_NUMBER) return;
+	const double Distance = (GroundPlaneHeight - Origin.Z) / Direction.Z;
+	if (Distance < 0.0) return;
+	const FVector Location = Origin + Direction * Distance;
+	Entry.Hit = FHitResult(Origin, Location);
+	Entry.Hit.Location = Location;
+	Entry.Hit.ImpactPoint = Location;
+	Entry.Hit.Normal = FVector::UpVector;
+	Entry.Hit.ImpactNormal = FVector::UpVector;
+	Entry.Hit.Distance = Distance;
+	Entry.Hit.bBlockingHit = true;
+	Entry.bHit = true;
+}
+
+void UCursorService::IssueAsyncTrace(FCursorTraceChannel& Entry)
+{
+	UWorld* World = GetTickableGameObjectWorld();
+	const APlayerController* PlayerController = GetPlayerController();
+	if (!World || !PlayerController) return;
+	FVector Origin, Direction;
+	if (!GetCursorRay(Origin, Direction)) return;
+	// 与GetHitResultAtScreenPosition使用相同的检测距离和复杂碰撞。
+	const FCollisionQueryParams Params(SCENE_QUERY_STAT(CursorServiceTrace), true);
+	Entry.PendingTrace = World->AsyncLineTraceByChannel(EAsyncTraceType::Single, Origin, Origin + Direction * PlayerController->HitResultTraceDistance, Entry.Channel, Params);
+	Entry.PendingFrame = GFrameCounter;
+}
+
+void UCursorService::ConsumeAsyncTrace(FCursorTraceChannel& Entry)
+{
+	if (!Entry.PendingTrace.IsValid()) return;
+	UWorld* World = GetTickableGameObjectWorld();
+	if (!World)
+	{
+		Entry.PendingTrace.Invalidate();
+		return;
+	}
+	FTraceDatum Data;
+	if (World->QueryTraceData(Entry.PendingTrace, Data))
+	{
+		Entry.PendingTrace.Invalidate();
+		Entry.Hit = FHitResult();
+		Entry.bHit = false;
+		Entry.HitFrame = Entry.PendingFrame;
+		for (const FHitResult& Hit : Data.OutHits)
+		{
+			if (!Hit.bBlockingHit) continue;
+			Entry.Hit = Hit;
+			Entry.bHit = true;
+			break;
+		}
+	}
+	else if (!World->IsTraceHandleValid(Entry.PendingTrace, false))
+	{
+		// 检测已过期（例如暂停期间），丢弃后重新发起。
+		Entry.PendingTrace.Invalidate();
+	}
+}
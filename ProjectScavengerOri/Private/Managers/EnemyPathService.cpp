@@ -0,0 +1,230 @@
+// Copyright (C) 2026 Kahyee Studio. All rights reserved.
+
+
+#include "Managers/EnemyPathService.h"
+#include "AIController.h"
+#include "AI/Navigation/NavAgentInterface.h"
+#include "Engine/World.h"
+#include "NavigationSystem.h"
+#include "NavFilters/NavigationQueryFilter.h"
+#include "NavMesh/NavMeshPath.h"
+#include "TimerManager.h"
+
+bool UEnemyPathService::RequestPath(AAIController* Controller, AActor* Goal, const FOnEnemyPathReady& OnReady)
+{
+	if (!IsValid(Controller) || !IsValid(Controller->GetPawn()) || !IsValid(Goal)) return false;
+	UWorld* World = GetWorld();
+	if (!IsValid(World)) return false;
+	// 同一请求者只保留最新的请求，旧的请求留在批次中，处理时按序号跳过。
+	FEnemyPathRequest Request;
+	Request.Controller = Controller;
+	Request.ControllerKey = Controller;
+	Request.Serial = ++LastRequestSerial;
+	Request.OnReady = OnReady;
+	RequestSerials.Add(Request.ControllerKey, Request.Serial);
+	const FBatchKey Key = MakeBatchKey(Controller, Goal);
+	// 同批的寻路已经在进行中，直接搭车。
+	if (const uint32* QueryId = InFlightQueryIds.Find(Key))
+	{
+		InFlightBatches.FindChecked(*QueryId).Requests.Add(MoveTemp(Request));
+		return true;
+	}
+	FEnemyPathBatch& Batch = PendingBatches.FindOrAdd(Key);
+	Batch.Goal = Goal;
+	Batch.Requests.Add(MoveTemp(Request));
+	// 同一帧的请求在下一帧统一处理。
+	if (!bFlushScheduled)
+	{
+		bFlushScheduled = true;
+		World->GetTimerManager().SetTimerForNextTick(this, &ThisClass::FlushPendingBatches);
+	}
+	return true;
+}
+
+void UEnemyPathService::CancelRequests(const AAIController* Controller)
+{
+	// 进行中的寻路即使没有请求者了也让它完成，结果仍可写入缓存。
+	RequestSerials.Remove(Controller);
+}
+
+void UEnemyPathService::Deinitialize()
+{
+	if (UNavigationSystemV1* NavSys = FNavigationSystem::GetCurrent<UNavigationSystemV1>(GetWorld()))
+	{
+		for (const TPair<uint32, FEnemyPathBatch>& Pair : InFlightBatches)
+		{
+			NavSys->AbortAsyncFindPathRequest(Pair.Key);
+		}
+	}
+	PendingBatches.Empty();
+	InFlightBatches.Empty();
+	InFlightQueryIds.Empty();
+	PathCache.Empty();
+	RequestSerials.Empty();
+	Super::Deinitialize();
+}
+
+UEnemyPathService::FBatchKey UEnemyPathService::MakeBatchKey(const AAIController* Controller, const AActor* Goal) const
+{
+	const FVector StartLocation = Controller->GetNavAgentLocation();
+	const float CellSize = FMath::Max(RegionCellSize, 1.0f);
+	const FIntPoint Region(FMath::FloorToInt(StartLocation.X / CellSize), FMath::FloorToInt(StartLocation.Y / CellSize));
+	return FBatchKey(Goal, Region);
+}
+
+void UEnemyPathService::FlushPendingBatches()
+{
+	bFlushScheduled = false;
+	const UWorld* World = GetWorld();
+	if (!IsValid(World)) return;
+	// 清理过期的缓存。
+	const double Now = World->GetTimeSeconds();
+	for (auto It = PathCache.CreateIterator(); It; ++It)
+	{
+		if (Now - It->Value.Timestamp > CacheLifetime)
+		{
+			It.RemoveCurrent();
+		}
+	}
+	// 回调中可能发起新的请求，先把待处理的请求移出来。
+	TMap<FBatchKey, FEnemyPathBatch> Batches = MoveTemp(PendingBatches);
+	PendingBatches.Reset();
+	for (TPair<FBatchKey, FEnemyPathBatch>& Pair : Batches)
+	{
+		FEnemyPathBatch& Batch = Pair.Value;
+		if (!Batch.Goal.IsValid())
+		{
+			DeliverPath(Batch, nullptr);
+			continue;
+		}
+		const FEnemyPathCacheEntry* CacheEntry = PathCache.Find(Pair.Key);
+		if (CacheEntry && IsCacheValid(*CacheEntry, Batch.Goal.Get()))
+		{
+			DeliverPath(Batch, CacheEntry->Path);
+			continue;
+		}
+		const uint32 QueryId = StartPathQuery(Batch);
+		if (QueryId == INVALID_NAVQUERYID)
+		{
+			DeliverPath(Batch, nullptr);
+			continue;
+		}
+		InFlightQueryIds.Add(Pair.Key, QueryId);
+		InFlightBatches.Add(QueryId, MoveTemp(Batch));
+	}
+}
+
+uint32 UEnemyPathService::StartPathQuery(const FEnemyPathBatch& Batch)
+{
+	UNavigationSystemV1* NavSys = FNavigationSystem::GetCurrent<UNavigationSystemV1>(GetWorld());
+	if (!IsValid(NavSys)) return INVALID_NAVQUERYID;
+	// 用批次中第一个有效的请求者作为寻路的起点，同一格子内的其他请求者共享这条路径。
+	const AAIController* Querier = nullptr;
+	for (const FEnemyPathRequest& Request : Batch.Requests)
+	{
+		if (IsCurrentRequest(Request) && IsValid(Request.Controller->GetPawn()))
+		{
+			Querier = Request.Controller.Get();
+			break;
+		}
+	}
+	if (!IsValid(Querier)) return INVALID_NAVQUERYID;
+
+	const FNavAgentProperties& AgentProperties = Querier->GetNavAgentPropertiesRef();
+	const FVector StartLocation = Querier->GetNavAgentLocation();
+	const ANavigationData* NavData = NavSys->GetNavDataForProps(AgentProperties, StartLocation);
+	if (!IsValid(NavData)) return INVALID_NAVQUERYID;
+
+	FSharedConstNavQueryFilter QueryFilter = UNavigationQueryFilter::GetQueryFilter(*NavData, Querier, Querier->GetDefaultNavigationFilterClass());
+	const FPathFindingQuery Query(Querier, *NavData, StartLocation, GetNavLocation(Batch.Goal.Get()), QueryFilter);
+	return NavSys->FindPathAsync(AgentProperties, Query, FNavPathQueryDelegate::CreateUObject(this, &ThisClass::OnPathQueryFinished), EPathFindingMode::Regular);
+}
+
+void UEnemyPathService::OnPathQueryFinished(uint32 QueryId, ENavigationQueryResult::Type Result, FNavPathSharedPtr Path)
+{
+	FEnemyPathBatch Batch;
+	if (!InFlightBatches.RemoveAndCopyValue(QueryId, Batch)) return;
+	// 部分路径也接受，与AIMoveTo的默认行为一致。
+	const bool bSuccess = Result == ENavigationQueryResult::Success && Path.IsValid() && Path->IsValid();
+	// 进行中的批次很少，线性查找即可。
+	for (auto It = InFlightQueryIds.CreateIterator(); It; ++It)
+	{
+		if (It->Value != QueryId) continue;
+		if (bSuccess && Batch.Goal.IsValid() && IsValid(GetWorld()))
+		{
+			FEnemyPathCacheEntry& CacheEntry = PathCache.FindOrAdd(It->Key);
+			CacheEntry.Path = Path;
+			CacheEntry.GoalLocation = GetNavLocation(Batch.Goal.Get());
+			CacheEntry.Timestamp = GetWorld()->GetTimeSeconds();
+		}
+		It.RemoveCurrent();
+		break;
+	}
+	DeliverPath(Batch, bSuccess ? Path : nullptr);
+}
+
+bool UEnemyPathService::IsCurrentRequest(const FEnemyPathRequest& Request) const
+{
+	const uint32* Serial = RequestSerials.Find(Request.ControllerKey);
+	return Serial && *Serial == Request.Serial && Request.Controller.IsValid();
+}
+
+void UEnemyPathService::DeliverPath(const FEnemyPathBatch& Batch, const FNavPathSharedPtr& SharedPath)
+{
+	for (const FEnemyPathRequest& Request : Batch.Requests)
+	{
+		// 跳过已取消或被取代的请求，请求者被销毁时顺便清理它的序号。
+		const uint32* Serial = RequestSerials.Find(Request.ControllerKey);
+		if (!Serial || *Serial != Request.Serial) continue;
+		RequestSerials.Remove(Request.ControllerKey);
+		AAIController* Controller = Request.Controller.Get();
+		if (!IsValid(Controller)) continue;
+		FNavPathSharedPtr FollowerPath = SharedPath.IsValid() ? MakeFollowerPath(SharedPath, Controller, Batch.Goal.Get()) : nullptr;
+		Request.OnReady.ExecuteIfBound(FollowerPath);
+	}
+}
+
+FNavPathSharedPtr UEnemyPathService::MakeFollowerPath(const FNavPathSharedPtr& SharedPath, AAIController* Controller, AActor* Goal) const
+{
+	const APawn* Pawn = Controller->GetPawn();
+	if (!IsValid(Pawn) || !IsValid(Goal)) return nullptr;
+	// 路径跟随会修改路径并注册观察者，每个请求者使用独立的副本，缓存中的路径保持不变。
+	FNavPathSharedPtr FollowerPath;
+	if (const FNavMeshPath* NavMeshPath = SharedPath->CastPath<FNavMeshPath>())
+	{
+		FollowerPath = MakeShared<FNavMeshPath, ESPMode::ThreadSafe>(*NavMeshPath);
+	}
+	else
+	{
+		FollowerPath = MakeShared<FNavigationPath, ESPMode::ThreadSafe>(*SharedPath);
+	}
+	TArray<FNavPathPoint>& PathPoints = FollowerPath->GetPathPoints();
+	if (PathPoints.Num() > 0)
+	{
+		PathPoints[0].Location = Controller->GetNavAgentLocation();
+	}
+	FollowerPath->SetQuerier(Controller);
+	FollowerPath->SetSourceActor(*Pawn);
+	// 与AAIController::FindPathForMoveRequest一致：观察目标，目标走远或导航数据变化时重新寻路。
+	FollowerPath->SetGoalActorObservation(*Goal, 100.0f);
+	FollowerPath->EnableRecalculationOnInvalidation(true);
+	return FollowerPath;
+}
+
+bool UEnemyPathService::IsCacheValid(const FEnemyPathCacheEntry& Entry, const AActor* Goal) const
+{
+	if (!Entry.Path.IsValid() || !Entry.Path->IsValid()) return false;
+	const UWorld* World = GetWorld();
+	if (!IsValid(World) || World->GetTimeSeconds() - Entry.Timestamp > CacheLifetime) return false;
+	return FVector::DistSquared(GetNavLocation(Goal), Entry.GoalLocation) <= FMath::Square(GoalMoveTolerance);
+}
+
+FVector UEnemyPathService::GetNavLocation(const AActor* Actor)
+{
+	// Pawn返回脚底位置，与AIController的寻路一致。
+	if (const INavAgentInterface* NavAgent = Cast<const INavAgentInterface>(Actor))
+	{
+		return NavAgent->GetNavAgentLocation();
+	}
+	return Actor->GetActorLocation();
+}
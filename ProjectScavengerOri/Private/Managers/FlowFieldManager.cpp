@@ -0,0 +1,424 @@
+// Copyright (C) 2026 Kahyee Studio. All rights reserved.
+
+
+#include "Managers/FlowFieldManager.h"
+#include "Engine/World.h"
+#include "GameFramework/Pawn.h"
+#include "GameFramework/PlayerController.h"
+#include "NavigationData.h"
+#include "NavigationSystem.h"
+#include "TimerManager.h"
+
+namespace FlowField
+{
+	// 八个相邻格子的偏移，偶数为正交方向，奇数为斜向。
+	constexpr int32 DirectionX[8] = { 1, 1, 0, -1, -1, -1, 0, 1 };
+	constexpr int32 DirectionY[8] = { 0, 1, 1, 1, 0, -1, -1, -1 };
+	constexpr float DiagonalCost = 1.41421356f;
+	constexpr float NotWalkableHeight = -UE_BIG_NUMBER;
+
+	bool OpenSetPredicate(const TPair<float, int32>& A, const TPair<float, int32>& B)
+	{
+		return A.Key < B.Key;
+	}
+
+	bool IsInWindow(const FIntPoint& Local, int32 Size)
+	{
+		return Local.X >= 0 && Local.Y >= 0 && Local.X < Size && Local.Y < Size;
+	}
+}
+
+bool UFlowFieldManager::SampleDirection(const FVector& Location, FVector& OutDirection)
+{
+	EnsureUpdating();
+	const FFlowField* Field = FindNearestField(Location);
+	if (!Field) return false;
+	const FIntPoint Local = ToCell(Location) - Field->Origin;
+	if (Local.X < 0 || Local.Y < 0 || Local.X >= Field->Size || Local.Y >= Field->Size) return false;
+	const uint8 Direction = Field->Directions[Local.X + Local.Y * Field->Size];
+	if (Direction == InvalidDirection) return false;
+	// 已经在目标格子内，直接朝向目标。
+	if (Direction == TargetDirection)
+	{
+		OutDirection = (Field->Target->GetNavAgentLocation() - Location).GetSafeNormal2D();
+		return !OutDirection.IsNearlyZero();
+	}
+	OutDirection = FVector(FlowField::DirectionX[Direction], FlowField::DirectionY[Direction], 0.0f).GetSafeNormal();
+	return true;
+}
+
+bool UFlowFieldManager::GetWaypoint(const FVector& Location, int32 Steps, FVector& OutWaypoint)
+{
+	EnsureUpdating();
+	const FFlowField* Field = FindNearestField(Location);
+	if (!Field) return false;
+	FIntPoint Local = ToCell(Location) - Field->Origin;
+	for (int32 Step = 0; Step <= Steps; ++Step)
+	{
+		if (Local.X < 0 || Local.Y < 0 || Local.X >= Field->Size || Local.Y >= Field->Size) return false;
+		const uint8 Direction = Field->Directions[Local.X + Local.Y * Field->Size];
+		if (Direction == InvalidDirection) return false;
+		// 走到目标格子时以目标本身为终点。
+		if (Direction == TargetDirection)
+		{
+			OutWaypoint = Field->Target->GetNavAgentLocation();
+			return true;
+		}
+		if (Step == Steps) break;
+		Local += FIntPoint(FlowField::DirectionX[Direction], FlowField::DirectionY[Direction]);
+	}
+	// 使用流场自己的高度，导航网格变化后共享缓存被清空，重建完成前仍能得到正确的高度。
+	OutWaypoint = CellCenter(Field->Origin + Local, Field->Heights[Local.X + Local.Y * Field->Size]);
+	return true;
+}
+
+void UFlowFieldManager::Deinitialize()
+{
+	if (UWorld* World = GetWorld())
+	{
+		World->GetTimerManager().ClearTimer(UpdateTimer);
+		if (bBoundNavigationDelegate)
+		{
+			if (UNavigationSystemV1* NavSys = FNavigationSystem::GetCurrent<UNavigationSystemV1>(World))
+			{
+				NavSys->OnNavigationGenerationFinishedDelegate.RemoveDynamic(this, &ThisClass::OnNavigationGenerationFinished);
+			}
+		}
+	}
+	Fields.Empty();
+	CellHeights.Empty();
+	Super::Deinitialize();
+}
+
+void UFlowFieldManager::EnsureUpdating()
+{
+	UWorld* World = GetWorld();
+	if (!IsValid(World)) return;
+	LastSampleTime = World->GetTimeSeconds();
+	if (World->GetTimerManager().IsTimerActive(UpdateTimer)) return;
+	World->GetTimerManager().SetTimer(UpdateTimer, this, &ThisClass::UpdateFields, UpdateInterval, true);
+	// 第一次采样时立即生成，避免第一批敌人全部退回普通寻路。
+	UpdateFields();
+}
+
+void UFlowFieldManager::UpdateFields()
+{
+	UWorld* World = GetWorld();
+	if (!IsValid(World)) return;
+	// 无人采样时停止更新并释放流场。
+	if (World->GetTimeSeconds() - LastSampleTime > IdleTimeout)
+	{
+		World->GetTimerManager().ClearTimer(UpdateTimer);
+		Fields.Empty();
+		CellHeights.Empty();
+		return;
+	}
+	UNavigationSystemV1* NavSys = FNavigationSystem::GetCurrent<UNavigationSystemV1>(World);
+	if (!IsValid(NavSys)) return;
+	if (!bBoundNavigationDelegate)
+	{
+		NavSys->OnNavigationGenerationFinishedDelegate.AddDynamic(this, &ThisClass::OnNavigationGenerationFinished);
+		bBoundNavigationDelegate = true;
+	}
+	const ANavigationData* NavData = NavSys->GetDefaultNavDataInstance(FNavigationSystem::DontCreate);
+	if (!IsValid(NavData)) return;
+
+	// 同步玩家列表，每个玩家Pawn一个流场。
+	Fields.RemoveAllSwap([](const FFlowField& Field) { return !Field.Target.IsValid(); });
+	for (FConstPlayerControllerIterator It = World->GetPlayerControllerIterator(); It; ++It)
+	{
+		APawn* Pawn = It->IsValid() ? (*It)->GetPawn() : nullptr;
+		if (!IsValid(Pawn)) continue;
+		if (Fields.ContainsByPredicate([Pawn](const FFlowField& Field) { return Field.Target.Get() == Pawn; })) continue;
+		Fields.AddDefaulted_GetRef().Target = Pawn;
+	}
+
+	int32 Budget = MaxCellsPerUpdate;
+	bool bStartedBuild = false;
+	for (FFlowField& Field : Fields)
+	{
+		const FVector TargetLocation = Field.Target->GetNavAgentLocation();
+		const FIntPoint TargetCell = ToCell(TargetLocation);
+		// 玩家跨格子或导航网格变化时才重新生成。
+		const bool bUpToDate = Field.bBuilding ? Field.BuildTargetCell == TargetCell : (Field.bValid && Field.TargetCell == TargetCell);
+		if (!bUpToDate || Field.bDirty)
+		{
+			StartBuild(Field, TargetCell, TargetLocation.Z);
+			Field.bDirty = false;
+			bStartedBuild = true;
+		}
+		if (Field.bBuilding && Budget > 0)
+		{
+			Budget -= ContinueBuild(Field, Budget, NavData);
+		}
+	}
+	// 窗口移动后淘汰移出窗口的格子，缓存大小不超过窗口的格子数。
+	if (bStartedBuild)
+	{
+		EvictCellHeights();
+	}
+}
+
+void UFlowFieldManager::StartBuild(FFlowField& Field, const FIntPoint& TargetCell, float ReferenceZ) const
+{
+	const int32 Size = 2 * HalfExtentCells + 1;
+	Field.bBuilding = true;
+	Field.BuildTargetCell = TargetCell;
+	Field.BuildOrigin = TargetCell - FIntPoint(HalfExtentCells, HalfExtentCells);
+	Field.BuildReferenceZ = ReferenceZ;
+	Field.BuildCosts.Init(MAX_flt, Size * Size);
+	Field.OpenSet.Reset();
+	// 从目标格子开始反向展开。
+	const int32 TargetIndex = HalfExtentCells + HalfExtentCells * Size;
+	Field.BuildCosts[TargetIndex] = 0.0f;
+	Field.OpenSet.HeapPush(TPair<float, int32>(0.0f, TargetIndex), FlowField::OpenSetPredicate);
+	SeedFromCurrentField(Field);
+}
+
+void UFlowFieldManager::SeedFromCurrentField(FFlowField& Field) const
+{
+	const int32 Size = 2 * HalfExtentCells + 1;
+	// 导航网格变化后旧的代价已被清空，只能从头展开。
+	if (!Field.bValid || Field.Size != Size || Field.Costs.Num() != Size * Size) return;
+	// 新旧目标都可行走时两者之间的路径才能反向使用。
+	const float* OldTargetHeight = CellHeights.Find(Field.TargetCell);
+	const float* NewTargetHeight = CellHeights.Find(Field.BuildTargetCell);
+	if (!OldTargetHeight || *OldTargetHeight == FlowField::NotWalkableHeight) return;
+	if (!NewTargetHeight || *NewTargetHeight == FlowField::NotWalkableHeight) return;
+	// 旧窗口的局部坐标减去Shift为新窗口的局部坐标。
+	const FIntPoint Shift = Field.BuildOrigin - Field.Origin;
+
+	// 沿旧流场走到旧目标的整条路径都在新窗口内时，旧代价才是新窗口内一条真实路径的长度。
+	// 每条路径只走一次，结果记录在路径上的所有格子：0为未确定，1为可复用，2为不可复用。
+	TArray<uint8> States;
+	States.SetNumZeroed(Size * Size);
+	TArray<int32> Chain;
+	for (int32 Index = 0; Index < Size * Size; ++Index)
+	{
+		Chain.Reset();
+		uint8 Result = States[Index];
+		int32 Current = Index;
+		while (!Result)
+		{
+			Chain.Add(Current);
+			const FIntPoint Local(Current % Size, Current / Size);
+			const uint8 Direction = Field.Directions[Current];
+			if (Direction == InvalidDirection || !FlowField::IsInWindow(Local - Shift, Size))
+			{
+				Result = 2;
+			}
+			else if (Direction == TargetDirection)
+			{
+				Result = 1;
+			}
+			else
+			{
+				Current = (Local.X + FlowField::DirectionX[Direction]) + (Local.Y + FlowField::DirectionY[Direction]) * Size;
+				Result = States[Current];
+			}
+		}
+		for (const int32 ChainIndex : Chain)
+		{
+			States[ChainIndex] = Result;
+		}
+	}
+
+	// 新目标经旧目标到达其他格子的路径长度是新代价的上界，真实代价更小的格子在展开时会被更新。
+	const FIntPoint NewTargetLocal = Field.BuildTargetCell - Field.Origin;
+	if (!FlowField::IsInWindow(NewTargetLocal, Size)) return;
+	const int32 NewTargetOldIndex = NewTargetLocal.X + NewTargetLocal.Y * Size;
+	if (States[NewTargetOldIndex] != 1) return;
+	const float TargetOffset = Field.Costs[NewTargetOldIndex];
+	const int32 TargetIndex = HalfExtentCells + HalfExtentCells * Size;
+	for (int32 Index = 0; Index < Size * Size; ++Index)
+	{
+		if (Index == TargetIndex) continue;
+		const FIntPoint OldLocal = FIntPoint(Index % Size, Index / Size) + Shift;
+		if (!FlowField::IsInWindow(OldLocal, Size)) continue;
+		const int32 OldIndex = OldLocal.X + OldLocal.Y * Size;
+		if (States[OldIndex] != 1) continue;
+		Field.BuildCosts[Index] = Field.Costs[OldIndex] + TargetOffset;
+	}
+
+	// 有初始值的格子之间代价一致，无需展开；与没有初始值的格子相邻时才需要展开，以便把代价传给对方。
+	for (int32 Index = 0; Index < Size * Size; ++Index)
+	{
+		if (Index == TargetIndex || Field.BuildCosts[Index] == MAX_flt) continue;
+		const FIntPoint Local(Index % Size, Index / Size);
+		for (int32 Direction = 0; Direction < 8; ++Direction)
+		{
+			const FIntPoint NeighborLocal = Local + FIntPoint(FlowField::DirectionX[Direction], FlowField::DirectionY[Direction]);
+			if (!FlowField::IsInWindow(NeighborLocal, Size)) continue;
+			if (Field.BuildCosts[NeighborLocal.X + NeighborLocal.Y * Size] < MAX_flt) continue;
+			Field.OpenSet.HeapPush(TPair<float, int32>(Field.BuildCosts[Index], Index), FlowField::OpenSetPredicate);
+			break;
+		}
+	}
+}
+
+int32 UFlowFieldManager::ContinueBuild(FFlowField& Field, int32 Budget, const ANavigationData* NavData)
+{
+	const int32 Size = 2 * HalfExtentCells + 1;
+	int32 Used = 0;
+	while (Used < Budget && Field.OpenSet.Num() > 0)
+	{
+		TPair<float, int32> Current;
+		Field.OpenSet.HeapPop(Current, FlowField::OpenSetPredicate);
+		// 同一个格子可能被多次放入开放列表，跳过过期的元素。
+		if (Current.Key > Field.BuildCosts[Current.Value]) continue;
+		++Used;
+		const FIntPoint Local(Current.Value % Size, Current.Value / Size);
+		for (int32 Direction = 0; Direction < 8; ++Direction)
+		{
+			const FIntPoint NeighborLocal = Local + FIntPoint(FlowField::DirectionX[Direction], FlowField::DirectionY[Direction]);
+			if (NeighborLocal.X < 0 || NeighborLocal.Y < 0 || NeighborLocal.X >= Size || NeighborLocal.Y >= Size) continue;
+			if (!CanStep(Field.BuildOrigin + Local, Direction, Field.BuildReferenceZ, NavData)) continue;
+			const int32 NeighborIndex = NeighborLocal.X + NeighborLocal.Y * Size;
+			const float NewCost = Current.Key + (Direction % 2 ? FlowField::DiagonalCost : 1.0f);
+			if (NewCost >= Field.BuildCosts[NeighborIndex]) continue;
+			Field.BuildCosts[NeighborIndex] = NewCost;
+			Field.OpenSet.HeapPush(TPair<float, int32>(NewCost, NeighborIndex), FlowField::OpenSetPredicate);
+		}
+	}
+	if (Field.OpenSet.Num() == 0)
+	{
+		FinishBuild(Field, NavData);
+	}
+	return Used;
+}
+
+void UFlowFieldManager::FinishBuild(FFlowField& Field, const ANavigationData* NavData)
+{
+	const int32 Size = 2 * HalfExtentCells + 1;
+	const int32 TargetIndex = HalfExtentCells + HalfExtentCells * Size;
+	Field.Directions.SetNumUninitialized(Size * Size);
+	Field.Heights.Init(FlowField::NotWalkableHeight, Size * Size);
+	for (int32 Index = 0; Index < Size * Size; ++Index)
+	{
+		if (Index == TargetIndex)
+		{
+			Field.Directions[Index] = TargetDirection;
+			continue;
+		}
+		uint8 BestDirection = InvalidDirection;
+		float BestCost = Field.BuildCosts[Index];
+		const FIntPoint Local(Index % Size, Index / Size);
+		if (BestCost < MAX_flt)
+		{
+			for (int32 Direction = 0; Direction < 8; ++Direction)
+			{
+				const FIntPoint NeighborLocal = Local + FIntPoint(FlowField::DirectionX[Direction], FlowField::DirectionY[Direction]);
+				if (NeighborLocal.X < 0 || NeighborLocal.Y < 0 || NeighborLocal.X >= Size || NeighborLocal.Y >= Size) continue;
+				const float NeighborCost = Field.BuildCosts[NeighborLocal.X + NeighborLocal.Y * Size];
+				if (NeighborCost >= BestCost) continue;
+				if (!CanStep(Field.BuildOrigin + Local, Direction, Field.BuildReferenceZ, NavData)) continue;
+				BestCost = NeighborCost;
+				BestDirection = static_cast<uint8>(Direction);
+			}
+		}
+		Field.Directions[Index] = BestDirection;
+		// 可达的格子在CanStep中已投影过，这里只读缓存。
+		if (BestDirection != InvalidDirection)
+		{
+			Field.Heights[Index] = GetCellHeight(Field.BuildOrigin + Local, Field.BuildReferenceZ, NavData);
+		}
+	}
+	Field.Origin = Field.BuildOrigin;
+	Field.TargetCell = Field.BuildTargetCell;
+	Field.Size = Size;
+	Field.bValid = true;
+	Field.bBuilding = false;
+	Field.Costs = MoveTemp(Field.BuildCosts);
+	Field.OpenSet.Empty();
+}
+
+bool UFlowFieldManager::CanStep(const FIntPoint& From, int32 Direction, float ReferenceZ, const ANavigationData* NavData)
+{
+	const int32 DeltaX = FlowField::DirectionX[Direction];
+	const int32 DeltaY = FlowField::DirectionY[Direction];
+	// 目标可能站在导航网格外（如跳跃中），此时以参考高度代替。
+	float FromHeight = GetCellHeight(From, ReferenceZ, NavData);
+	if (FromHeight == FlowField::NotWalkableHeight)
+	{
+		FromHeight = ReferenceZ;
+	}
+	const float ToHeight = GetCellHeight(From + FIntPoint(DeltaX, DeltaY), ReferenceZ, NavData);
+	if (ToHeight == FlowField::NotWalkableHeight) return false;
+	if (FMath::Abs(ToHeight - FromHeight) > MaxStepHeight) return false;
+	// 斜向移动要求两个正交的格子都可行走，避免贴着墙角穿过去。
+	if (DeltaX != 0 && DeltaY != 0)
+	{
+		if (GetCellHeight(From + FIntPoint(DeltaX, 0), ReferenceZ, NavData) == FlowField::NotWalkableHeight) return false;
+		if (GetCellHeight(From + FIntPoint(0, DeltaY), ReferenceZ, NavData) == FlowField::NotWalkableHeight) return false;
+	}
+	return true;
+}
+
+float UFlowFieldManager::GetCellHeight(const FIntPoint& Cell, float ReferenceZ, const ANavigationData* NavData)
+{
+	if (const float* Height = CellHeights.Find(Cell)) return *Height;
+	float Height = FlowField::NotWalkableHeight;
+	FNavLocation Projected;
+	if (IsValid(NavData) && NavData->ProjectPoint(CellCenter(Cell, ReferenceZ), Projected, ProjectionExtent))
+	{
+		Height = Projected.Location.Z;
+	}
+	CellHeights.Add(Cell, Height);
+	return Height;
+}
+
+void UFlowFieldManager::EvictCellHeights()
+{
+	const int32 Size = 2 * HalfExtentCells + 1;
+	for (auto It = CellHeights.CreateIterator(); It; ++It)
+	{
+		const FIntPoint& Cell = It.Key();
+		const bool bInUse = Fields.ContainsByPredicate([&Cell, Size](const FFlowField& Field)
+		{
+			return (Field.bValid && FlowField::IsInWindow(Cell - Field.Origin, Size))
+				|| (Field.bBuilding && FlowField::IsInWindow(Cell - Field.BuildOrigin, Size));
+		});
+		if (!bInUse)
+		{
+			It.RemoveCurrent();
+		}
+	}
+}
+
+const FFlowField* UFlowFieldManager::FindNearestField(const FVector& Location) const
+{
+	const FFlowField* NearestField = nullptr;
+	double NearestDistSq = TNumericLimits<double>::Max();
+	for (const FFlowField& Field : Fields)
+	{
+		if (!Field.bValid || !Field.Target.IsValid()) continue;
+		const double DistSq = FVector::DistSquared(Field.Target->GetActorLocation(), Location);
+		if (DistSq < NearestDistSq)
+		{
+			NearestDistSq = DistSq;
+			NearestField = &Field;
+		}
+	}
+	return NearestField;
+}
+
+FIntPoint UFlowFieldManager::ToCell(const FVector& Location) const
+{
+	return FIntPoint(FMath::FloorToInt(Location.X / CellSize), FMath::FloorToInt(Location.Y / CellSize));
+}
+
+FVector UFlowFieldManager::CellCenter(const FIntPoint& Cell, float Z) const
+{
+	return FVector((Cell.X + 0.5f) * CellSize, (Cell.Y + 0.5f) * CellSize, Z);
+}
+
+void UFlowFieldManager::OnNavigationGenerationFinished(ANavigationData* NavData)
+{
+	// 导航网格变化后格子的可行走性失效，所有流场标记为需要重建，重建完成前继续使用旧的流场。
+	CellHeights.Empty();
+	for (FFlowField& Field : Fields)
+	{
+		Field.bDirty = true;
+		Field.Costs.Empty();
+	}
+}
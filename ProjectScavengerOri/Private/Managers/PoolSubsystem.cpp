@@ -0,0 +1,157 @@
+// Copyright (C) 2026 Kahyee Studio. All rights reserved.
+
+
+#include "Managers/PoolSubsystem.h"
+#include "Engine/World.h"
+#include "GameFramework/Actor.h"
+#include "Managers/PoolableComponent.h"
+
+
+void UPoolSubsystem::Deinitialize()
+{
+	Super::Deinitialize();
+	// 遍历所有池
+	for (TPair<TObjectPtr<UClass>, FScActorPool>& Pair : Pools)
+	{
+		FScActorPool& Pool = Pair.Value;
+		// 池内闲置的 Actor 如果还有效，则在世界销毁时直接 Destroy
+		for (TWeakObjectPtr<AActor>& WeakActor : Pool.InactiveActors)
+		{
+			if (AActor* Actor = WeakActor.Get(); IsValid(Actor))
+			{
+				Actor->Destroy();
+			}
+		}
+		Pool.InactiveActors.Empty();
+		Pool.TotalCreated = 0;
+	}
+	Pools.Empty();
+}
+
+void UPoolSubsystem::Prewarm(TSubclassOf<AActor> ActorClass, int32 Count)
+{
+	if (!ActorClass || Count <= 0) return;
+	FScActorPool& Pool = Pools.FindOrAdd(ActorClass.Get());
+	// 预热的 Actor 直接以休眠态生成并放进池，不经过激活，也不广播取出/归还事件
+	const FPoolSpawnInfo SpawnInfo;
+	for (int32 i = 0; i < Count; ++i)
+	{
+		AActor* Actor = SpawnInactiveActor(ActorClass, SpawnInfo);
+		if (!IsValid(Actor)) continue;
+		Pool.TotalCreated += 1;
+		Pool.InactiveActors.Add(Actor);
+	}
+}
+
+AActor* UPoolSubsystem::AcquireFromPool(const TSubclassOf<AActor> ActorClass, const FPoolSpawnInfo& SpawnInfo, const FPoolSpawnOptions& Options)
+{
+	if (!ActorClass) return nullptr;
+	FScActorPool& Pool = Pools.FindOrAdd(ActorClass.Get());
+	// 取出：池内没有可复用的 Actor 时以休眠态生成一个新的
+	AActor* Actor = TakeFromPool(Pool);
+	if (!Actor)
+	{
+		Actor = SpawnInactiveActor(ActorClass, SpawnInfo);
+		if (!IsValid(Actor)) return nullptr;
+		Pool.TotalCreated += 1;
+	}
+	// 激活：新生成的和复用的 Actor 走同一条激活路径
+	ActivateActor(Actor, SpawnInfo, Options);
+	return Actor;
+}
+
+void UPoolSubsystem::ReleaseToPool(AActor* Actor)
+{
+	if (!IsValid(Actor)) return;
+	UClass* ClassKey = Actor->GetClass();
+	if (!ClassKey) return;
+	// 已经在池内的 Actor 不再重复归还
+	if (const UPoolableComponent* Poolable = FindPoolableComponent(Actor); Poolable && Poolable->IsInPool()) return;
+	// 休眠，再放回闲置数组（弱引用）
+	SleepActor(Actor);
+	Pools.FindOrAdd(ClassKey).InactiveActors.Add(Actor);
+}
+
+AActor* UPoolSubsystem::TakeFromPool(FScActorPool& Pool) const
+{
+	while (Pool.InactiveActors.Num() > 0)
+	{
+		// 从末尾弹出（O(1)），失效的（切关卡、GC、外部 Destroy）直接跳过
+		AActor* Actor = Pool.InactiveActors.Pop(EAllowShrinking::No).Get();
+		if (IsValid(Actor)) return Actor;
+	}
+	return nullptr;
+}
+
+void UPoolSubsystem::ActivateActor(AActor* Actor, const FPoolSpawnInfo& SpawnInfo, const FPoolSpawnOptions& Options) const
+{
+	// 有池化组件时由组件统一激活并广播取出事件
+	if (UPoolableComponent* Poolable = FindPoolableComponent(Actor))
+	{
+		Poolable->ActivatePoolActor(SpawnInfo, Options);
+		return;
+	}
+	// 没有组件也能用，但建议给可池化对象都加组件
+	if (Options.bSetTransform)
+	{
+		Actor->SetActorTransform(SpawnInfo.Transform);
+	}
+	Actor->SetActorHiddenInGame(!Options.bUnhideActor);
+	Actor->SetActorTickEnabled(Options.bEnableActorTick);
+	Actor->SetActorEnableCollision(Options.bEnableCollision);
+}
+
+void UPoolSubsystem::SleepActor(AActor* Actor) const
+{
+	// 有池化组件时由组件统一休眠并广播归还事件
+	if (UPoolableComponent* Poolable = FindPoolableComponent(Actor))
+	{
+		Poolable->DeactivatePoolActor();
+		return;
+	}
+	// 没有组件时只做最简单的休眠：隐藏、关碰撞、关 Tick
+	Actor->SetActorHiddenInGame(true);
+	Actor->SetActorEnableCollision(false);
+	Actor->SetActorTickEnabled(false);
+}
+
+AActor* UPoolSubsystem::SpawnInactiveActor(const TSubclassOf<AActor> ActorClass, const FPoolSpawnInfo& SpawnInfo) const
+{
+	UWorld* World = GetWorld();
+	if (!World) return nullptr;
+	FActorSpawnParameters Params;
+	Params.Owner = SpawnInfo.Owner.Get();
+	Params.Instigator = SpawnInfo.Instigator.Get();
+	Params.SpawnCollisionHandlingOverride = SpawnInfo.CollisionHandlingMethodOverride;
+	Params.TransformScaleMethod = SpawnInfo.TransformScaleMethodOverride;
+	// 延迟构造，在 BeginPlay 之前把 Actor 标记为池内，让 Actor 自己的 BeginPlay 和 Possess 逻辑可以跳过激活
+	Params.bDeferConstruction = true;
+	AActor* NewActor = World->SpawnActor<AActor>(ActorClass, SpawnInfo.Transform, Params);
+	if (!NewActor) return nullptr;
+	UPoolableComponent* Poolable = FindPoolableComponent(NewActor);
+	if (Poolable)
+	{
+		Poolable->MarkInPool();
+	}
+	// 生成时就隐藏、关碰撞，避免在休眠前出现一帧或触发生成处的重叠事件
+	NewActor->SetActorHiddenInGame(true);
+	NewActor->SetActorEnableCollision(false);
+	NewActor->FinishSpawning(SpawnInfo.Transform, false, nullptr, SpawnInfo.TransformScaleMethodOverride);
+	if (!IsValid(NewActor)) return nullptr;
+	// 组件注册后才能可靠地关闭 Tick 和移动组件，所以在 FinishSpawning 之后进入休眠态（不广播归还事件）
+	if (Poolable)
+	{
+		Poolable->SleepPoolActor();
+	}
+	else
+	{
+		NewActor->SetActorTickEnabled(false);
+	}
+	return NewActor;
+}
+
+UPoolableComponent* UPoolSubsystem::FindPoolableComponent(AActor* Actor) const
+{
+	if (!IsValid(Actor)) return nullptr;
+	return Actor->FindComponentByClass<UPoolableComponent>();
+}
@@ -0,0 +1,40 @@
+// Copyright (C) 2026 Kahyee Studio. All rights reserved.
+
+
+#include "Managers/UniformGrid.h"
+
+void FUniformGrid2D::Reset()
+{
+	BucketStarts.Empty();
+	BucketEntries.Empty();
+	ItemCells.Empty();
+	ItemBuckets.Empty();
+}
+
+void FUniformGrid2D::BeginBuild(float InCellSize, int32 NumItems)
+{
+	CellSize = FMath::Max(InCellSize, 1.0f);
+	InvCellSize = 1.0f / CellSize;
+	// 桶数量至少为对象数量的两倍，减少不同格子落入同一个桶。
+	const int32 NumBuckets = FMath::RoundUpToPowerOfTwo(FMath::Max(NumItems * 2, 64));
+	BucketStarts.Reset();
+	BucketStarts.SetNumZeroed(NumBuckets + 1);
+	ItemCells.SetNumUninitialized(NumItems);
+	ItemBuckets.SetNumUninitialized(NumItems);
+}
+
+void FUniformGrid2D::EndBuild()
+{
+	const int32 NumBuckets = BucketStarts.Num() - 1;
+	for (int32 Bucket = 1; Bucket <= NumBuckets; ++Bucket)
+	{
+		BucketStarts[Bucket] += BucketStarts[Bucket - 1];
+	}
+	TArray<int32> Cursors(BucketStarts.GetData(), NumBuckets);
+	BucketEntries.SetNumUninitialized(BucketStarts[NumBuckets]);
+	for (int32 Index = 0; Index < ItemBuckets.Num(); ++Index)
+	{
+		if (ItemBuckets[Index] == INDEX_NONE) continue;
+		BucketEntries[Cursors[ItemBuckets[Index]]++] = Index;
+	}
+}
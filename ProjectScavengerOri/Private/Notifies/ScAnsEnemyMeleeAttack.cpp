@@ -8,6 +8,36 @@
 #include "AbilitySystemComponent.h"
 #include "AbilitySystemBlueprintLibrary.h"
 #include "GameplayTags/ScGameplayTags.h"
+#include "Managers/AISignificanceManager.h"
+
+void UScAnsEnemyMeleeAttack::NotifyBegin(USkeletalMeshComponent* MeshComp, UAnimSequenceBase* Animation, float TotalDuration, const FAnimNotifyEventReference& EventReference)
+{
+	Super::NotifyBegin(MeshComp, Animation, TotalDuration, EventReference);
+	
+	if (!IsValid(MeshComp)) return;
+	ACharacter* Character = Cast<ACharacter>(MeshComp->GetOwner());
+	if (!IsValid(Character)) return;
+	// 编辑器预览没有对应的Subsystem。
+	UWorld* World = MeshComp->GetWorld();
+	if (!IsValid(World)) return;
+	if (UAISignificanceManager* Subsystem = World->GetSubsystem<UAISignificanceManager>())
+	{
+		Subsystem->AcquireBoneRefresh(Character);
+	}
+}
+
+void UScAnsEnemyMeleeAttack::NotifyEnd(USkeletalMeshComponent* MeshComp, UAnimSequenceBase* Animation, const FAnimNotifyEventReference& EventReference)
+{
+	if (IsValid(MeshComp) && IsValid(MeshComp->GetWorld()))
+	{
+		if (UAISignificanceManager* Subsystem = MeshComp->GetWorld()->GetSubsystem<UAISignificanceManager>())
+		{
+			Subsystem->ReleaseBoneRefresh(Cast<ACharacter>(MeshComp->GetOwner()));
+		}
+	}
+	
+	Super::NotifyEnd(MeshComp, Animation, EventReference);
+}
 
 void UScAnsEnemyMeleeAttack::NotifyTick(USkeletalMeshComponent* MeshComp, UAnimSequenceBase* Animation, float FrameDeltaTime, const FAnimNotifyEventReference& EventReference)
 {
@@ -13,6 +13,7 @@
 #include "EnhancedInputSubsystems.h"
 #include "Engine/LocalPlayer.h"
 #include "ProjectScavenger.h"
+#include "Managers/CursorService.h"
 
 AProjectScavengerPlayerController::AProjectScavengerPlayerController()
 {
@@ -127,7 +128,9 @@ void AProjectScavengerPlayerController::UpdateCachedDestination()
 	}
 	else
 	{
-		bHitSuccessful = GetHitResultUnderCursor(ECollisionChannel::ECC_Visibility, true, Hit);
+		// This runs every frame while the input is held, so use the cursor service's cached trace
+		UCursorService* CursorService = UCursorService::Get(this);
+		bHitSuccessful = CursorService && CursorService->GetCursorHit(UEngineTypes::ConvertToTraceType(ECC_Visibility), Hit);
 	}
 
 	// If we hit a surface, cache the location
@@ -5,10 +5,13 @@
 #include "CoreMinimal.h"
 #include "AbilitySystem/Abilities/ScGameplayAbilityBase.h"
 #include "Navigation/PathFollowingComponent.h"
+#include "AI/Navigation/NavigationTypes.h"
 #include "ScEnemySearchForTarget.generated.h"
 
 /**
  * 敌人索敌技能的C++类，可替代蓝图类。
+ * 找不到目标时不再轮询，而是登记到UCharactersManager中休眠，有目标可用时再被唤醒。
+ * 追击路径由UEnemyPathService合批异步计算，追击同一玩家的敌人共享路径。
  */
 
 namespace EPathFollowingResult
@@ -34,6 +37,8 @@ public:
 	
 	virtual void ActivateAbility(const FGameplayAbilitySpecHandle Handle, const FGameplayAbilityActorInfo* ActorInfo, const FGameplayAbilityActivationInfo ActivationInfo, const FGameplayEventData* TriggerEventData) override;
 	
+	virtual void EndAbility(const FGameplayAbilitySpecHandle Handle, const FGameplayAbilityActorInfo* ActorInfo, const FGameplayAbilityActivationInfo ActivationInfo, bool bReplicateEndAbility, bool bWasCancelled) override;
+	
 	TWeakObjectPtr<AScEnemyCharacter> OwningEnemy;
 	TWeakObjectPtr<AAIController> OwningAIController;
 	TWeakObjectPtr<AScCharacterBase> TargetBaseCharacter;
@@ -43,12 +48,31 @@ private:
 	UPROPERTY()
 	TObjectPtr<UScWaitGameplayEvent> WaitGameplayEventTask;
 	
-	UPROPERTY()
-	TObjectPtr<UAbilityTask_WaitDelay> SearchDelayTask;
+	// 搜索延迟使用计时器，避免每次搜索都创建新的技能任务对象。
+	FTimerHandle SearchDelayTimer;
+	
+	// 是否正在UCharactersManager中休眠等待目标。
+	bool bWaitingForTarget = false;
 	
+	// 没有UEnemyPathService时退回使用的移动任务。
 	UPROPERTY()
 	TObjectPtr<UAITask_MoveTo> MoveToLocationOrActorTask;
 	
+	// 当前移动请求的ID，用于在路径跟随组件的完成回调中筛选自己的请求。
+	FAIRequestID MoveRequestID;
+	
+	FDelegateHandle MoveFinishedHandle;
+	
+	/** 沿流场追击时，重新采样流场并更新移动目标点的间隔（秒）。*/
+	UPROPERTY(EditDefaultsOnly, Category = "Scavenger|AI")
+	float FlowFieldStepInterval = 0.25f;
+	
+	/** 沿流场追击时，移动目标点向前看的格子数量。*/
+	UPROPERTY(EditDefaultsOnly, Category = "Scavenger|AI")
+	int32 FlowFieldLookAheadCells = 3;
+	
+	FTimerHandle FlowFieldChaseTimer;
+	
 	UPROPERTY()
 	TObjectPtr<UAbilityTask_WaitDelay> AttackDelayTask;
 	
@@ -57,12 +81,40 @@ private:
 	UFUNCTION()
 	void EndAttackEventReceived(FGameplayEventData Payload);
 	
-	// SearchDelayTask的回调函数。
+	// SearchDelayTimer的回调函数。
 	UFUNCTION()
 	void SearchOn();
 	
+	// 找不到目标时登记到管理器中休眠。
+	void SleepUntilTargetAvailable();
+	
+	// 从管理器中移除休眠登记。
+	void CancelSleep();
+	
+	// 管理器的唤醒回调：玩家注册、复活或进入搜索范围。
+	void OnTargetAvailable();
+	
 	void MoveToTargetAndAttack();
 	
+	// 通过UEnemyPathService请求追击路径，服务不可用时退回AIMoveTo。
+	void RequestChasePath();
+	
+	// 沿流场追击，流场不可用时返回false。
+	bool StartFlowFieldChase();
+	
+	// FlowFieldChaseTimer的回调函数，到达接受半径后攻击，否则移动到流场上前方的目标点。
+	void FlowFieldChaseStep();
+	
+	void StopFlowFieldChase();
+	
+	// UEnemyPathService的回调，拿到路径后开始移动。
+	void OnPathReady(FNavPathSharedPtr Path);
+	
+	void OnMoveRequestFinished(FAIRequestID RequestID, const FPathFollowingResult& Result);
+	
+	// 取消未完成的寻路请求并解绑路径跟随组件的回调。
+	void StopPathRequest();
+	
 	UFUNCTION()
 	void AttackTarget(TEnumAsByte<EPathFollowingResult::Type> Result, AAIController* AIController);
 	
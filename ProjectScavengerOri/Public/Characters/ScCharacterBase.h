@@ -63,6 +63,13 @@ public:
 	
 protected:
 
+	/** 
+	 * 是否无论是否被渲染都刷新骨骼（专用服务器上也刷新），默认关闭。
+	 * 关闭时只在播放蒙太奇时刷新，近战判定窗口期间由通知状态按需申请刷新。
+	 */
+	UPROPERTY(EditDefaultsOnly, Category = "Scavenger|Animation")
+	bool bAlwaysRefreshBones = false;
+
 	void GiveStartupAbilities();
 
 	void InitializeAttributes() const;
@@ -35,6 +35,10 @@ public:
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Scavenger|AI")
 	float MaxAttackDelay = 0.5f;
 	
+	/** 是否沿UFlowFieldManager的流场追击玩家，适合大量敌人追击同一玩家，流场不可用时退回普通寻路。*/
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Scavenger|AI")
+	bool bUseFlowField = false;
+	
 	UFUNCTION(BlueprintImplementableEvent, Category = "Scavenger|AI")
 	float GetTimelineLength();
 		
@@ -0,0 +1,188 @@
+// Copyright (C) 2026 Kahyee Studio. All rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Components/SkinnedMeshComponent.h"
+#include "UObject/ObjectKey.h"
+#include "UObject/Interface.h"
+#include "AISignificanceManager.generated.h"
+
+/**
+ * AI重要度（LOD）管理器。
+ * 按与玩家的距离和是否可见把已注册的AI角色分到不同的桶中，
+ * 并按桶缩放索敌延迟、CharacterMovement Tick间隔、动画Tick和StateTree等BrainComponent的Tick间隔。
+ * 只在角色换桶时才修改组件设置，大量屏幕外的敌人只消耗很少的CPU。
+ * 同时负责按需刷新骨骼：近战判定等需要准确插槽位置的逻辑在窗口期内申请刷新，
+ * 同时全速刷新的角色数量受预算限制，超出预算的角色以较低频率刷新。
+ */
+
+class ACharacter;
+
+UENUM(BlueprintType)
+enum class EAISignificance : uint8
+{
+	High,
+	Medium,
+	Low
+};
+
+UINTERFACE(MinimalAPI, meta = (CannotImplementInterfaceInBlueprint))
+class UAISignificanceBrainTickOwner : public UInterface
+{
+	GENERATED_BODY()
+};
+
+/** 
+ * 自己管理BrainComponent Tick间隔的AIController实现此接口。
+ * 管理器换桶时只通知控制器，由控制器把桶的BrainTickInterval合并进自己的间隔，间隔只有一个写入者。
+ */
+class PROJECTSCAVENGER_API IAISignificanceBrainTickOwner
+{
+	GENERATED_BODY()
+	
+public:
+	
+	/** 角色换桶后调用，通过GetSettings取得新桶的设置。*/
+	virtual void OnSignificanceChanged(EAISignificance NewSignificance) = 0;
+};
+
+/** 单个重要度桶的设置。*/
+USTRUCT(BlueprintType)
+struct FAISignificanceSettings
+{
+	GENERATED_BODY()
+	
+	/** 与最近玩家的距离小于等于此值时进入该桶，Low桶忽略此值。*/
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	float MaxDistance = 0.0f;
+	
+	/** 索敌延迟的缩放系数。*/
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	float SearchDelayScale = 1.0f;
+	
+	/** CharacterMovement的Tick间隔（秒），0为每帧。*/
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	float MovementTickInterval = 0.0f;
+	
+	/** 骨骼网格体的Tick间隔（秒），0为每帧。*/
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	float AnimTickInterval = 0.0f;
+	
+	/** 是否覆盖角色默认的VisibilityBasedAnimTickOption，High桶始终使用角色默认值。*/
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	bool bOverrideAnimTickOption = false;
+	
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, meta = (EditCondition = "bOverrideAnimTickOption"))
+	EVisibilityBasedAnimTickOption AnimTickOption = EVisibilityBasedAnimTickOption::AlwaysTickPoseAndRefreshBones;
+	
+	/** AIController上BrainComponent（StateTree、行为树）的Tick间隔（秒），0为每帧。实现了IAISignificanceBrainTickOwner的控制器自己应用此值。*/
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	float BrainTickInterval = 0.0f;
+};
+
+/** 已注册角色的内部记录。*/
+struct FAISignificanceEntry
+{
+	TWeakObjectPtr<ACharacter> Character;
+	// 角色被销毁后弱指针失效，仍可用此Key从映射中删除。
+	TObjectKey<ACharacter> Key;
+	EAISignificance Significance = EAISignificance::High;
+	// 注册时缓存的角色默认动画Tick模式，回到High桶时恢复。
+	EVisibilityBasedAnimTickOption DefaultAnimTickOption = EVisibilityBasedAnimTickOption::AlwaysTickPoseAndRefreshBones;
+	// 未释放的骨骼刷新申请数量，可能有多个通知状态重叠。
+	int32 BoneRefreshRequests = 0;
+	// 骨骼刷新是否占用了全速预算。
+	bool bFullRateBoneRefresh = false;
+};
+
+UCLASS(Config = Game)
+class PROJECTSCAVENGER_API UAISignificanceManager : public UWorldSubsystem
+{
+	GENERATED_BODY()
+	
+public:
+	
+	UAISignificanceManager();
+	
+	UFUNCTION(BlueprintCallable, Category = "Scavenger|Managers")
+	void RegCharacter(ACharacter* InCharacter);
+	
+	UFUNCTION(BlueprintCallable, Category = "Scavenger|Managers")
+	void DeregCharacter(ACharacter* InCharacter);
+	
+	/** 返回角色当前所在的桶，未注册的角色视为High。*/
+	UFUNCTION(BlueprintCallable, Category = "Scavenger|Managers")
+	EAISignificance GetSignificance(const ACharacter* InCharacter) const;
+	
+	/** 返回角色当前桶的索敌延迟缩放系数，未注册的角色返回1。*/
+	float GetSearchDelayScale(const ACharacter* InCharacter) const;
+	
+	const FAISignificanceSettings& GetSettings(EAISignificance InSignificance) const;
+	
+	/** 
+	 * 申请在释放前始终刷新角色的骨骼（无论是否被渲染），用于近战插槽判定等。
+	 * 全速预算按重要度分配，预算已满时抢占重要度更低的角色。
+	 * 需与ReleaseBoneRefresh成对调用，未注册的角色忽略。
+	 */
+	void AcquireBoneRefresh(ACharacter* InCharacter);
+	
+	void ReleaseBoneRefresh(ACharacter* InCharacter);
+	
+	virtual void Deinitialize() override;
+	
+protected:
+	
+	/** 重新计算所有角色重要度的间隔（秒）。*/
+	UPROPERTY(Config)
+	float UpdateInterval = 0.25f;
+	
+	/** 最近被渲染过的判定时间（秒），可见的角色至少提升一个桶，专用服务器上不生效。*/
+	UPROPERTY(Config)
+	float RecentlyRenderedTolerance = 0.2f;
+	
+	/** 同时全速刷新骨骼的最大角色数量，超出的角色使用OverBudgetBoneRefreshInterval。*/
+	UPROPERTY(Config)
+	int32 MaxFullRateBoneRefreshes = 16;
+	
+	/** 超出预算且没有被渲染（或在专用服务器上）的角色刷新骨骼的最小Tick间隔（秒）。*/
+	UPROPERTY(Config)
+	float OverBudgetBoneRefreshInterval = 1.0f / 20.0f;
+	
+	UPROPERTY(Config)
+	FAISignificanceSettings HighSettings;
+	
+	UPROPERTY(Config)
+	FAISignificanceSettings MediumSettings;
+	
+	UPROPERTY(Config)
+	FAISignificanceSettings LowSettings;
+	
+private:
+	
+	TArray<FAISignificanceEntry> Entries;
+	
+	// 角色到Entries下标的映射，用于O(1)查询和删除。
+	TMap<TObjectKey<ACharacter>, int32> EntryIndices;
+	
+	FTimerHandle UpdateTimer;
+	
+	// 当前占用全速预算的骨骼刷新数量。
+	int32 FullRateBoneRefreshCount = 0;
+	
+	// UpdateTimer的回调函数，重新分桶并只对换桶的角色应用设置。
+	void UpdateSignificance();
+	
+	EAISignificance CalculateSignificance(const ACharacter* InCharacter, TConstArrayView<FVector> PlayerLocations) const;
+	
+	void ApplySettings(const FAISignificanceEntry& Entry) const;
+	
+	// 只应用动画相关的设置，骨骼刷新申请优先于桶设置。
+	void ApplyAnimSettings(const FAISignificanceEntry& Entry) const;
+	
+	// 把全速预算让给一个等待中的申请，High桶优先。
+	void PromoteWaitingBoneRefresh();
+	
+	void RemoveEntryAt(int32 Index);
+};
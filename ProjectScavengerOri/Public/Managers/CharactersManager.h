@@ -14,7 +14,14 @@ class AScCharacterBase;
 class AScPlayerCharacter;
 class AScEnemyCharacter;
 
-UCLASS()
+/** 休眠中的索敌者：敌人找不到目标时登记于此，有目标可用时由管理器唤醒。*/
+struct FScSearchWaiter
+{
+	TWeakObjectPtr<AScEnemyCharacter> Enemy;
+	FSimpleDelegate WakeDelegate;
+};
+
+UCLASS(Config = Game)
 class PROJECTSCAVENGER_API UCharactersManager : public UWorldSubsystem
 {
 	GENERATED_BODY()
@@ -66,6 +73,25 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "Scavenger|Managers", meta = (DisplayName = "Get Enemy Characters"))
 	TArray<AScEnemyCharacter*> BP_GetEnemyCharacters();
 	
+	/** 角色复活时调用，若为玩家则唤醒所有休眠的索敌者。*/
+	void NotifyCharacterRespawned(AScCharacterBase* InCharacter);
+	
+	/** 
+	 * 登记一个休眠的索敌者，玩家注册、复活或进入该敌人的搜索范围时执行一次唤醒委托并移除登记。
+	 * 同一个敌人重复登记时覆盖旧的委托。
+	 */
+	void AddSearchWaiter(AScEnemyCharacter* InEnemy, const FSimpleDelegate& InWakeDelegate);
+	
+	void RemoveSearchWaiter(AScEnemyCharacter* InEnemy);
+	
+	virtual void Deinitialize() override;
+	
+protected:
+	
+	/** 检查休眠索敌者与玩家距离的间隔（秒），仅在有休眠者且有存活玩家时运行，可在DefaultGame.ini中配置。*/
+	UPROPERTY(Config)
+	float WaiterRangeCheckInterval = 0.5f;
+	
 private:
 	
 	UPROPERTY()
@@ -79,4 +105,19 @@ private:
 	
 	UPROPERTY()
 	TArray<TWeakObjectPtr<AScEnemyCharacter>> EnemyCharacters;
+	
+	TArray<FScSearchWaiter> SearchWaiters;
+	
+	FTimerHandle WaiterRangeCheckTimer;
+	
+	// 唤醒所有休眠的索敌者。
+	void WakeAllSearchWaiters();
+	
+	// 有休眠者且有存活玩家时启动范围检查计时器，否则停止。
+	void UpdateWaiterRangeCheckTimer();
+	
+	// WaiterRangeCheckTimer的回调函数，唤醒搜索范围内出现存活玩家的敌人。
+	void CheckSearchWaitersInRange();
+	
+	bool HasAlivePlayer() const;
 };
@@ -0,0 +1,104 @@
+// Copyright (C) 2026 Kahyee Studio. All rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Actor.h"
+#include "Managers/CrowdAvoidanceManager.h"
+#include "CrowdAvoidanceBenchmark.generated.h"
+
+/**
+ * 群体避让性能测试。
+ * 放到带导航网格的空地图中即可使用：开始游戏后依次以每个代理数量、每种避让后端生成两组代理，
+ * 两组相向而行穿过对方，预热后统计每帧耗时（毫秒），每轮结束时输出到日志，全部结束后输出汇总。
+ * 配合stat CrowdAvoidance可以查看ORCA更新的耗时。
+ */
+
+class ACharacter;
+
+UCLASS()
+class PROJECTSCAVENGER_API ACrowdAvoidanceBenchmark : public AActor
+{
+	GENERATED_BODY()
+
+public:
+
+	ACrowdAvoidanceBenchmark();
+
+protected:
+
+	/** 代理类，需要由AIController控制并接受移动请求，例如AStrategyUnit的蓝图子类。*/
+	UPROPERTY(EditAnywhere, Category = "Benchmark")
+	TSubclassOf<ACharacter> AgentClass;
+
+	/** 每轮测试的代理数量。*/
+	UPROPERTY(EditAnywhere, Category = "Benchmark")
+	TArray<int32> AgentCounts = { 200, 500, 1000 };
+
+	/** 每个代理数量下依次测试的避让后端。*/
+	UPROPERTY(EditAnywhere, Category = "Benchmark")
+	TArray<ECrowdAvoidanceBackend> Backends = { ECrowdAvoidanceBackend::RVO, ECrowdAvoidanceBackend::Grid };
+
+	/** 生成时相邻代理的间距。*/
+	UPROPERTY(EditAnywhere, Category = "Benchmark", meta = (ClampMin = 50, Units = "cm"))
+	float AgentSpacing = 150.0f;
+
+	/** 两组代理之间的距离，每个代理移动到对面一组的位置。*/
+	UPROPERTY(EditAnywhere, Category = "Benchmark", meta = (ClampMin = 0, Units = "cm"))
+	float CrossingDistance = 4000.0f;
+
+	/** 生成后不统计的预热时间（秒）。*/
+	UPROPERTY(EditAnywhere, Category = "Benchmark", meta = (ClampMin = 0))
+	float WarmupTime = 2.0f;
+
+	/** 每轮的统计时间（秒）。*/
+	UPROPERTY(EditAnywhere, Category = "Benchmark", meta = (ClampMin = 0.1))
+	float SampleTime = 5.0f;
+
+	virtual void BeginPlay() override;
+
+	virtual void Tick(float DeltaSeconds) override;
+
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+private:
+
+	/** 单轮测试的结果。*/
+	struct FRunResult
+	{
+		int32 NumAgents = 0;
+		ECrowdAvoidanceBackend Backend = ECrowdAvoidanceBackend::RVO;
+		double AverageFrameMs = 0.0;
+		double MaxFrameMs = 0.0;
+		double AverageAvoidanceMs = 0.0;
+	};
+
+	TArray<TWeakObjectPtr<ACharacter>> SpawnedAgents;
+
+	TArray<FRunResult> Results;
+
+	int32 RunIndex = INDEX_NONE;
+
+	float RunTime = 0.0f;
+
+	int32 SampledFrames = 0;
+
+	double FrameMsSum = 0.0;
+
+	double MaxFrameMs = 0.0;
+
+	double AvoidanceMsSum = 0.0;
+
+	// 上一次Tick的真实时间，用于计算不受时间缩放和DeltaTime上限影响的帧耗时。
+	double LastFrameTime = 0.0;
+
+	int32 GetNumRuns() const { return AgentCounts.Num() * Backends.Num(); }
+
+	void StartRun();
+
+	void FinishRun();
+
+	void SpawnAgents(int32 NumAgents);
+
+	void DestroyAgents();
+};
@@ -0,0 +1,131 @@
+// Copyright (C) 2026 Kahyee Studio. All rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "UObject/ObjectKey.h"
+#include "Managers/UniformGrid.h"
+#include "CrowdAvoidanceManager.generated.h"
+
+/**
+ * 群体避让管理器。
+ * 可选择避让后端：引擎自带的RVO（UAvoidanceManager），或本管理器的网格分桶ORCA。
+ * ORCA后端每帧末尾对所有已注册的代理做一次快照，按网格分桶后并行计算每个代理的避让速度，
+ * 每个代理只考虑最近的MaxNeighbors个邻居，开销随代理数量线性增长，不会在密集人群中退化为平方级。
+ * 代理在下一帧移动时读取计算结果，见UCrowdAvoidanceMovementComponent。
+ */
+
+class UCrowdAvoidanceMovementComponent;
+
+DECLARE_STATS_GROUP(TEXT("CrowdAvoidance"), STATGROUP_CrowdAvoidance, STATCAT_Advanced);
+
+UENUM(BlueprintType)
+enum class ECrowdAvoidanceBackend : uint8
+{
+	// 引擎自带的RVO避让。
+	RVO,
+	// 网格分桶的ORCA避让。
+	Grid
+};
+
+/** 已注册代理的内部记录，Tick时从组件快照。*/
+struct FCrowdAvoidanceAgent
+{
+	TWeakObjectPtr<UCrowdAvoidanceMovementComponent> Component;
+	// 组件被销毁后弱指针失效，仍可用此Key从映射中删除。
+	TObjectKey<UCrowdAvoidanceMovementComponent> Key;
+	FVector2D Position = FVector2D::ZeroVector;
+	FVector2D Velocity = FVector2D::ZeroVector;
+	FVector2D PreferredVelocity = FVector2D::ZeroVector;
+	double Z = 0.0;
+	float Radius = 0.0f;
+	float HalfHeight = 0.0f;
+	float MaxSpeed = 0.0f;
+	float ConsiderationRadius = 0.0f;
+	float Weight = 0.5f;
+	// 与引擎RVO相同的避让分组：只避让GroupsToAvoid中且不在GroupsToIgnore中的代理。
+	int32 GroupMask = 0;
+	int32 GroupsToAvoid = 0;
+	int32 GroupsToIgnore = 0;
+	// 计算出的避让速度，bHasResult为false时无效。
+	FVector2D AvoidanceVelocity = FVector2D::ZeroVector;
+	// 组件未激活（例如回到对象池）时不参与避让，也不作为障碍。
+	bool bActive = false;
+	bool bHasResult = false;
+};
+
+UCLASS(Config = Game)
+class PROJECTSCAVENGER_API UCrowdAvoidanceManager : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+
+	void RegAgent(UCrowdAvoidanceMovementComponent* InAgent);
+
+	void DeregAgent(UCrowdAvoidanceMovementComponent* InAgent);
+
+	/** 取得代理最近一次计算出的避让速度（XY平面），没有结果时返回false。*/
+	bool GetAvoidanceVelocity(const UCrowdAvoidanceMovementComponent* InAgent, FVector2D& OutVelocity) const;
+
+	ECrowdAvoidanceBackend GetBackend() const { return Backend; }
+
+	/** 运行时切换避让后端，用于对比测试。已注册的代理随之开关引擎RVO。*/
+	UFUNCTION(BlueprintCallable, Category = "Scavenger|Managers")
+	void SetBackend(ECrowdAvoidanceBackend InBackend);
+
+	UFUNCTION(BlueprintCallable, Category = "Scavenger|Managers")
+	int32 GetNumAgents() const { return Agents.Num(); }
+
+	/** 最近一次ORCA更新的耗时（毫秒），RVO后端下为0。*/
+	UFUNCTION(BlueprintCallable, Category = "Scavenger|Managers")
+	float GetLastUpdateMs() const { return LastUpdateMs; }
+
+	virtual void Tick(float DeltaTime) override;
+
+	virtual TStatId GetStatId() const override;
+
+	virtual void Deinitialize() override;
+
+protected:
+
+	UPROPERTY(Config)
+	ECrowdAvoidanceBackend Backend = ECrowdAvoidanceBackend::Grid;
+
+	/** 每个代理最多考虑的邻居数量，只保留最近的几个。*/
+	UPROPERTY(Config)
+	int32 MaxNeighbors = 8;
+
+	/** 预测碰撞的时间范围（秒），越大越早开始避让。*/
+	UPROPERTY(Config)
+	float TimeHorizon = 1.0f;
+
+	/** 网格格子的最小边长，实际边长取所有代理AvoidanceConsiderationRadius的最大值。*/
+	UPROPERTY(Config)
+	float MinCellSize = 100.0f;
+
+	/** 并行计算时每个任务处理的代理数量。*/
+	UPROPERTY(Config)
+	int32 ChunkSize = 64;
+
+private:
+
+	TArray<FCrowdAvoidanceAgent> Agents;
+
+	// 组件到Agents下标的映射，用于O(1)查询和删除。
+	TMap<TObjectKey<UCrowdAvoidanceMovementComponent>, int32> AgentIndices;
+
+	// 激活代理的空间网格，每次更新时重建。
+	FUniformGrid2D Grid;
+
+	float LastUpdateMs = 0.0f;
+
+	// 从组件读取位置、速度等数据，只在游戏线程调用。返回所有代理中最大的AvoidanceConsiderationRadius。
+	float GatherAgents();
+
+	// 计算一个代理的ORCA避让速度，只读取其他代理的快照，可并行调用。
+	void ComputeAgent(int32 Index, float DeltaTime);
+
+	void RemoveAgentAt(int32 Index);
+};
@@ -0,0 +1,60 @@
+// Copyright (C) 2026 Kahyee Studio. All rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/CharacterMovementComponent.h"
+#include "CrowdAvoidanceMovementComponent.generated.h"
+
+/**
+ * 使用群体避让管理器的角色移动组件。
+ * 开始游戏时注册到UCrowdAvoidanceManager，管理器使用ORCA后端时用管理器的计算结果代替引擎RVO的避让速度，
+ * 使用RVO后端时与普通的CharacterMovementComponent相同。
+ * 是否参与避让由bUseCrowdAvoidance决定，bUseRVOAvoidance随后端切换，ORCA后端时关闭，引擎RVO与ORCA不会同时计算。
+ * ORCA后端与引擎RVO一样遵守AvoidanceGroup、GroupsToAvoid和GroupsToIgnore。
+ * 角色在构造函数中通过SetDefaultSubobjectClass替换默认的移动组件即可使用。
+ */
+
+class UCrowdAvoidanceManager;
+enum class ECrowdAvoidanceBackend : uint8;
+
+UCLASS()
+class PROJECTSCAVENGER_API UCrowdAvoidanceMovementComponent : public UCharacterMovementComponent
+{
+	GENERATED_BODY()
+
+public:
+
+	UCrowdAvoidanceMovementComponent();
+
+	/** 最近一次移动时避让前的期望速度，ORCA后端以此作为代理的首选速度。*/
+	const FVector& GetPreferredVelocity() const { return PreferredVelocity; }
+
+	/** 代理的避让半径，取胶囊体半径。*/
+	float GetAgentRadius() const;
+
+	float GetAgentHalfHeight() const;
+
+	/** 按避让后端开关引擎RVO，管理器切换后端时调用。*/
+	void ApplyAvoidanceBackend(ECrowdAvoidanceBackend InBackend);
+
+	/** 是否参与群体避让，代替bUseRVOAvoidance。*/
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Character Movement: Avoidance")
+	bool bUseCrowdAvoidance = true;
+
+protected:
+
+	virtual void BeginPlay() override;
+
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+	virtual void CalcVelocity(float DeltaTime, float Friction, bool bFluid, float BrakingDeceleration) override;
+
+	virtual void CalcAvoidanceVelocity(float DeltaTime) override;
+
+private:
+
+	TWeakObjectPtr<UCrowdAvoidanceManager> CrowdAvoidanceManager;
+
+	FVector PreferredVelocity = FVector::ZeroVector;
+};
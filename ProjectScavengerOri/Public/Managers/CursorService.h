@@ -0,0 +1,123 @@
+// Copyright (C) 2026 Kahyee Studio. All rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/LocalPlayerSubsystem.h"
+#include "Tickable.h"
+#include "WorldCollision.h"
+#include "CursorService.generated.h"
+
+/**
+ * 光标服务，每个本地玩家一个。
+ * 光标下的射线检测按通道缓存，同一帧内的所有查询（控制器、角色瞄准等）共用一次检测，不再对同一个像素重复检测。
+ * Async模式下每帧发起一次异步检测，结果在下一帧使用，一段时间无人查询的通道停止检测，再次查询时先同步检测一次；
+ * Plane模式直接与水平地面求交，适合平坦的地图，没有物理查询。
+ */
+
+class APlayerController;
+
+UENUM(BlueprintType)
+enum class ECursorTraceMode : uint8
+{
+	// 每帧最多一次同步检测。
+	Sync,
+	// 每帧一次异步检测，结果延迟一帧。
+	Async,
+	// 与高度为GroundPlaneHeight的水平面求交。
+	Plane
+};
+
+/** 单个检测通道的缓存。*/
+struct FCursorTraceChannel
+{
+	TEnumAsByte<ECollisionChannel> Channel = ECC_Visibility;
+	FHitResult Hit;
+	bool bHit = false;
+	// 缓存的结果是哪一帧的光标位置检测得到的。
+	uint64 HitFrame = 0;
+	// 最近一次更新缓存的帧，同一帧内只更新一次。
+	uint64 ResolvedFrame = 0;
+	// 未完成的异步检测，每个通道同时最多一个。
+	FTraceHandle PendingTrace;
+	uint64 PendingFrame = 0;
+	// 最近一次被查询的时间（秒）。
+	double LastQueryTime = 0.0;
+};
+
+UCLASS(Config = Game)
+class PROJECTSCAVENGER_API UCursorService : public ULocalPlayerSubsystem, public FTickableGameObject
+{
+	GENERATED_BODY()
+
+public:
+
+	/** 返回控制器所属本地玩家的光标服务，非本地控制器返回nullptr。*/
+	static UCursorService* Get(const APlayerController* PlayerController);
+
+	/** 取得光标下指定通道的检测结果，同一帧内多次调用只检测一次。没有阻挡命中时返回false。*/
+	bool GetCursorHit(ETraceTypeQuery TraceChannel, FHitResult& OutHit);
+
+	/** 取得光标下的世界位置，没有命中时返回false且不修改OutLocation。*/
+	bool GetCursorLocation(ETraceTypeQuery TraceChannel, FVector& OutLocation);
+
+	/** 把光标位置反投影为世界空间的射线，没有鼠标时返回false。*/
+	bool GetCursorRay(FVector& OutOrigin, FVector& OutDirection) const;
+
+	ECursorTraceMode GetTraceMode() const { return TraceMode; }
+
+	UFUNCTION(BlueprintCallable, Category = "Scavenger|Managers")
+	void SetTraceMode(ECursorTraceMode InTraceMode);
+
+	/** 设置Plane模式使用的地面高度。*/
+	UFUNCTION(BlueprintCallable, Category = "Scavenger|Managers")
+	void SetGroundPlaneHeight(float InHeight);
+
+	virtual void Deinitialize() override;
+
+	virtual void Tick(float DeltaTime) override;
+
+	virtual ETickableTickType GetTickableTickType() const override { return ETickableTickType::Conditional; }
+
+	virtual bool IsTickable() const override;
+
+	virtual UWorld* GetTickableGameObjectWorld() const override;
+
+	virtual TStatId GetStatId() const override;
+
+protected:
+
+	UPROPERTY(Config)
+	ECursorTraceMode TraceMode = ECursorTraceMode::Async;
+
+	UPROPERTY(Config)
+	float GroundPlaneHeight = 0.0f;
+
+	/** 异步结果最多可以落后的帧数，超过时改为同步检测。*/
+	UPROPERTY(Config)
+	int32 MaxAsyncResultAge = 2;
+
+	/** 通道超过此时间（秒）无人查询后停止异步检测。*/
+	UPROPERTY(Config)
+	float IdleTimeout = 1.0f;
+
+private:
+
+	TArray<FCursorTraceChannel, TInlineAllocator<4>> Channels;
+
+	APlayerController* GetPlayerController() const;
+
+	FCursorTraceChannel& FindOrAddChannel(ECollisionChannel InChannel);
+
+	// 按当前模式更新通道的缓存，每帧只执行一次。
+	void ResolveChannel(FCursorTraceChannel& Entry);
+
+	void TraceSync(FCursorTraceChannel& Entry);
+
+	void TracePlane(FCursorTraceChannel& Entry);
+
+	void IssueAsyncTrace(FCursorTraceChannel& Entry);
+
+	// 读取已完成的异步检测结果，未完成时保留旧的结果。
+	void ConsumeAsyncTrace(FCursorTraceChannel& Entry);
+};
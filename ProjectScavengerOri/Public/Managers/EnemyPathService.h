@@ -0,0 +1,125 @@
+// Copyright (C) 2026 Kahyee Studio. All rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "AI/Navigation/NavigationTypes.h"
+#include "UObject/ObjectKey.h"
+#include "EnemyPathService.generated.h"
+
+/**
+ * 敌人寻路服务。
+ * 同一帧内朝同一目标、起点位于同一区域格子的寻路请求合并为一次异步寻路，
+ * 结果按（目标，区域）缓存一段时间，目标移动不大时直接复用，大量敌人追击同一玩家时不再重复计算近似的A*。
+ * 每个请求者拿到的是共享路径的副本，起点替换为自身位置，并开启目标观察，目标走远后由导航系统重新寻路。
+ */
+
+class AAIController;
+
+/** 寻路完成的回调，失败时Path无效。*/
+DECLARE_DELEGATE_OneParam(FOnEnemyPathReady, FNavPathSharedPtr /*Path*/);
+
+/** 单个请求者的寻路请求。*/
+struct FEnemyPathRequest
+{
+	TWeakObjectPtr<AAIController> Controller;
+	// 请求者被销毁后弱指针失效，仍可用此Key清理RequestSerials。
+	TObjectKey<AAIController> ControllerKey;
+	// 与RequestSerials中请求者的序号不一致时，说明请求已被取消或被新的请求取代。
+	uint32 Serial = 0;
+	FOnEnemyPathReady OnReady;
+};
+
+/** 合并后的一批请求，共享一次寻路。*/
+struct FEnemyPathBatch
+{
+	TWeakObjectPtr<AActor> Goal;
+	TArray<FEnemyPathRequest> Requests;
+};
+
+/** 缓存的共享路径。*/
+struct FEnemyPathCacheEntry
+{
+	FNavPathSharedPtr Path;
+	// 寻路时目标的位置，目标移动超过容差后缓存失效。
+	FVector GoalLocation = FVector::ZeroVector;
+	double Timestamp = 0.0;
+};
+
+UCLASS(Config = Game)
+class PROJECTSCAVENGER_API UEnemyPathService : public UWorldSubsystem
+{
+	GENERATED_BODY()
+	
+public:
+	
+	/**
+	 * 请求一条从Controller所控制的Pawn到Goal的路径，结果最早在下一帧通过OnReady返回，不会在本函数内同步回调。
+	 * 同一Controller重复请求时，旧的请求会被取消。参数无效时返回false，且不会回调。
+	 */
+	bool RequestPath(AAIController* Controller, AActor* Goal, const FOnEnemyPathReady& OnReady);
+	
+	/** 取消Controller所有未完成的请求，O(1)，被取消的请求在批次处理时跳过。*/
+	void CancelRequests(const AAIController* Controller);
+	
+	virtual void Deinitialize() override;
+	
+protected:
+	
+	/** 起点区域格子的边长，同一格子内的请求者共享路径，越小越准确但合并越少。*/
+	UPROPERTY(Config)
+	float RegionCellSize = 400.0f;
+	
+	/** 共享路径的缓存时长（秒）。*/
+	UPROPERTY(Config)
+	float CacheLifetime = 1.0f;
+	
+	/** 目标移动超过此距离后缓存失效。*/
+	UPROPERTY(Config)
+	float GoalMoveTolerance = 150.0f;
+	
+private:
+	
+	// （目标，起点区域）。
+	using FBatchKey = TPair<TObjectKey<AActor>, FIntPoint>;
+	
+	// 等待下一帧统一发起的请求。
+	TMap<FBatchKey, FEnemyPathBatch> PendingBatches;
+	
+	// 已发起异步寻路的请求，寻路完成前到达的同批请求直接追加到这里。
+	TMap<uint32, FEnemyPathBatch> InFlightBatches;
+	TMap<FBatchKey, uint32> InFlightQueryIds;
+	
+	TMap<FBatchKey, FEnemyPathCacheEntry> PathCache;
+	
+	// 每个请求者最新一次请求的序号，取消或回调后移除。
+	TMap<TObjectKey<AAIController>, uint32> RequestSerials;
+	
+	uint32 LastRequestSerial = 0;
+	
+	// 是否已经安排了下一帧的FlushPendingBatches。
+	bool bFlushScheduled = false;
+	
+	FBatchKey MakeBatchKey(const AAIController* Controller, const AActor* Goal) const;
+	
+	// 下一帧统一处理所有待处理的请求：命中缓存的直接返回，其余每批发起一次异步寻路。
+	void FlushPendingBatches();
+	
+	// 发起异步寻路，失败时返回INVALID_NAVQUERYID。
+	uint32 StartPathQuery(const FEnemyPathBatch& Batch);
+	
+	void OnPathQueryFinished(uint32 QueryId, ENavigationQueryResult::Type Result, FNavPathSharedPtr Path);
+	
+	// 请求是否仍是请求者最新的请求。
+	bool IsCurrentRequest(const FEnemyPathRequest& Request) const;
+	
+	void DeliverPath(const FEnemyPathBatch& Batch, const FNavPathSharedPtr& SharedPath);
+	
+	// 复制共享路径，起点替换为请求者的位置。
+	FNavPathSharedPtr MakeFollowerPath(const FNavPathSharedPtr& SharedPath, AAIController* Controller, AActor* Goal) const;
+	
+	bool IsCacheValid(const FEnemyPathCacheEntry& Entry, const AActor* Goal) const;
+	
+	static FVector GetNavLocation(const AActor* Actor);
+};
@@ -0,0 +1,152 @@
+// Copyright (C) 2026 Kahyee Studio. All rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "FlowFieldManager.generated.h"
+
+/**
+ * 流场（Dijkstra图）管理器。
+ * 以每个玩家Pawn为目标，在导航网格上的一块方形格子窗口内生成流场，追击的敌人按位置O(1)采样移动方向，不再各自寻路。
+ * 玩家跨格子时才重建，重建按每次更新的格子预算分帧完成，完成前继续使用旧的流场。
+ * 重建时复用旧流场与新窗口重叠的代价作为初始值，只展开代价变小的格子，玩家移动一两格时不必重新展开整个窗口。
+ * 格子的可行走高度按需投影到导航网格并缓存，移出所有窗口的格子被淘汰，导航网格重新生成后清空，适合高度变化不大的场地。
+ * 每个流场另外保存生成时的格子高度，缓存清空后到新流场替换之前，路点仍使用旧的高度。
+ * 流场只在有人采样时生成，一段时间无人采样后计时器停止，不使用时没有开销。
+ */
+
+class APawn;
+class ANavigationData;
+
+/** 单个目标的流场。*/
+struct FFlowField
+{
+	TWeakObjectPtr<APawn> Target;
+	// 窗口左下角的全局格子坐标，窗口边长为Size。
+	FIntPoint Origin = FIntPoint::ZeroValue;
+	FIntPoint TargetCell = FIntPoint::ZeroValue;
+	int32 Size = 0;
+	// 每个格子流向的相邻格子（0-7），目标格子为TargetDirection，不可达为InvalidDirection。
+	TArray<uint8> Directions;
+	// 每个格子到目标的代价，下一次重建时复用。
+	TArray<float> Costs;
+	// 生成时每个可达格子的可行走高度，与流场一起替换，不受共享高度缓存清空的影响。
+	TArray<float> Heights;
+	bool bValid = false;
+	// 导航网格变化后需要重建。
+	bool bDirty = false;
+	
+	// 分帧重建中的数据。
+	bool bBuilding = false;
+	FIntPoint BuildOrigin = FIntPoint::ZeroValue;
+	FIntPoint BuildTargetCell = FIntPoint::ZeroValue;
+	// 投影格子时使用的参考高度。
+	float BuildReferenceZ = 0.0f;
+	TArray<float> BuildCosts;
+	// 开放列表，二叉堆，元素为（代价，窗口内下标）。
+	TArray<TPair<float, int32>> OpenSet;
+};
+
+UCLASS(Config = Game)
+class PROJECTSCAVENGER_API UFlowFieldManager : public UWorldSubsystem
+{
+	GENERATED_BODY()
+	
+public:
+	
+	static constexpr uint8 InvalidDirection = 0xFF;
+	static constexpr uint8 TargetDirection = 0xFE;
+	
+	/**
+	 * 采样离Location最近的玩家的流场，返回水平方向的单位向量。
+	 * 位于目标格子时返回指向目标的方向；不在窗口内、不可达或流场尚未生成时返回false，调用方应退回普通寻路。
+	 */
+	bool SampleDirection(const FVector& Location, FVector& OutDirection);
+	
+	/**
+	 * 沿流场前进最多Steps个格子，返回途经的最后一个格子的中心（已投影到导航网格）。
+	 * 用于给路径跟随提供一个不需要寻路的近距离目标点。
+	 */
+	bool GetWaypoint(const FVector& Location, int32 Steps, FVector& OutWaypoint);
+	
+	virtual void Deinitialize() override;
+	
+protected:
+	
+	/** 格子边长。*/
+	UPROPERTY(Config)
+	float CellSize = 200.0f;
+	
+	/** 窗口半边长（格子数），窗口边长为2 * HalfExtentCells + 1。*/
+	UPROPERTY(Config)
+	int32 HalfExtentCells = 24;
+	
+	/** 更新间隔（秒），检查玩家是否跨格子并推进重建。*/
+	UPROPERTY(Config)
+	float UpdateInterval = 0.1f;
+	
+	/** 每次更新最多展开的格子数量，一个窗口共(2 * HalfExtentCells + 1)^2个格子。*/
+	UPROPERTY(Config)
+	int32 MaxCellsPerUpdate = 4096;
+	
+	/** 相邻格子之间允许的最大高度差。*/
+	UPROPERTY(Config)
+	float MaxStepHeight = 60.0f;
+	
+	/** 投影格子中心到导航网格的范围。*/
+	UPROPERTY(Config)
+	FVector ProjectionExtent = FVector(50.0f, 50.0f, 250.0f);
+	
+	/** 超过此时间（秒）无人采样后停止更新。*/
+	UPROPERTY(Config)
+	float IdleTimeout = 2.0f;
+	
+private:
+	
+	TArray<FFlowField> Fields;
+	
+	// 全局格子到投影后高度的缓存，不可行走的格子为一个极小值。
+	TMap<FIntPoint, float> CellHeights;
+	
+	FTimerHandle UpdateTimer;
+	
+	double LastSampleTime = 0.0;
+	
+	bool bBoundNavigationDelegate = false;
+	
+	// 启动更新计时器并立即更新一次。
+	void EnsureUpdating();
+	
+	// UpdateTimer的回调函数，同步玩家列表，按需开始重建并推进重建。
+	void UpdateFields();
+	
+	void StartBuild(FFlowField& Field, const FIntPoint& TargetCell, float ReferenceZ) const;
+	
+	// 用旧流场的代价为新窗口设置初始值，并把与未知格子相邻的格子放入开放列表。
+	void SeedFromCurrentField(FFlowField& Field) const;
+	
+	// 推进重建，返回展开的格子数量。
+	int32 ContinueBuild(FFlowField& Field, int32 Budget, const ANavigationData* NavData);
+	
+	// 为每个可达的格子选出代价最小的相邻格子，并替换正在使用的流场。
+	void FinishBuild(FFlowField& Field, const ANavigationData* NavData);
+	
+	// 能否从格子走到指定方向的相邻格子：两者都可行走、高度差不超过MaxStepHeight，斜向时不穿墙角。
+	bool CanStep(const FIntPoint& From, int32 Direction, float ReferenceZ, const ANavigationData* NavData);
+	
+	// 返回格子的可行走高度，第一次访问时投影到导航网格。
+	float GetCellHeight(const FIntPoint& Cell, float ReferenceZ, const ANavigationData* NavData);
+	
+	// 淘汰不在任何流场窗口（包括正在重建的窗口）内的格子高度。
+	void EvictCellHeights();
+	
+	const FFlowField* FindNearestField(const FVector& Location) const;
+	
+	FIntPoint ToCell(const FVector& Location) const;
+	
+	FVector CellCenter(const FIntPoint& Cell, float Z) const;
+	
+	UFUNCTION()
+	void OnNavigationGenerationFinished(ANavigationData* NavData);
+};
@@ -0,0 +1,77 @@
+// Copyright (C) 2026 Kahyee Studio. All rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+// 使用结构体需要添加头文件，而不是只做前项声明。
+#include "Managers/PoolableComponent.h"
+#include "PoolSubsystem.generated.h"
+
+/**
+ * 对象池子系统，需搭配对象池组件使用。
+ */
+
+USTRUCT() // 单个 Class 的池数据
+struct FScActorPool
+{
+	GENERATED_BODY() // 反射宏
+
+public:
+
+	UPROPERTY() // 存“闲置 Actor”（在池内、休眠态）
+	TArray<TWeakObjectPtr<AActor>> InactiveActors; // 用弱指针：避免世界清理时悬挂强引用
+
+	UPROPERTY() // 统计：当前总共创建过多少个
+	int32 TotalCreated = 0; // 仅用于 debug/统计
+};
+
+UCLASS(BlueprintType)
+class PROJECTSCAVENGER_API UPoolSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+	
+public:
+
+	virtual void Deinitialize() override; // 世界结束/切关卡时调用：清理池
+
+	/** 蓝图可调用：预创建/预热（提前以休眠态生成一批放进池，不会激活）*/
+	UFUNCTION(BlueprintCallable) 
+	void Prewarm(TSubclassOf<AActor> ActorClass, int32 Count);
+	
+	/** 
+	 * 从对象池取出 Actor（没有就以休眠态生成），然后调用对象池组件中的激活函数。
+	 */
+	UFUNCTION(BlueprintCallable) 
+	AActor* AcquireFromPool(const TSubclassOf<AActor> ActorClass, const FPoolSpawnInfo& SpawnInfo, const FPoolSpawnOptions& Options);
+
+	/** 
+	 * 先调用对象池组件中的休眠函数，然后归还 Actor 到对象池。已在池内的 Actor 会被忽略。
+	 */
+	UFUNCTION(BlueprintCallable)
+	void ReleaseToPool(AActor* Actor);
+	
+private:
+
+	/** 
+	 * 按 Class 分类的池
+	 * Key：类；Value：该类的池
+	 */
+	UPROPERTY() 
+	TMap<TObjectPtr<UClass>, FScActorPool> Pools; 
+
+	// 取出：从闲置数组弹出一个有效的 Actor，没有则返回空
+	AActor* TakeFromPool(FScActorPool& Pool) const;
+
+	// 激活：把取出的 Actor 变成池外活跃态
+	void ActivateActor(AActor* Actor, const FPoolSpawnInfo& SpawnInfo, const FPoolSpawnOptions& Options) const;
+
+	// 休眠：把 Actor 变成池内休眠态
+	void SleepActor(AActor* Actor) const;
+
+	// 以休眠态生成新 Actor（内部用），BeginPlay 时已在池内
+	AActor* SpawnInactiveActor(const TSubclassOf<AActor> ActorClass, const FPoolSpawnInfo& SpawnInfo) const;
+
+	// 找 Actor 上的 Poolable 组件
+	UPoolableComponent* FindPoolableComponent(AActor* Actor) const;
+};
\ No newline at end of file
@@ -0,0 +1,130 @@
+// Copyright (C) 2026 Kahyee Studio. All rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * XY平面上的均匀网格空间索引，供每帧重建的大量移动对象做范围查询。
+ * 格子通过空间哈希映射到2的幂个桶，重建时用计数排序把对象下标按桶连续存放，不在每帧分配映射。
+ * 索引只保存调用方数组中的下标，调用方的数组在下次Build之前不能增删元素。
+ * 查询会跳过不在范围格子内的对象，但格子内的对象仍需调用方按实际距离过滤。
+ */
+struct PROJECTSCAVENGER_API FUniformGrid2D
+{
+public:
+
+	/**
+	 * 用NumItems个对象重建网格。
+	 * GetLocation(Index, OutLocation)返回false的对象不加入网格。
+	 */
+	template<typename LocationGetterType>
+	void Build(float InCellSize, int32 NumItems, LocationGetterType&& GetLocation);
+
+	/** 对与XY范围相交的格子中的每个对象调用Visitor(Index)，每个对象只访问一次。可在多个线程中同时调用。*/
+	template<typename VisitorType>
+	void ForEachInBox(const FVector2D& BoxMin, const FVector2D& BoxMax, VisitorType&& Visitor) const;
+
+	FIntPoint ToCell(const FVector2D& Location) const
+	{
+		return FIntPoint(FMath::FloorToInt(Location.X * InvCellSize), FMath::FloorToInt(Location.Y * InvCellSize));
+	}
+
+	float GetCellSize() const { return CellSize; }
+
+	bool IsEmpty() const { return BucketEntries.IsEmpty(); }
+
+	void Reset();
+
+private:
+
+	float CellSize = 100.0f;
+
+	float InvCellSize = 0.01f;
+
+	// BucketStarts[i]到BucketStarts[i + 1]为第i个桶中的对象在BucketEntries中的范围。
+	TArray<int32> BucketStarts;
+
+	TArray<int32> BucketEntries;
+
+	// 每个对象所在的格子和桶，未加入网格的对象桶为INDEX_NONE。
+	TArray<FIntPoint> ItemCells;
+
+	TArray<int32> ItemBuckets;
+
+	int32 GetBucket(const FIntPoint& Cell) const
+	{
+		const uint32 Hash = (static_cast<uint32>(Cell.X) * 73856093u) ^ (static_cast<uint32>(Cell.Y) * 19349663u);
+		return static_cast<int32>(Hash & static_cast<uint32>(BucketStarts.Num() - 2));
+	}
+
+	// 设置格子大小和桶数量，清空计数。
+	void BeginBuild(float InCellSize, int32 NumItems);
+
+	// 把计数转换为每个桶的起点，再把对象下标填入各自的桶。
+	void EndBuild();
+};
+
+template<typename LocationGetterType>
+void FUniformGrid2D::Build(float InCellSize, int32 NumItems, LocationGetterType&& GetLocation)
+{
+	BeginBuild(InCellSize, NumItems);
+	// 统计每个桶的对象数量，错开一位，前缀和即为每个桶的起点。
+	for (int32 Index = 0; Index < NumItems; ++Index)
+	{
+		FVector2D Location;
+		if (!GetLocation(Index, Location))
+		{
+			ItemBuckets[Index] = INDEX_NONE;
+			continue;
+		}
+		ItemCells[Index] = ToCell(Location);
+		ItemBuckets[Index] = GetBucket(ItemCells[Index]);
+		++BucketStarts[ItemBuckets[Index] + 1];
+	}
+	EndBuild();
+}
+
+template<typename VisitorType>
+void FUniformGrid2D::ForEachInBox(const FVector2D& BoxMin, const FVector2D& BoxMax, VisitorType&& Visitor) const
+{
+	if (BucketEntries.IsEmpty()) return;
+	const FIntPoint MinCell = ToCell(BoxMin);
+	const FIntPoint MaxCell = ToCell(BoxMax);
+	auto VisitBucket = [&](int32 Bucket)
+	{
+		for (int32 Entry = BucketStarts[Bucket]; Entry < BucketStarts[Bucket + 1]; ++Entry)
+		{
+			const int32 Index = BucketEntries[Entry];
+			// 桶中可能有其他格子哈希过来的对象。
+			const FIntPoint& Cell = ItemCells[Index];
+			if (Cell.X < MinCell.X || Cell.X > MaxCell.X || Cell.Y < MinCell.Y || Cell.Y > MaxCell.Y) continue;
+			Visitor(Index);
+		}
+	};
+	const int32 NumBuckets = BucketStarts.Num() - 1;
+	// 范围内的格子不少于桶数时，直接遍历所有桶。
+	if ((static_cast<int64>(MaxCell.X) - MinCell.X + 1) * (static_cast<int64>(MaxCell.Y) - MinCell.Y + 1) >= NumBuckets)
+	{
+		for (int32 Bucket = 0; Bucket < NumBuckets; ++Bucket)
+		{
+			VisitBucket(Bucket);
+		}
+		return;
+	}
+	// 不同的格子可能哈希到同一个桶，排序去重后每个桶只遍历一次。
+	TArray<int32, TInlineAllocator<16>> Buckets;
+	for (int32 CellY = MinCell.Y; CellY <= MaxCell.Y; ++CellY)
+	{
+		for (int32 CellX = MinCell.X; CellX <= MaxCell.X; ++CellX)
+		{
+			Buckets.Add(GetBucket(FIntPoint(CellX, CellY)));
+		}
+	}
+	Buckets.Sort();
+	for (int32 Slot = 0; Slot < Buckets.Num(); ++Slot)
+	{
+		if (Slot > 0 && Buckets[Slot] == Buckets[Slot - 1]) continue;
+		VisitBucket(Buckets[Slot]);
+	}
+}
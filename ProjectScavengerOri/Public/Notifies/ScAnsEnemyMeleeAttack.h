@@ -9,6 +9,7 @@
 /**
  * AnimNotifyState，AnimMontage能够每帧调用ReceivedNotifyTick函数，实现绘制球体追踪。
  * SendEventsToActors中被命中的Actor当前设置为玩家角色，可以修改为基础角色类，以便实现友军伤害或敌人之间互相伤害。
+ * 判定窗口期间向AISignificanceManager申请刷新骨骼，保证不被渲染时插槽位置也是准确的。
  */
 
 UCLASS()
@@ -18,6 +19,8 @@ class PROJECTSCAVENGER_API UScAnsEnemyMeleeAttack : public UAnimNotifyState
 	
 public:	
 	
+	virtual void NotifyBegin(USkeletalMeshComponent* MeshComp, UAnimSequenceBase* Animation, float TotalDuration, const FAnimNotifyEventReference& EventReference) override;
+	virtual void NotifyEnd(USkeletalMeshComponent* MeshComp, UAnimSequenceBase* Animation, const FAnimNotifyEventReference& EventReference) override;
 	virtual void NotifyTick(USkeletalMeshComponent* MeshComp, UAnimSequenceBase* Animation, float FrameDeltaTime, const FAnimNotifyEventReference& EventReference) override;
 	
 private:
@@ -0,0 +1,177 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+
+#include "StrategyFormation.h"
+#include "StrategyUnit.h"
+#include "NavigationSystem.h"
+#include "NavigationData.h"
+
+void FStrategyFormation::Plan(UWorld* World, const TArray<AStrategyUnit*>& Units, const FVector& Goal, TArray<FVector>& OutGoals) const
+{
+	const int32 NumUnits = Units.Num();
+
+	OutGoals.Init(Goal, NumUnits);
+
+	if (NumUnits == 0)
+	{
+		return;
+	}
+
+	// face the formation along the group's direction of travel
+	FVector Center = FVector::ZeroVector;
+
+	for (const AStrategyUnit* Unit : Units)
+	{
+		Center += Unit->GetActorLocation();
+	}
+
+	Center /= NumUnits;
+
+	FVector Forward = (Goal - Center).GetSafeNormal2D();
+
+	if (Forward.IsNearlyZero())
+	{
+		Forward = FVector::ForwardVector;
+	}
+
+	const FVector Right = FVector::CrossProduct(FVector::UpVector, Forward);
+
+	// get the unit locations in formation space, relative to the group's center
+	TArray<FVector2D> UnitOffsets;
+	UnitOffsets.SetNumUninitialized(NumUnits);
+
+	for (int32 Index = 0; Index < NumUnits; ++Index)
+	{
+		const FVector Relative = Units[Index]->GetActorLocation() - Center;
+		UnitOffsets[Index] = FVector2D(Relative | Forward, Relative | Right);
+	}
+
+	TArray<FSlot> Slots;
+	BuildSlots(NumUnits, Slots);
+
+	// order the units the way the rows are filled. Lines fill from the units furthest ahead,
+	// circles from the units closest to the center
+	const bool bCircle = Shape == EStrategyFormationShape::Circle;
+
+	TArray<int32> UnitOrder;
+	UnitOrder.SetNumUninitialized(NumUnits);
+
+	for (int32 Index = 0; Index < NumUnits; ++Index)
+	{
+		UnitOrder[Index] = Index;
+	}
+
+	UnitOrder.Sort([&UnitOffsets, bCircle](int32 A, int32 B)
+	{
+		return bCircle ? UnitOffsets[A].SizeSquared() < UnitOffsets[B].SizeSquared() : UnitOffsets[A].X > UnitOffsets[B].X;
+	});
+
+	// returns the key that orders a unit within its row. Slots are built in the same order:
+	// left to right for lines, by angle from the front for circles
+	auto GetUnitSortKey = [&UnitOffsets, bCircle](int32 UnitIndex)
+	{
+		const FVector2D& Offset = UnitOffsets[UnitIndex];
+
+		if (bCircle)
+		{
+			const double Angle = FMath::Atan2(Offset.Y, Offset.X);
+			return Angle < 0.0 ? Angle + UE_TWO_PI : Angle;
+		}
+
+		return Offset.Y;
+	};
+
+	// assign each row of slots to the next units in order, pairing them left to right
+	// so no two units in the same row cross paths
+	TArray<int32> RowUnits;
+
+	for (int32 RowStart = 0; RowStart < NumUnits;)
+	{
+		int32 RowEnd = RowStart;
+
+		while (RowEnd < NumUnits && Slots[RowEnd].Row == Slots[RowStart].Row)
+		{
+			++RowEnd;
+		}
+
+		RowUnits.Reset();
+		RowUnits.Append(&UnitOrder[RowStart], RowEnd - RowStart);
+		RowUnits.Sort([&GetUnitSortKey](int32 A, int32 B) { return GetUnitSortKey(A) < GetUnitSortKey(B); });
+
+		for (int32 SlotIndex = RowStart; SlotIndex < RowEnd; ++SlotIndex)
+		{
+			const FSlot& Slot = Slots[SlotIndex];
+			const int32 UnitIndex = RowUnits[SlotIndex - RowStart];
+
+			OutGoals[UnitIndex] = Goal + Forward * Slot.Offset.X + Right * Slot.Offset.Y;
+		}
+
+		RowStart = RowEnd;
+	}
+
+	// project every slot to the navmesh in a single batch
+	UNavigationSystemV1* NavSys = FNavigationSystem::GetCurrent<UNavigationSystemV1>(World);
+	const ANavigationData* NavData = NavSys ? NavSys->GetDefaultNavDataInstance(FNavigationSystem::DontCreate) : nullptr;
+
+	if (NavData)
+	{
+		TArray<FNavigationProjectionWork> Workload;
+		Workload.Reserve(NumUnits);
+
+		for (const FVector& SlotLocation : OutGoals)
+		{
+			Workload.Emplace(SlotLocation);
+		}
+
+		NavData->BatchProjectPoints(Workload, FVector(Spacing * 0.5f, Spacing * 0.5f, ProjectionHeight), NavData->GetDefaultQueryFilter());
+
+		for (int32 Index = 0; Index < NumUnits; ++Index)
+		{
+			OutGoals[Index] = Workload[Index].bResult ? Workload[Index].OutLocation.Location : Goal;
+		}
+	}
+}
+
+void FStrategyFormation::BuildSlots(int32 NumUnits, TArray<FSlot>& OutSlots) const
+{
+	OutSlots.Reset(NumUnits);
+
+	int32 Row = 0;
+
+	while (OutSlots.Num() < NumUnits)
+	{
+		const int32 Remaining = NumUnits - OutSlots.Num();
+
+		if (Shape == EStrategyFormationShape::Circle)
+		{
+			// one slot in the center, then rings of roughly Spacing between neighbors
+			const int32 RingSize = Row == 0 ? 1 : FMath::Min(FMath::FloorToInt(UE_TWO_PI * Row), Remaining);
+			const double AngleStep = UE_TWO_PI / RingSize;
+
+			for (int32 Index = 0; Index < RingSize; ++Index)
+			{
+				const double Angle = Index * AngleStep;
+
+				FSlot& Slot = OutSlots.AddDefaulted_GetRef();
+				Slot.Offset = FVector2D(FMath::Cos(Angle), FMath::Sin(Angle)) * Row * Spacing;
+				Slot.Row = Row;
+			}
+
+		} else {
+
+			// grids fill fixed width rows, wedges widen by one slot per row
+			const int32 Columns = Shape == EStrategyFormationShape::Grid ? FMath::Clamp(FMath::CeilToInt(FMath::Sqrt(static_cast<float>(NumUnits))), 1, MaxColumns) : Row + 1;
+			const int32 RowSize = FMath::Min(Columns, Remaining);
+
+			for (int32 Index = 0; Index < RowSize; ++Index)
+			{
+				// center each row on the goal line
+				FSlot& Slot = OutSlots.AddDefaulted_GetRef();
+				Slot.Offset = FVector2D(-Row * Spacing, (Index - (RowSize - 1) * 0.5) * Spacing);
+				Slot.Row = Row;
+			}
+		}
+
+		++Row;
+	}
+}
@@ -0,0 +1,69 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "StrategyFormation.generated.h"
+
+class AStrategyUnit;
+class UWorld;
+
+/** Shape of a strategy unit formation */
+UENUM(BlueprintType)
+enum class EStrategyFormationShape : uint8
+{
+	Grid,
+	Wedge,
+	Circle
+};
+
+/**
+ *  Formation planner for strategy unit move orders
+ *  Computes a slot for each unit around the move goal in one pass, projects all slots to the navmesh
+ *  in a single batched query, and assigns units to slots row by row in the order they're already standing in,
+ *  so units don't cross each other's paths on the way to the formation
+ */
+USTRUCT(BlueprintType)
+struct FStrategyFormation
+{
+	GENERATED_BODY()
+
+	/** Formation shape */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Formation")
+	EStrategyFormationShape Shape = EStrategyFormationShape::Grid;
+
+	/** Distance between neighboring slots */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Formation", meta = (ClampMin = 1, ClampMax = 1000, Units = "cm"))
+	float Spacing = 120.0f;
+
+	/** Max number of units per row in grid formations */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Formation", meta = (ClampMin = 1, ClampMax = 100))
+	int32 MaxColumns = 8;
+
+	/** Max vertical distance a slot can be moved when projecting it to the navmesh */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Formation", meta = (ClampMin = 0, ClampMax = 10000, Units = "cm"))
+	float ProjectionHeight = 250.0f;
+
+	/** Acceptance radius for units moving to their slots */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Formation", meta = (ClampMin = 0, ClampMax = 1000, Units = "cm"))
+	float SlotAcceptanceRadius = 50.0f;
+
+	/**
+	 *  Plans a formation for the units around the goal, facing the direction of travel from the units' current center to the goal.
+	 *  OutGoals receives a navigable move goal for each unit, in the same order as Units.
+	 *  Slots that can't be projected to the navmesh fall back to the goal itself
+	 */
+	void Plan(UWorld* World, const TArray<AStrategyUnit*>& Units, const FVector& Goal, TArray<FVector>& OutGoals) const;
+
+protected:
+
+	/** Slot in formation space. X is the distance ahead of the goal, Y the distance to the right */
+	struct FSlot
+	{
+		FVector2D Offset;
+		int32 Row;
+	};
+
+	/** Fills OutSlots with the formation space slots for the given number of units, front row first and left to right within each row */
+	void BuildSlots(int32 NumUnits, TArray<FSlot>& OutSlots) const;
+};
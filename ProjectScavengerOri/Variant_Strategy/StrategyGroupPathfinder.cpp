@@ -0,0 +1,300 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+
+#include "StrategyGroupPathfinder.h"
+#include "StrategyUnit.h"
+#include "NavigationSystem.h"
+#include "NavigationData.h"
+
+void UStrategyGroupPathfinder::RequestGroupMove(const TArray<AStrategyUnit*>& Units, const TArray<FVector>& Goals, float AcceptanceRadius, FOnStrategyGroupMoveIssued OnIssued)
+{
+	check(Units.Num() == Goals.Num());
+
+	UNavigationSystemV1* NavSys = FNavigationSystem::GetCurrent<UNavigationSystemV1>(GetWorld());
+	ANavigationData* NavData = NavSys ? NavSys->GetDefaultNavDataInstance(FNavigationSystem::DontCreate) : nullptr;
+
+	// identifies this order, so paths for superseded orders can be ignored
+	const uint32 Serial = ++LastSerial;
+
+	// track the clusters waiting for their path, so the result is reported once all of them are done.
+	// The move starts with one pending cluster, held until every cluster has been requested
+	FStrategyGroupMove& GroupMove = PendingMoves.Add(Serial);
+	GroupMove.PendingClusters = 1;
+	GroupMove.OnIssued = MoveTemp(OnIssued);
+
+	bool bAllIssued = true;
+
+	// group the units into clusters around the first unassigned unit
+	TBitArray<> Clustered(false, Units.Num());
+	TArray<int32> Members;
+
+	const double ClusterRadiusSq = FMath::Square(ClusterRadius);
+
+	for (int32 Seed = 0; Seed < Units.Num(); ++Seed)
+	{
+		if (Clustered[Seed])
+		{
+			continue;
+		}
+
+		const FVector SeedLocation = Units[Seed]->GetActorLocation();
+
+		Members.Reset();
+		FVector Center = FVector::ZeroVector;
+		FVector End = FVector::ZeroVector;
+
+		for (int32 Index = Seed; Index < Units.Num(); ++Index)
+		{
+			if (!Clustered[Index] && FVector::DistSquared2D(Units[Index]->GetActorLocation(), SeedLocation) <= ClusterRadiusSq)
+			{
+				Clustered[Index] = true;
+				Members.Add(Index);
+
+				Center += Units[Index]->GetActorLocation();
+				End += Goals[Index];
+			}
+		}
+
+		Center /= Members.Num();
+		End /= Members.Num();
+
+		// start the path from the unit closest to the cluster center, so it starts on the navmesh
+		int32 StartIndex = Members[0];
+
+		for (const int32 Index : Members)
+		{
+			if (FVector::DistSquared2D(Units[Index]->GetActorLocation(), Center) < FVector::DistSquared2D(Units[StartIndex]->GetActorLocation(), Center))
+			{
+				StartIndex = Index;
+			}
+		}
+
+		const FVector Start = Units[StartIndex]->GetActorLocation();
+		const FVector Right = FVector::CrossProduct(FVector::UpVector, (End - Start).GetSafeNormal2D());
+
+		FStrategyPathCluster Cluster;
+		Cluster.AcceptanceRadius = AcceptanceRadius;
+		Cluster.Serial = Serial;
+
+		for (const int32 Index : Members)
+		{
+			Cluster.Units.Add(Units[Index]);
+			Cluster.UnitKeys.Add(FObjectKey(Units[Index]));
+			Cluster.Goals.Add(Goals[Index]);
+			Cluster.LateralOffsets.Add(FMath::Clamp((Units[Index]->GetActorLocation() - Start) | Right, -MaxCorridorOffset, MaxCorridorOffset));
+
+			UnitSerials.Add(FObjectKey(Units[Index]), Serial);
+		}
+
+		// without navigation, let each unit handle its own move
+		if (!NavData)
+		{
+			bAllIssued &= MoveIndividually(Cluster);
+			continue;
+		}
+
+		// request the shared path
+		FPathFindingQuery Query(this, *NavData, Start, End, NavData->GetDefaultQueryFilter());
+		Query.SetAllowPartialPaths(true);
+		Query.SetRequireNavigableEndLocation(false);
+
+		const uint32 QueryID = NavSys->FindPathAsync(Units[StartIndex]->GetNavAgentPropertiesRef(), Query, FNavPathQueryDelegate::CreateUObject(this, &UStrategyGroupPathfinder::OnClusterPathFound));
+
+		if (QueryID == INVALID_NAVQUERYID)
+		{
+			bAllIssued &= MoveIndividually(Cluster);
+			continue;
+		}
+
+		PendingClusters.Add(QueryID, MoveTemp(Cluster));
+		++PendingMoves.FindChecked(Serial).PendingClusters;
+	}
+
+	// release the hold. Reports the move now if no cluster is waiting for its path
+	ResolveCluster(Serial, bAllIssued);
+}
+
+void UStrategyGroupPathfinder::Deinitialize()
+{
+	PendingClusters.Empty();
+	UnitSerials.Empty();
+	PendingMoves.Empty();
+
+	Super::Deinitialize();
+}
+
+void UStrategyGroupPathfinder::OnClusterPathFound(uint32 QueryID, ENavigationQueryResult::Type Result, FNavPathSharedPtr Path)
+{
+	FStrategyPathCluster Cluster;
+
+	if (!PendingClusters.RemoveAndCopyValue(QueryID, Cluster))
+	{
+		return;
+	}
+
+	// fall back to individual moves if the shared path failed
+	bool bAllIssued;
+
+	if (Result == ENavigationQueryResult::Success && Path.IsValid() && Path->GetPathPoints().Num() >= 2)
+	{
+		bAllIssued = FollowSharedPath(Cluster, *Path, Path->GetNavigationDataUsed());
+
+	} else {
+
+		bAllIssued = MoveIndividually(Cluster);
+	}
+
+	ResolveCluster(Cluster.Serial, bAllIssued);
+}
+
+bool UStrategyGroupPathfinder::FollowSharedPath(const FStrategyPathCluster& Cluster, const FNavigationPath& SharedPath, const ANavigationData* NavData)
+{
+	const TArray<FNavPathPoint>& SharedPoints = SharedPath.GetPathPoints();
+
+	// the first and last points are replaced by each unit's own location and goal
+	const int32 NumCorners = SharedPoints.Num() - 2;
+
+	// offset the corridor corners sideways to keep each unit's place in the group,
+	// and project all of them to the navmesh in a single batch
+	TArray<FNavigationProjectionWork> Workload;
+	Workload.Reserve(Cluster.Units.Num() * NumCorners);
+
+	for (int32 UnitIndex = 0; UnitIndex < Cluster.Units.Num(); ++UnitIndex)
+	{
+		for (int32 Corner = 1; Corner <= NumCorners; ++Corner)
+		{
+			const FVector Direction = (SharedPoints[Corner + 1].Location - SharedPoints[Corner - 1].Location).GetSafeNormal2D();
+			const FVector Side = FVector::CrossProduct(FVector::UpVector, Direction);
+
+			Workload.Emplace(SharedPoints[Corner].Location + Side * Cluster.LateralOffsets[UnitIndex]);
+		}
+	}
+
+	if (NavData && Workload.Num() > 0)
+	{
+		NavData->BatchProjectPoints(Workload, FVector(10.0f, 10.0f, 250.0f), NavData->GetDefaultQueryFilter());
+	}
+
+	// a segment is blocked if a navmesh raycast along it hits the edge of the navmesh
+	const FSharedConstNavQueryFilter QueryFilter = NavData ? NavData->GetDefaultQueryFilter() : nullptr;
+
+	auto IsSegmentBlocked = [NavData, &QueryFilter](const FVector& From, const FVector& To)
+	{
+		FVector HitLocation;
+		return NavData && NavData->Raycast(From, To, HitLocation, QueryFilter);
+	};
+
+	bool bAllIssued = true;
+	TArray<FVector> Points;
+
+	for (int32 UnitIndex = 0; UnitIndex < Cluster.Units.Num(); ++UnitIndex)
+	{
+		if (!ClaimUnit(Cluster, UnitIndex))
+		{
+			continue;
+		}
+
+		AStrategyUnit* Unit = Cluster.Units[UnitIndex].Get();
+
+		// build the unit's copy of the corridor. Offset corners that left the navmesh, or can't be reached
+		// in a straight line from the previous point, use the shared corner instead
+		Points.Reset();
+		Points.Add(Unit->GetActorLocation());
+
+		bool bBlocked = false;
+
+		for (int32 Corner = 1; Corner <= NumCorners && !bBlocked; ++Corner)
+		{
+			const FVector& SharedCorner = SharedPoints[Corner].Location;
+			const FNavigationProjectionWork& Projection = Workload[UnitIndex * NumCorners + Corner - 1];
+
+			FVector NextPoint = NavData && Projection.bResult ? Projection.OutLocation.Location : SharedCorner;
+
+			if (NextPoint != SharedCorner && IsSegmentBlocked(Points.Last(), NextPoint))
+			{
+				NextPoint = SharedCorner;
+			}
+
+			bBlocked = IsSegmentBlocked(Points.Last(), NextPoint);
+			Points.Add(NextPoint);
+		}
+
+		Points.Add(Cluster.Goals[UnitIndex]);
+
+		bBlocked = bBlocked || IsSegmentBlocked(Points.Last(1), Points.Last());
+
+		// if the corridor is blocked for this unit, or it can't follow it, let it find its own path
+		if (!bBlocked)
+		{
+			FNavPathSharedPtr UnitPath = MakeShared<FNavigationPath>(Points);
+			UnitPath->SetNavigationDataUsed(NavData);
+			UnitPath->MarkReady();
+
+			if (Unit->FollowPath(UnitPath, Cluster.AcceptanceRadius))
+			{
+				continue;
+			}
+		}
+
+		bAllIssued &= Unit->MoveToLocation(Cluster.Goals[UnitIndex], Cluster.AcceptanceRadius);
+	}
+
+	return bAllIssued;
+}
+
+bool UStrategyGroupPathfinder::MoveIndividually(const FStrategyPathCluster& Cluster)
+{
+	bool bAllIssued = true;
+
+	for (int32 UnitIndex = 0; UnitIndex < Cluster.Units.Num(); ++UnitIndex)
+	{
+		if (!ClaimUnit(Cluster, UnitIndex))
+		{
+			continue;
+		}
+
+		bAllIssued &= Cluster.Units[UnitIndex]->MoveToLocation(Cluster.Goals[UnitIndex], Cluster.AcceptanceRadius);
+	}
+
+	return bAllIssued;
+}
+
+bool UStrategyGroupPathfinder::ClaimUnit(const FStrategyPathCluster& Cluster, int32 UnitIndex)
+{
+	const FObjectKey& UnitKey = Cluster.UnitKeys[UnitIndex];
+	const uint32* UnitSerial = UnitSerials.Find(UnitKey);
+
+	// skip units that were given a newer order while the path was pending
+	if (!UnitSerial || *UnitSerial != Cluster.Serial)
+	{
+		return false;
+	}
+
+	// the unit either takes this move or was destroyed while the path was pending. Either way its serial is no longer needed
+	UnitSerials.Remove(UnitKey);
+
+	return IsValid(Cluster.Units[UnitIndex].Get());
+}
+
+void UStrategyGroupPathfinder::ResolveCluster(uint32 Serial, bool bAllIssued)
+{
+	FStrategyGroupMove* GroupMove = PendingMoves.Find(Serial);
+
+	if (!GroupMove)
+	{
+		return;
+	}
+
+	GroupMove->bAllIssued &= bAllIssued;
+
+	if (--GroupMove->PendingClusters > 0)
+	{
+		return;
+	}
+
+	// remove the move before reporting it, in case the callback issues a new one
+	FStrategyGroupMove Resolved;
+	PendingMoves.RemoveAndCopyValue(Serial, Resolved);
+
+	Resolved.OnIssued.ExecuteIfBound(Resolved.bAllIssued);
+}
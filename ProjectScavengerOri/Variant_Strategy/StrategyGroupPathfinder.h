@@ -0,0 +1,120 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "AI/Navigation/NavigationTypes.h"
+#include "UObject/ObjectKey.h"
+#include "StrategyGroupPathfinder.generated.h"
+
+class AStrategyUnit;
+class ANavigationData;
+struct FNavigationPath;
+
+/** Called once every unit of a group move has been given its move. bAllIssued is false if any unit couldn't move */
+DECLARE_DELEGATE_OneParam(FOnStrategyGroupMoveIssued, bool /* bAllIssued */);
+
+/** Units sharing one async path request */
+struct FStrategyPathCluster
+{
+	/** Units in the cluster */
+	TArray<TWeakObjectPtr<AStrategyUnit>> Units;
+
+	/** Keys of the units, parallel to Units. Still valid after a unit is destroyed */
+	TArray<FObjectKey> UnitKeys;
+
+	/** Final move goal of each unit, parallel to Units */
+	TArray<FVector> Goals;
+
+	/** Lateral distance of each unit from the path start, parallel to Units. Keeps units side by side along the corridor */
+	TArray<double> LateralOffsets;
+
+	/** Acceptance radius for the unit moves */
+	float AcceptanceRadius = 0.0f;
+
+	/** Serial of the group move that issued this cluster */
+	uint32 Serial = 0;
+};
+
+/** Group move waiting for its clusters' paths */
+struct FStrategyGroupMove
+{
+	/** Clusters still waiting for their path */
+	int32 PendingClusters = 0;
+
+	/** False once any unit move fails */
+	bool bAllIssued = true;
+
+	/** Called once every cluster has issued its moves */
+	FOnStrategyGroupMoveIssued OnIssued;
+};
+
+/**
+ *  Shared pathfinding for strategy group move orders
+ *  Units ordered together are clustered by location, and each cluster runs a single async path query
+ *  from its center. When the path comes back, each unit follows its own copy of the shared corridor,
+ *  offset to keep its place beside the other units, and ending on its own move goal.
+ *  Orders are issued without pathfinding on the game thread, however many units are selected
+ */
+UCLASS(Config = Game)
+class UStrategyGroupPathfinder : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+protected:
+
+	/** Units within this distance of a cluster's first unit share its path */
+	UPROPERTY(Config)
+	float ClusterRadius = 600.0f;
+
+	/** Max lateral distance a unit's path is offset from the shared corridor */
+	UPROPERTY(Config)
+	float MaxCorridorOffset = 200.0f;
+
+	/** Clusters waiting for their path, by query ID */
+	TMap<uint32, FStrategyPathCluster> PendingClusters;
+
+	/** Serial of the last group move each unit was given. Used to ignore paths for superseded orders */
+	TMap<FObjectKey, uint32> UnitSerials;
+
+	/** Group moves with clusters still waiting for their path, by serial */
+	TMap<uint32, FStrategyGroupMove> PendingMoves;
+
+	/** Serial of the last group move */
+	uint32 LastSerial = 0;
+
+public:
+
+	/**
+	 *  Moves each unit to its goal, sharing path queries between nearby units.
+	 *  Goals is parallel to Units. Units only start moving once their cluster's path is found.
+	 *  OnIssued is called once every unit has been given its move, which may be on this call
+	 *  if no path query was needed, and reports whether the move was issued for every unit
+	 */
+	void RequestGroupMove(const TArray<AStrategyUnit*>& Units, const TArray<FVector>& Goals, float AcceptanceRadius, FOnStrategyGroupMoveIssued OnIssued);
+
+	/** Subsystem cleanup */
+	virtual void Deinitialize() override;
+
+protected:
+
+	/** Called when a cluster's path query completes */
+	void OnClusterPathFound(uint32 QueryID, ENavigationQueryResult::Type Result, FNavPathSharedPtr Path);
+
+	/**
+	 *  Builds each unit's path along the shared corridor and starts the moves.
+	 *  Each offset segment is raycast on the navmesh. Blocked corners fall back to the shared corner,
+	 *  and units whose path is still blocked find their own. Returns false if any move failed
+	 */
+	bool FollowSharedPath(const FStrategyPathCluster& Cluster, const FNavigationPath& SharedPath, const ANavigationData* NavData);
+
+	/** Moves the cluster units with their own pathfinding, used if the shared path can't be found. Returns false if any move failed */
+	bool MoveIndividually(const FStrategyPathCluster& Cluster);
+
+	/** Returns true if the unit can take the cluster's move. Forgets the unit's order if it was destroyed */
+	bool ClaimUnit(const FStrategyPathCluster& Cluster, int32 UnitIndex);
+
+	/** Records a cluster's result on its group move, and reports the group move once its last cluster is done */
+	void ResolveCluster(uint32 Serial, bool bAllIssued);
+};
@@ -0,0 +1,72 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+
+#include "StrategyMoveOrder.h"
+#include "StrategyUnit.h"
+
+TSharedRef<FStrategyMoveOrder> FStrategyMoveOrder::Create(uint32 OrderID, const TArray<AStrategyUnit*>& Units, const FVector& Goal, float InteractionRadius)
+{
+	TSharedRef<FStrategyMoveOrder> Order = MakeShareable(new FStrategyMoveOrder(OrderID, Goal, InteractionRadius));
+
+	Order->Units.Reserve(Units.Num());
+	Order->Completed.Init(false, Units.Num());
+
+	// give each unit its slot. This replaces any order the unit was executing
+	for (AStrategyUnit* Unit : Units)
+	{
+		Unit->AssignMoveOrder(Order, Order->Units.Add(Unit));
+	}
+
+	return Order;
+}
+
+FStrategyMoveOrder::FStrategyMoveOrder(uint32 InOrderID, const FVector& InGoal, float InInteractionRadius)
+	: OrderID(InOrderID)
+	, Goal(InGoal)
+	, InteractionRadius(InInteractionRadius)
+{
+}
+
+bool FStrategyMoveOrder::Contains(const AStrategyUnit* Unit) const
+{
+	return IsValid(Unit) && Unit->GetMoveOrderID() == OrderID;
+}
+
+void FStrategyMoveOrder::MarkCompleted(int32 Slot)
+{
+	if (!Completed.IsValidIndex(Slot) || Completed[Slot])
+	{
+		return;
+	}
+
+	Completed[Slot] = true;
+
+	// resolve the order's interaction with the first unit to arrive near the destination.
+	// Units in the rear rows of the formation stop further away, so they don't use it up
+	if (bArrivedAtGoal)
+	{
+		return;
+	}
+
+	AStrategyUnit* Unit = Units[Slot].Get();
+
+	if (Unit && FVector::Dist2D(Goal, Unit->GetActorLocation()) < InteractionRadius)
+	{
+		bArrivedAtGoal = true;
+		OnArrivedAtGoal.ExecuteIfBound(*this, Unit);
+	}
+}
+
+bool FStrategyMoveOrder::IsActive() const
+{
+	// look for a unit that's still on its way and hasn't been given another order
+	for (int32 Slot = 0; Slot < Units.Num(); ++Slot)
+	{
+		if (!Completed[Slot] && Contains(Units[Slot].Get()))
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
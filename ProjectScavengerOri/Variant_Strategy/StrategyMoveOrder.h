@@ -0,0 +1,66 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+class AStrategyUnit;
+class FStrategyMoveOrder;
+
+/** Delegate to report the first unit of a move order arriving close to its destination */
+DECLARE_DELEGATE_TwoParams(FOnStrategyMoveOrderArrival, const FStrategyMoveOrder& /* Order */, AStrategyUnit* /* Unit */);
+
+/**
+ *  Tracks the units of a single strategy move order
+ *  Each unit is given a slot in the order and reports its arrival to it directly,
+ *  so completion is a bit in a bitmap instead of a dynamic delegate bound and unbound per unit.
+ *  Formation slots can be far from the destination, so the arrival delegate fires once, for the first unit to arrive
+ *  within the interaction radius of the destination, and the order's interaction is resolved a single time
+ */
+class FStrategyMoveOrder : public TSharedFromThis<FStrategyMoveOrder>
+{
+public:
+
+	/** Creates an order for the units and assigns it to each of them */
+	static TSharedRef<FStrategyMoveOrder> Create(uint32 OrderID, const TArray<AStrategyUnit*>& Units, const FVector& Goal, float InteractionRadius);
+
+	/** Returns the order ID */
+	uint32 GetOrderID() const { return OrderID; }
+
+	/** Returns the order's destination */
+	const FVector& GetGoal() const { return Goal; }
+
+	/** Returns true if the unit was given this order and hasn't been given another since */
+	bool Contains(const AStrategyUnit* Unit) const;
+
+	/** Marks the unit in the given slot as arrived. Fires the arrival delegate for the first unit within the interaction radius */
+	void MarkCompleted(int32 Slot);
+
+	/** Returns true if any unit is still executing this order */
+	bool IsActive() const;
+
+	/** Called once, when the first unit arrives within the interaction radius of the destination */
+	FOnStrategyMoveOrderArrival OnArrivedAtGoal;
+
+private:
+
+	FStrategyMoveOrder(uint32 InOrderID, const FVector& InGoal, float InInteractionRadius);
+
+	/** Order ID */
+	uint32 OrderID = 0;
+
+	/** Order destination */
+	FVector Goal;
+
+	/** Units in the order, by slot */
+	TArray<TWeakObjectPtr<AStrategyUnit>> Units;
+
+	/** Arrival flag for each slot */
+	TBitArray<> Completed;
+
+	/** Distance from the destination a unit must arrive within to resolve the interaction */
+	float InteractionRadius = 0.0f;
+
+	/** True once the arrival delegate has fired */
+	bool bArrivedAtGoal = false;
+};
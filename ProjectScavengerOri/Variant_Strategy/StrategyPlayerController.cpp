@@ -10,12 +10,16 @@
 #include "StrategyPawn.h"
 #include "Camera/CameraComponent.h"
 #include "InputActionValue.h"
+#include "InputAction.h"
 #include "StrategyHUD.h"
 #include "Engine/CollisionProfile.h"
 #include "Kismet/GameplayStatics.h"
 #include "StrategyUnit.h"
 #include "NavigationSystem.h"
-#include "Engine/OverlapResult.h"
+#include "StrategyUnitRegistry.h"
+#include "StrategyGroupPathfinder.h"
+#include "StrategyMoveOrder.h"
+#include "Managers/CursorService.h"
 
 AStrategyPlayerController::AStrategyPlayerController()
 {
@@ -72,7 +76,6 @@ void AStrategyPlayerController::SetupInputComponent()
 			EnhancedInputComponent->BindAction(InteractHoldAction, ETriggerEvent::Started, this, &AStrategyPlayerController::InteractHoldStarted);
 			EnhancedInputComponent->BindAction(InteractHoldAction, ETriggerEvent::Triggered, this, &AStrategyPlayerController::InteractHoldTriggered);
 
-			EnhancedInputComponent->BindAction(InteractClickAction, ETriggerEvent::Started, this, &AStrategyPlayerController::InteractClickStarted);
 			EnhancedInputComponent->BindAction(InteractClickAction, ETriggerEvent::Completed, this, &AStrategyPlayerController::InteractClickCompleted);
 
 			// Touch Interaction
@@ -87,6 +90,17 @@ void AStrategyPlayerController::SetupInputComponent()
 			EnhancedInputComponent->BindAction(TouchSecondaryAction, ETriggerEvent::Canceled, this, &AStrategyPlayerController::TouchSecondaryCompleted);
 
 			EnhancedInputComponent->BindAction(TouchDoubleTapAction, ETriggerEvent::Triggered, this, &AStrategyPlayerController::TouchDoubleTap);
+
+			// Control Groups
+			// bound on Started so holding the key saves or recalls the group once instead of every frame
+			for (const UInputAction* ControlGroupAction : ControlGroupActions)
+			{
+				EnhancedInputComponent->BindAction(ControlGroupAction, ETriggerEvent::Started, this, &AStrategyPlayerController::ControlGroup);
+			}
+
+			EnhancedInputComponent->BindAction(ControlGroupModifierAction, ETriggerEvent::Triggered, this, &AStrategyPlayerController::ControlGroupModifier);
+			EnhancedInputComponent->BindAction(ControlGroupModifierAction, ETriggerEvent::Completed, this, &AStrategyPlayerController::ControlGroupModifier);
+			EnhancedInputComponent->BindAction(ControlGroupModifierAction, ETriggerEvent::Canceled, this, &AStrategyPlayerController::ControlGroupModifier);
 		}
 	}
 }
@@ -109,27 +123,142 @@ void AStrategyPlayerController::OnPossess(APawn* InPawn)
 
 void AStrategyPlayerController::DragSelectUnits(const TArray<AStrategyUnit*>& Units)
 {
-	// do we have units in the list?
-	if (Units.Num() > 0)
+	// keep the current selection while the box is empty
+	if (Units.Num() == 0)
 	{
-		// ensure any previous units are deselected
-		DoDeselectAllCommand();
+		return;
+	}
 
-		// select each new unit
-		for (AStrategyUnit* CurrentUnit : Units)
-		{
-			// add the unit to the selection list
-			ControlledUnits.Add(CurrentUnit);
+	// the box is updated every frame while dragging, so only notify the units that entered or left it
+	TSet<AStrategyUnit*> BoxedUnits(Units);
+	TArray<AStrategyUnit*> ExitedUnits;
 
-			// select the unit
-			CurrentUnit->UnitSelected();
+	// drop any destroyed units first
+	bool bChanged = ControlledUnits.RemoveInvalid() > 0;
+
+	// find the units that are no longer in the box
+	for (AStrategyUnit* CurrentUnit : ControlledUnits)
+	{
+		// units still in the box stay selected. Remove them from the set so only the new ones are left
+		if (BoxedUnits.Remove(CurrentUnit) == 0)
+		{
+			ExitedUnits.Add(CurrentUnit);
 		}
 	}
+
+	// deselect the units that left the box
+	for (AStrategyUnit* CurrentUnit : ExitedUnits)
+	{
+		ControlledUnits.Remove(CurrentUnit);
+		CurrentUnit->UnitDeselected();
+
+		bChanged = true;
+	}
+
+	// select the units that entered the box
+	for (AStrategyUnit* CurrentUnit : BoxedUnits)
+	{
+		// add the unit to the selection list
+		ControlledUnits.Add(CurrentUnit);
+
+		// select the unit
+		CurrentUnit->UnitSelected();
+
+		bChanged = true;
+	}
+
+	if (bChanged)
+	{
+		SelectionChanged();
+	}
 }
 
-const TArray<AStrategyUnit*>& AStrategyPlayerController::GetSelectedUnits()
+void AStrategyPlayerController::DragSelectBox(const FVector2D& BoxStart, const FVector2D& BoxEnd)
 {
-	return ControlledUnits;
+	// get the units in the selection box from the registry's per frame projection of the on-screen units
+	if (UStrategyUnitRegistry* Registry = GetWorld()->GetSubsystem<UStrategyUnitRegistry>())
+	{
+		BoxedUnits.Reset();
+		Registry->QueryScreenRect(this, BoxStart, BoxEnd, BoxedUnits);
+
+		// update the unit selection. Only units entering or leaving the box are notified
+		DragSelectUnits(BoxedUnits);
+	}
+}
+
+void AStrategyPlayerController::SaveControlGroup(int32 GroupIndex)
+{
+	if (GroupIndex < 0)
+	{
+		return;
+	}
+
+	if (!ControlGroups.IsValidIndex(GroupIndex))
+	{
+		ControlGroups.SetNum(GroupIndex + 1);
+	}
+
+	// copy the current selection into the group
+	ControlledUnits.RemoveInvalid();
+	ControlGroups[GroupIndex] = ControlledUnits;
+}
+
+void AStrategyPlayerController::RecallControlGroup(int32 GroupIndex)
+{
+	if (!ControlGroups.IsValidIndex(GroupIndex))
+	{
+		return;
+	}
+
+	// drop any units destroyed since the group was saved
+	FStrategyUnitSelection& Group = ControlGroups[GroupIndex];
+	Group.RemoveInvalid();
+
+	// ignore empty groups so recalling an unused group doesn't clear the selection
+	if (Group.IsEmpty())
+	{
+		return;
+	}
+
+	// replace the selection unless the selection modifier is held
+	if (!bSelectionModifier)
+	{
+		// deselect the units that aren't in the group
+		for (AStrategyUnit* CurrentUnit : ControlledUnits)
+		{
+			if (!Group.Contains(CurrentUnit))
+			{
+				CurrentUnit->UnitDeselected();
+			}
+		}
+
+		// keep the units that are already selected so they aren't notified again
+		FStrategyUnitSelection PreviousUnits = MoveTemp(ControlledUnits);
+		ControlledUnits.Reset();
+
+		for (AStrategyUnit* CurrentUnit : Group)
+		{
+			ControlledUnits.Add(CurrentUnit);
+
+			if (!PreviousUnits.Contains(CurrentUnit))
+			{
+				CurrentUnit->UnitSelected();
+			}
+		}
+
+	} else {
+
+		// add the group to the selection
+		for (AStrategyUnit* CurrentUnit : Group)
+		{
+			if (ControlledUnits.Add(CurrentUnit))
+			{
+				CurrentUnit->UnitSelected();
+			}
+		}
+	}
+
+	SelectionChanged();
 }
 
 void AStrategyPlayerController::MoveCamera(const FInputActionValue& Value)
@@ -194,6 +323,9 @@ void AStrategyPlayerController::SelectHoldTriggered(const FInputActionValue& Val
 
 	// update the selection box on the HUD
 	StrategyHUD->DragSelectUpdate(StartingSelectionPosition, SelectionSize, SelectionPosition, true);
+
+	// select the units in the box
+	DragSelectBox(StartingSelectionPosition, SelectionPosition);
 }
 
 void AStrategyPlayerController::SelectHoldCompleted(const FInputActionValue& Value)
@@ -233,16 +365,15 @@ void AStrategyPlayerController::InteractHoldTriggered(const FInputActionValue& V
 	DoDragScrollCommand();
 }
 
-void AStrategyPlayerController::InteractClickStarted(const FInputActionValue& Value)
-{
-
-	// reset the interaction flag
-	ResetInteraction();
-}
-
 void AStrategyPlayerController::InteractClickCompleted(const FInputActionValue& Value)
 {
 
+	// drop the units destroyed while selected, so the count below only includes units that can move
+	if (ControlledUnits.RemoveInvalid() > 0)
+	{
+		SelectionChanged();
+	}
+
 	// do we have any units in the control list and a valid interaction location under the cursor?
 	if (ControlledUnits.Num() > 0 && GetLocationUnderCursor(CachedInteraction))
 	{
@@ -281,6 +412,9 @@ void AStrategyPlayerController::TouchPrimaryHoldTriggered(const FInputActionValu
 		// update the selection box on the HUD
 		StrategyHUD->DragSelectUpdate(StartingInteractionPosition, CurrentInteractionPosition - StartingSecondFingerPosition, CurrentInteractionPosition, true);
 
+		// select the units in the box
+		DragSelectBox(StartingInteractionPosition, CurrentInteractionPosition);
+
 	} else {
 
 		// do a drag scroll instead
@@ -342,27 +476,37 @@ void AStrategyPlayerController::TouchDoubleTap(const FInputActionValue& Value)
 	}
 }
 
-void AStrategyPlayerController::DoSelectionCommand()
+void AStrategyPlayerController::ControlGroup(const FInputActionInstance& Instance)
 {
+	// the group number is the index of the triggering action
+	const int32 GroupIndex = ControlGroupActions.IndexOfByKey(Instance.GetSourceAction());
 
-	// do a sphere sweep to look for actors to select
-	FHitResult OutHit;
+	// is the control group modifier held?
+	if (bControlGroupModifier)
+	{
+		// save the selection to the group
+		SaveControlGroup(GroupIndex);
 
-	const FVector Start = CachedSelection;
-	const FVector End = Start + FVector::UpVector * 350.0f;
+	} else {
 
-	FCollisionShape InteractionSphere;
-	InteractionSphere.SetSphere(InteractionRadius);
+		// select the group
+		RecallControlGroup(GroupIndex);
+	}
+}
 
-	FCollisionObjectQueryParams ObjectParams;
-	ObjectParams.AddObjectTypesToQuery(ECC_Pawn);
+void AStrategyPlayerController::ControlGroupModifier(const FInputActionValue& Value)
+{
 
-	FCollisionQueryParams QueryParams;
-	QueryParams.AddIgnoredActor(this);
-	QueryParams.AddIgnoredActor(GetPawn());
-	QueryParams.bTraceComplex = true;
+	// update the control group modifier flag
+	bControlGroupModifier = Value.Get<bool>();
+}
+
+void AStrategyPlayerController::DoSelectionCommand()
+{
 
-	GetWorld()->SweepSingleByObjectType(OutHit, Start, End, FQuat::Identity, ObjectParams, InteractionSphere, QueryParams);
+	// look for the closest unit around the selection point on the unit registry
+	UStrategyUnitRegistry* Registry = GetWorld()->GetSubsystem<UStrategyUnitRegistry>();
+	AStrategyUnit* SelectedUnit = Registry ? Registry->FindNearestUnit(CachedSelection, InteractionRadius) : nullptr;
 
 	// if we're using the mouse and are not holding the selection modifier key, deselect any units first
 	if (InputMode == SIM_Mouse && !bSelectionModifier)
@@ -371,38 +515,36 @@ void AStrategyPlayerController::DoSelectionCommand()
 		DoDeselectAllCommand();
 	}
 
-	// did we hit a unit?
-	if (OutHit.bBlockingHit)
+	// did we find a unit?
+	if (SelectedUnit)
 	{
 
 		// update the target unit
-		TargetUnit = Cast<AStrategyUnit>(OutHit.GetActor());
+		TargetUnit = SelectedUnit;
 
-		if (TargetUnit)
+		// is the unit already in the controlled list?
+		if (ControlledUnits.Contains(TargetUnit))
 		{
 
-			// is the unit already in the controlled list?
-			if (ControlledUnits.Contains(TargetUnit))
-			{
-
-				// remove the units from the controlled list
-				ControlledUnits.Remove(TargetUnit);
+			// remove the units from the controlled list
+			ControlledUnits.Remove(TargetUnit);
 
-				// tell the unit it's been deselected
-				TargetUnit->UnitDeselected();
+			// tell the unit it's been deselected
+			TargetUnit->UnitDeselected();
 
-			}
-			else {
+		}
+		else {
 
-				// add the unit to the controlled list
-				ControlledUnits.Add(TargetUnit);
+			// add the unit to the controlled list
+			ControlledUnits.Add(TargetUnit);
 
-				// tell the unit it's been selected
-				TargetUnit->UnitSelected();
+			// tell the unit it's been selected
+			TargetUnit->UnitSelected();
 
-			}
 		}
 
+		SelectionChanged();
+
 	} else {
 
 		// are we using touch input?
@@ -429,51 +571,53 @@ void AStrategyPlayerController::DoSelectionCommand()
 void AStrategyPlayerController::DoSelectAllOnScreenCommand()
 {
 
-	// find all NPCs currently on screen
-	TArray<AActor*> FoundActors;
-	UGameplayStatics::GetAllActorsOfClass(GetWorld(), AStrategyUnit::StaticClass(), FoundActors);
+	// find all units currently on screen through the unit registry
+	TArray<AStrategyUnit*> FoundUnits;
 
-	// process each actor found
-	for (AActor* CurrentActor : FoundActors)
+	if (UStrategyUnitRegistry* Registry = GetWorld()->GetSubsystem<UStrategyUnitRegistry>())
 	{
-		// cast back to our unit class
-		if (AStrategyUnit* CurrentUnit = Cast<AStrategyUnit>(CurrentActor))
-		{
-			// has the actor been recently rendered?
-			if (CurrentActor->WasRecentlyRendered(0.2f))
-			{
-
-				// is the actor not on our controlled units list?
-				if (!ControlledUnits.Contains(CurrentUnit))
-				{
-					// add it to the controlled units list
-					ControlledUnits.Add(CurrentUnit);
+		Registry->QueryOnScreen(this, FoundUnits);
+	}
 
-					// notify it of selection
-					CurrentUnit->UnitSelected();
-				}
-			}
-		}		
+	// process each unit found
+	for (AStrategyUnit* CurrentUnit : FoundUnits)
+	{
+		// add it to the controlled units if it's not there already
+		if (ControlledUnits.Add(CurrentUnit))
+		{
+			// notify it of selection
+			CurrentUnit->UnitSelected();
+		}
 	}
 
+	SelectionChanged();
 }
 
 void AStrategyPlayerController::DoDeselectAllCommand()
 {
 
-	// tell each controlled unit it's been deselected
+	// tell each controlled unit it's been deselected. Destroyed units are skipped by the selection
 	for (AStrategyUnit* CurrentUnit : ControlledUnits)
 	{
-		// ensure the unit hasn't been destroyed
-		if (IsValid(CurrentUnit))
-		{
-
-			CurrentUnit->UnitDeselected();
-		}
+		CurrentUnit->UnitDeselected();
 	}
 
 	// clear the controlled units list
-	ControlledUnits.Empty();
+	ControlledUnits.Reset();
+
+	SelectionChanged();
+}
+
+void AStrategyPlayerController::SelectionChanged()
+{
+	// the HUD is only available after possession
+	if (StrategyHUD)
+	{
+		// don't count units destroyed while selected
+		ControlledUnits.RemoveInvalid();
+
+		StrategyHUD->SetSelectedUnitsCount(ControlledUnits.Num());
+	}
 }
 
 void AStrategyPlayerController::DoDragScrollCommand()
@@ -528,140 +672,75 @@ void AStrategyPlayerController::DoMoveUnitsCommand()
 
 	}
 
-	// get the closest selected unit to the move goal. This will be our lead unit
-	AStrategyUnit* Closest = GetClosestSelectedUnitToLocation(CurrentMoveGoal);
+	// gather the units to move
+	TArray<AStrategyUnit*> MovingUnits;
+	MovingUnits.Reserve(ControlledUnits.Num());
 
-	// this will be set to true if any of the move requests fail
-	bool bInteractionFailed = false;
-
-	// process each unit in the controlled list
 	for (AStrategyUnit* CurrentUnit : ControlledUnits)
 	{
-		if (IsValid(CurrentUnit))
-		{
-
-			// stop the unit
-			CurrentUnit->StopMoving();
-
-			// move the lead unit to the goal, all other units to random navigable points around it
-			FVector MoveGoal = CurrentMoveGoal;
-
-			if (CurrentUnit != Closest)
-			{
-
-				UNavigationSystemV1::K2_GetRandomLocationInNavigableRadius(GetWorld(), CurrentMoveGoal, MoveGoal, InteractionRadius * 0.66f);
-			}
-
-			// subscribe to the unit's move completed delegate
-			CurrentUnit->OnMoveCompleted.AddDynamic(this, &AStrategyPlayerController::OnMoveCompleted);
-
-			// set up movement to the goal location
-			if (!CurrentUnit->MoveToLocation(MoveGoal, InteractionRadius * 0.66f))
-			{
-				// the move request failed, so flag it
-				bInteractionFailed = true;
-			}
-		}
-
+		MovingUnits.Add(CurrentUnit);
 	}
 
-	// play the cursor feedback depending on whether our move succeeded or not
-	BP_CursorFeedback(CachedInteraction, !bInteractionFailed);
-
-}
+	// plan a formation around the goal, facing the direction of travel
+	TArray<FVector> MoveGoals;
+	Formation.Plan(GetWorld(), MovingUnits, CurrentMoveGoal, MoveGoals);
 
-void AStrategyPlayerController::OnMoveCompleted(AStrategyUnit* MovedUnit)
-{
-	// is the unit valid?
-	if (IsValid(MovedUnit))
+	// stop the units
+	for (AStrategyUnit* CurrentUnit : MovingUnits)
 	{
-		// unsubscribe from the delegate
-		MovedUnit->OnMoveCompleted.RemoveDynamic(this, &AStrategyPlayerController::OnMoveCompleted);
-		
-		// skip if interactions are locked
-		if (!bAllowInteraction)
-		{
-			return;
-		}
+		CurrentUnit->StopMoving();
+	}
 
-		// disallow additional interactions until we reset
-		bAllowInteraction = false;
+	// drop the orders that have no units left on the way
+	ActiveMoveOrders.RemoveAllSwap([](const TSharedPtr<FStrategyMoveOrder>& Order) { return !Order->IsActive(); });
 
-		// is the unit close enough to the cached interaction location?
-		if(FVector::Dist2D(CachedInteraction, MovedUnit->GetActorLocation()) < InteractionRadius)
-		{
+	// track the order. The units report their arrival to it, and it resolves the interaction once,
+	// for the first unit to arrive within the interaction radius of the goal
+	TSharedRef<FStrategyMoveOrder> MoveOrder = FStrategyMoveOrder::Create(++LastMoveOrderID, MovingUnits, CurrentMoveGoal, InteractionRadius);
+	MoveOrder->OnArrivedAtGoal.BindUObject(this, &AStrategyPlayerController::OnMoveOrderArrival);
 
-			// do an overlap test to find nearby interactive objects
-			TArray<FOverlapResult> OutOverlaps;
+	ActiveMoveOrders.Add(MoveOrder);
 
-			FCollisionShape CollisionSphere;
-			CollisionSphere.SetSphere(InteractionRadius);
+	// move the units to their formation slots. Nearby units share an async path request, so the units start moving
+	// once their path is ready instead of pathfinding individually on this frame.
+	// The cursor feedback plays once every unit has been given its move
+	if (UStrategyGroupPathfinder* GroupPathfinder = GetWorld()->GetSubsystem<UStrategyGroupPathfinder>())
+	{
+		GroupPathfinder->RequestGroupMove(MovingUnits, MoveGoals, Formation.SlotAcceptanceRadius,
+			FOnStrategyGroupMoveIssued::CreateUObject(this, &AStrategyPlayerController::OnGroupMoveIssued, CachedInteraction));
 
-			FCollisionObjectQueryParams ObjectParams;
-			ObjectParams.AddObjectTypesToQuery(ECC_WorldDynamic);
-			
-			FCollisionQueryParams QueryParams;
+	} else {
 
-			QueryParams.AddIgnoredActor(MovedUnit);
+		BP_CursorFeedback(CachedInteraction, false);
+	}
 
-			for(const AStrategyUnit* CurSelected : ControlledUnits)
-			{
-				QueryParams.AddIgnoredActor(CurSelected);
-			}
+}
 
-			if (GetWorld()->OverlapMultiByObjectType(OutOverlaps, CachedInteraction, FQuat::Identity, ObjectParams, CollisionSphere, QueryParams))
-			{
-				for (const FOverlapResult& CurrentOverlap : OutOverlaps)
-				{
-					if (AStrategyUnit* CurrentUnit = Cast<AStrategyUnit>(CurrentOverlap.GetActor()))
-					{
-						CurrentUnit->Interact(MovedUnit);
-					}
-				}
-			}
-		}
-	}
+void AStrategyPlayerController::OnGroupMoveIssued(bool bAllIssued, FVector FeedbackLocation)
+{
+	// play the cursor feedback depending on whether our move succeeded or not
+	BP_CursorFeedback(FeedbackLocation, bAllIssued);
 }
 
-AStrategyUnit* AStrategyPlayerController::GetClosestSelectedUnitToLocation(FVector TargetLocation)
+void AStrategyPlayerController::OnMoveOrderArrival(const FStrategyMoveOrder& Order, AStrategyUnit* MovedUnit)
 {
-	// closest unit and distance
-	AStrategyUnit* OutUnit = nullptr;
-	float Closest = 0.0f;
+	// the order only reports units that arrived within the interaction radius of its destination.
+	// Find the units whose interaction range reaches the destination on the unit registry
+	TArray<AStrategyUnit*> NearbyUnits;
 
-	// process each unit on the list
-	for (AStrategyUnit* CurrentUnit : ControlledUnits)
+	if (UStrategyUnitRegistry* Registry = GetWorld()->GetSubsystem<UStrategyUnitRegistry>())
 	{
-		if (CurrentUnit != nullptr)
-		{
-			// have we selected a unit already?
-			if (OutUnit != nullptr)
-			{
-				// calculate the squared distance to the target location
-				float Dist = FVector::DistSquared2D(TargetLocation, CurrentUnit->GetActorLocation());
-
-				// is this unit closer?
-				if (Dist < Closest)
-				{
-					// update the closest unit and distance
-					OutUnit = CurrentUnit;
-					Closest = Dist;
-				}
-
-			} else {
-
-				// no previously selected unit, so use this one
-				OutUnit = CurrentUnit;
+		Registry->QueryInteractionRange(Order.GetGoal(), InteractionRadius, NearbyUnits);
+	}
 
-				// initialize the closest distance
-				Closest = FVector::DistSquared2D(TargetLocation, CurrentUnit->GetActorLocation());
-			}
+	for (AStrategyUnit* CurrentUnit : NearbyUnits)
+	{
+		// units moving together don't interact with each other
+		if (!Order.Contains(CurrentUnit))
+		{
+			CurrentUnit->Interact(MovedUnit);
 		}
-		
 	}
-
-	// return the selected unit
-	return OutUnit;
 }
 
 FVector2D AStrategyPlayerController::GetMouseLocation()
@@ -680,19 +759,10 @@ FVector2D AStrategyPlayerController::GetMouseLocation()
 
 bool AStrategyPlayerController::GetLocationUnderCursor(FVector& Location)
 {
-	// trace the visibility channel at the cursor location
-	FHitResult OutHit;
-
-	GetHitResultUnderCursorByChannel(SelectionTraceChannel, true, OutHit);
-
-	// if there was a blocking hit, return the hit location
-	if (OutHit.bBlockingHit)
-	{
-		Location = OutHit.Location;
-		return true;
-	}
+	// use the cursor service's cached trace, so other systems asking this frame don't trace the same pixel again
+	UCursorService* CursorService = UCursorService::Get(this);
 
-	return OutHit.bBlockingHit;
+	return CursorService && CursorService->GetCursorLocation(SelectionTraceChannel, Location);
 }
 
 FVector AStrategyPlayerController::ProjectTouchPointToWorldSpace()
@@ -718,8 +788,3 @@ FVector AStrategyPlayerController::ProjectTouchPointToWorldSpace()
 	// failed to deproject, return a zero vector
 	return FVector::ZeroVector;
 }
-
-void AStrategyPlayerController::ResetInteraction()
-{
-	bAllowInteraction = true;
-}
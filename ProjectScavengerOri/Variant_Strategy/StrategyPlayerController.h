@@ -4,15 +4,19 @@
 
 #include "CoreMinimal.h"
 #include "GameFramework/PlayerController.h"
+#include "StrategyUnitSelection.h"
+#include "StrategyFormation.h"
 #include "StrategyPlayerController.generated.h"
 
 class AStrategyPawn;
 class UInputMappingContext;
 class UNiagaraSystem;
 struct FInputActionValue;
+struct FInputActionInstance;
 class AStrategyHUD;
 class AStrategyNPC;
 class UInputAction;
+class FStrategyMoveOrder;
 
 /** Enum to determine the last used input type */
 UENUM(BlueprintType)
@@ -58,8 +62,8 @@ protected:
 	/** If true, double-tap touch select all mode is active */
 	bool bDoubleTapActive = false;
 
-	/** If true, allow the player to interact with game objects */
-	bool bAllowInteraction = true;
+	/** If true, control group inputs save the selection instead of recalling it */
+	bool bControlGroupModifier = false;
 
 	/** Input Action for moving the camera */
 	UPROPERTY(EditAnywhere, Category="Input")
@@ -109,6 +113,14 @@ protected:
 	UPROPERTY(EditAnywhere, Category="Input")
 	UInputAction* TouchDoubleTapAction;
 
+	/** Input Actions for each control group. The index in the array is the group number */
+	UPROPERTY(EditAnywhere, Category="Input")
+	TArray<UInputAction*> ControlGroupActions;
+
+	/** Input Action for switching control group inputs to save the selection */
+	UPROPERTY(EditAnywhere, Category="Input")
+	UInputAction* ControlGroupModifierAction;
+
 	/** Max distance to look for nearby units when doing a click or touch interaction */
 	UPROPERTY(EditAnywhere, Category="Input", meta = (ClampMin = 0, ClampMax = 10000, Units = "cm"))
 	float InteractionRadius = 250.0f;
@@ -160,6 +172,10 @@ protected:
 	UPROPERTY(EditAnywhere, Category = "Camera", meta = (ClampMin = 0, ClampMax = 10000))
 	float DragMultiplier = 0.1f;
 
+	/** Formation selected units move in */
+	UPROPERTY(EditAnywhere, Category = "Formation")
+	FStrategyFormation Formation;
+
 	/** Trace channel to use for selection trace checks */
 	UPROPERTY(EditAnywhere, Category = "Selection")
 	TEnumAsByte<ETraceTypeQuery> SelectionTraceChannel;
@@ -167,8 +183,20 @@ protected:
 	/** Currently selected unit */
 	AStrategyUnit* TargetUnit = nullptr;
 
-	/** Currently selected unit list */
-	TArray<AStrategyUnit*> ControlledUnits;
+	/** Currently selected units */
+	FStrategyUnitSelection ControlledUnits;
+
+	/** Units in the drag select box. Kept between frames to avoid reallocating while dragging */
+	TArray<AStrategyUnit*> BoxedUnits;
+
+	/** Saved control groups, one per control group action */
+	TArray<FStrategyUnitSelection> ControlGroups;
+
+	/** Move orders with units still on their way */
+	TArray<TSharedPtr<FStrategyMoveOrder>> ActiveMoveOrders;
+
+	/** ID of the last move order */
+	uint32 LastMoveOrderID = 0;
 
 public:
 
@@ -183,14 +211,23 @@ public:
 
 public:
 
-	/** Updates selected units from the HUD's drag select box */
+	/** Updates selected units from the drag select box. Only units entering or leaving the box are notified */
 	void DragSelectUnits(const TArray<AStrategyUnit*>& Units);
 
 	/** Passes the list of selected units */
-	const TArray<AStrategyUnit*>& GetSelectedUnits();
+	const FStrategyUnitSelection& GetSelectedUnits() const { return ControlledUnits; }
+
+	/** Saves the current selection to the given control group */
+	void SaveControlGroup(int32 GroupIndex);
+
+	/** Selects the units in the given control group. Adds them to the current selection if the selection modifier is held */
+	void RecallControlGroup(int32 GroupIndex);
 
 protected:
 
+	/** Selects the units whose bounds overlap the drag select box between the given screen positions */
+	void DragSelectBox(const FVector2D& BoxStart, const FVector2D& BoxEnd);
+
 	/** Moves the camera by the given input */
 	void MoveCamera(const FInputActionValue& Value);
 
@@ -221,9 +258,6 @@ protected:
 	/** Interaction hold input triggered */
 	void InteractHoldTriggered(const FInputActionValue& Value);
 
-	/** Interaction click input started */
-	void InteractClickStarted(const FInputActionValue& Value);
-
 	/** Interaction click input completed */
 	void InteractClickCompleted(const FInputActionValue& Value);
 
@@ -248,6 +282,12 @@ protected:
 	/** Touch primary finger double tap triggered */
 	void TouchDoubleTap(const FInputActionValue& Value);
 
+	/** Control group input triggered */
+	void ControlGroup(const FInputActionInstance& Instance);
+
+	/** Presses or releases the control group modifier key */
+	void ControlGroupModifier(const FInputActionValue& Value);
+
 	/** Attempt to select or deselect units at the cached location */
 	void DoSelectionCommand();
 
@@ -263,12 +303,14 @@ protected:
 	/** Move all selected units */
 	void DoMoveUnitsCommand();
 
-	/** Called when a unit move is completed */
-	UFUNCTION()
-	void OnMoveCompleted(AStrategyUnit* MovedUnit);
+	/** Called once every unit of a move command has been given its move. Plays the cursor feedback */
+	void OnGroupMoveIssued(bool bAllIssued, FVector FeedbackLocation);
 
-	/** Sorts all controlled units based on their distance to the provided world location */
-	AStrategyUnit* GetClosestSelectedUnitToLocation(FVector TargetLocation);
+	/** Called when the first unit of a move order arrives near its destination. Interacts with the units around the destination */
+	void OnMoveOrderArrival(const FStrategyMoveOrder& Order, AStrategyUnit* MovedUnit);
+
+	/** Pushes the selected units count to the HUD. Called whenever the selection changes */
+	void SelectionChanged();
 
 	/** Calculates and returns the current mouse location */
 	FVector2D GetMouseLocation();
@@ -282,7 +324,4 @@ protected:
 	/** Spawns the positive cursor effect */
 	UFUNCTION(BlueprintImplementableEvent, Category="Cursor", meta = (DisplayName="Cursor Feedback"))
 	void BP_CursorFeedback(FVector Location, bool bPositive);
-
-	/** Resets the interaction flag */
-	void ResetInteraction();
 };
@@ -6,11 +6,17 @@
 #include "GameFramework/CharacterMovementComponent.h"
 #include "Kismet/KismetMathLibrary.h"
 #include "Components/SphereComponent.h"
+#include "Engine/CollisionProfile.h"
 #include "Navigation/PathFollowingComponent.h"
+#include "StrategyUnitRegistry.h"
+#include "StrategyMoveOrder.h"
+#include "Managers/CrowdAvoidanceMovementComponent.h"
 
-AStrategyUnit::AStrategyUnit()
+AStrategyUnit::AStrategyUnit(const FObjectInitializer& ObjectInitializer)
+	: Super(ObjectInitializer.SetDefaultSubobjectClass<UCrowdAvoidanceMovementComponent>(ACharacter::CharacterMovementComponentName))
 {
-	PrimaryActorTick.bCanEverTick = true;
+	// units don't tick. Selection, orders and interactions are driven by the player controller and the unit registry
+	PrimaryActorTick.bCanEverTick = false;
 
 	// ensure this unit has a valid AI controller to handle move requests
 	AutoPossessAI = EAutoPossessAI::PlacedInWorldOrSpawned;
@@ -19,8 +25,11 @@ AStrategyUnit::AStrategyUnit()
 	InteractionRange = CreateDefaultSubobject<USphereComponent>(TEXT("Interaction Range"));
 	InteractionRange->SetupAttachment(RootComponent);
 
+	// the sphere only defines the interaction range. Range checks are queried from the unit registry,
+	// so it doesn't need to generate overlaps while units move in a crowd
 	InteractionRange->SetSphereRadius(100.0f);
-	InteractionRange->SetCollisionProfileName(FName("OverlapAllDynamic"));
+	InteractionRange->SetCollisionProfileName(UCollisionProfile::NoCollision_ProfileName);
+	InteractionRange->SetGenerateOverlapEvents(false);
 
 	// configure movement
 	GetCharacterMovement()->GravityScale = 1.5f;
@@ -39,6 +48,28 @@ AStrategyUnit::AStrategyUnit()
 	GetCharacterMovement()->SetFixedBrakingDistance(true);
 }
 
+void AStrategyUnit::BeginPlay()
+{
+	Super::BeginPlay();
+
+	// register with the unit registry so selection queries can find us
+	if (UStrategyUnitRegistry* Registry = GetWorld()->GetSubsystem<UStrategyUnitRegistry>())
+	{
+		Registry->AddUnit(this);
+	}
+}
+
+void AStrategyUnit::EndPlay(EEndPlayReason::Type EndPlayReason)
+{
+	Super::EndPlay(EndPlayReason);
+
+	// unregister from the unit registry
+	if (UStrategyUnitRegistry* Registry = GetWorld()->GetSubsystem<UStrategyUnitRegistry>())
+	{
+		Registry->RemoveUnit(this);
+	}
+}
+
 void AStrategyUnit::NotifyControllerChanged()
 {
 	// validate and save a copy of the AI controller reference
@@ -90,6 +121,11 @@ void AStrategyUnit::Interact(AStrategyUnit* Interactor)
 	
 }
 
+float AStrategyUnit::GetInteractionRange() const
+{
+	return InteractionRange->GetScaledSphereRadius();
+}
+
 bool AStrategyUnit::MoveToLocation(const FVector& Location, float AcceptanceRadius)
 {
 	// ensure we have a valid AI Controller
@@ -123,13 +159,15 @@ bool AStrategyUnit::MoveToLocation(const FVector& Location, float AcceptanceRadi
 			// already at goal. Return true and call the move completed delegate
 			case EPathFollowingRequestResult::AlreadyAtGoal:
 
-				OnMoveCompleted.Broadcast(this);
+				MoveRequestID = FAIRequestID::InvalidRequest;
+				MoveCompleted();
 				return true;
 				break;
 
-			// move successfully scheduled. Return true
+			// move successfully scheduled. Save the request so we know when it finishes. Return true
 			case EPathFollowingRequestResult::RequestSuccessful:
 
+				MoveRequestID = ResultData.MoveId;
 				return true;
 				break;
 		}
@@ -139,8 +177,61 @@ bool AStrategyUnit::MoveToLocation(const FVector& Location, float AcceptanceRadi
 	return false;
 }
 
+bool AStrategyUnit::FollowPath(FNavPathSharedPtr Path, float AcceptanceRadius)
+{
+	// ensure we have a valid AI Controller and path
+	if (AIController && Path.IsValid() && Path->IsValid())
+	{
+		// set up the AI Move Request to the end of the path
+		FAIMoveRequest MoveReq;
+
+		MoveReq.SetGoalLocation(Path->GetEndLocation());
+		MoveReq.SetAcceptanceRadius(AcceptanceRadius);
+		MoveReq.SetAllowPartialPath(true);
+		MoveReq.SetUsePathfinding(true);
+		MoveReq.SetCanStrafe(false);
+
+		// skip pathfinding and follow the provided path. Save the request so we know when it finishes
+		MoveRequestID = AIController->RequestMove(MoveReq, Path);
+		return MoveRequestID.IsValid();
+	}
+
+	// the move could not be started
+	return false;
+}
+
+void AStrategyUnit::AssignMoveOrder(const TSharedRef<FStrategyMoveOrder>& Order, int32 Slot)
+{
+	MoveOrder = Order;
+	MoveOrderID = Order->GetOrderID();
+	MoveOrderSlot = Slot;
+
+	// the previous move no longer counts towards an order
+	MoveRequestID = FAIRequestID::InvalidRequest;
+}
+
 void AStrategyUnit::OnMoveFinished(FAIRequestID RequestID, const FPathFollowingResult& Result)
+{
+	// moves issued through the AI controller directly, aborted moves and moves replaced by a newer request
+	// still call the delegate, but don't count towards the move order
+	if (!MoveRequestID.IsValid() || RequestID != MoveRequestID || Result.Code == EPathFollowingResult::Aborted)
+	{
+		OnMoveCompleted.Broadcast(this);
+		return;
+	}
+
+	MoveRequestID = FAIRequestID::InvalidRequest;
+	MoveCompleted();
+}
+
+void AStrategyUnit::MoveCompleted()
 {
 	// call the delegate
 	OnMoveCompleted.Broadcast(this);
+
+	// report the arrival to our move order
+	if (TSharedPtr<FStrategyMoveOrder> Order = MoveOrder.Pin())
+	{
+		Order->MarkCompleted(MoveOrderSlot);
+	}
 }
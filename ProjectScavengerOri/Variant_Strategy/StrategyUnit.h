@@ -8,6 +8,7 @@
 #include "StrategyUnit.generated.h"
 
 class USphereComponent;
+class FStrategyMoveOrder;
 
 /** Delegate to report that this unit has finished moving */
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnUnitMoveCompletedDelegate, AStrategyUnit*, Unit);
@@ -23,7 +24,7 @@ class AStrategyUnit : public ACharacter
 
 private:
 
-	/** Interaction range sphere */
+	/** Interaction range sphere. Only defines the range, it has no collision */
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Components", meta = (AllowPrivateAccess = "true"))
 	USphereComponent* InteractionRange;
 
@@ -32,13 +33,31 @@ protected:
 	/** Cast reference to the AI Controlling this unit */
 	TObjectPtr<AAIController> AIController;
 
+	/** Last move order given to this unit */
+	TWeakPtr<FStrategyMoveOrder> MoveOrder;
+
+	/** ID of the last move order given to this unit, 0 if none */
+	uint32 MoveOrderID = 0;
+
+	/** Slot of this unit in its move order */
+	int32 MoveOrderSlot = INDEX_NONE;
+
+	/** AI move request started for the current move order. Other requests finishing don't complete the order */
+	FAIRequestID MoveRequestID;
+
 public:
 
 	/** Constructor */
-	AStrategyUnit();
+	AStrategyUnit(const FObjectInitializer& ObjectInitializer);
 
 protected:
 
+	/** Gameplay initialization */
+	virtual void BeginPlay() override;
+
+	/** Gameplay cleanup */
+	virtual void EndPlay(EEndPlayReason::Type EndPlayReason) override;
+
 	virtual void NotifyControllerChanged() override;
 
 public:
@@ -55,14 +74,29 @@ public:
 	/** Notifies this unit that it's been interacted with by another actor */
 	void Interact(AStrategyUnit* Interactor);
 
+	/** Returns the radius of this unit's interaction range */
+	float GetInteractionRange() const;
+
 	/** Attempts to move this unit to its */
 	bool MoveToLocation(const FVector& Location, float AcceptanceRadius);
 
+	/** Attempts to move this unit along an already computed path */
+	bool FollowPath(FNavPathSharedPtr Path, float AcceptanceRadius);
+
+	/** Assigns the move order this unit reports its arrival to */
+	void AssignMoveOrder(const TSharedRef<FStrategyMoveOrder>& Order, int32 Slot);
+
+	/** Returns the ID of the last move order given to this unit, 0 if none */
+	uint32 GetMoveOrderID() const { return MoveOrderID; }
+
 protected:
 
 	/** called by the AI controller when this unit has finished moving */
 	void OnMoveFinished(FAIRequestID RequestID, const FPathFollowingResult& Result);
 
+	/** Reports the end of the current move to listeners and the move order */
+	void MoveCompleted();
+
 protected:
 
 	/** Blueprint handler for strategy game selection */
@@ -79,5 +113,6 @@ protected:
 
 public:
 
+	/** Called every time a move of this unit finishes, including aborted moves and moves issued through the AI controller directly */
 	FOnUnitMoveCompletedDelegate OnMoveCompleted;
 };
@@ -0,0 +1,293 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+
+#include "StrategyUnitRegistry.h"
+#include "StrategyUnit.h"
+#include "GameFramework/PlayerController.h"
+
+void UStrategyUnitRegistry::AddUnit(AStrategyUnit* Unit)
+{
+	if (!IsValid(Unit))
+	{
+		return;
+	}
+
+	Units.AddUnique(Unit);
+	bDirty = true;
+	ProjectedFrame = 0;
+}
+
+void UStrategyUnitRegistry::RemoveUnit(AStrategyUnit* Unit)
+{
+	// remove the unit along with any stale entries
+	Units.RemoveAllSwap([Unit](const TWeakObjectPtr<AStrategyUnit>& Registered)
+	{
+		return !Registered.IsValid() || Registered.Get() == Unit;
+	});
+
+	bDirty = true;
+	ProjectedFrame = 0;
+}
+
+void UStrategyUnitRegistry::QueryRadius(const FVector& Center, float Radius, TArray<AStrategyUnit*>& OutUnits)
+{
+	RebuildIfNeeded();
+
+	const FVector2D Center2D(Center);
+	const double RadiusSq = FMath::Square(Radius);
+
+	ForEachUnitInBox(Center2D - FVector2D(Radius), Center2D + FVector2D(Radius), [&](AStrategyUnit* Unit)
+	{
+		// test the current location, the unit may have moved since the rebuild
+		if (FVector2D::DistSquared(FVector2D(Unit->GetActorLocation()), Center2D) <= RadiusSq)
+		{
+			OutUnits.Add(Unit);
+		}
+	});
+}
+
+void UStrategyUnitRegistry::QueryInteractionRange(const FVector& Center, float Radius, TArray<AStrategyUnit*>& OutUnits)
+{
+	RebuildIfNeeded();
+
+	const FVector2D Center2D(Center);
+	const float QueryExtent = Radius + MaxInteractionRange;
+
+	ForEachUnitInBox(Center2D - FVector2D(QueryExtent), Center2D + FVector2D(QueryExtent), [&](AStrategyUnit* Unit)
+	{
+		// test against the unit's own range, the same as an overlap against its interaction sphere
+		if (FVector2D::DistSquared(FVector2D(Unit->GetActorLocation()), Center2D) <= FMath::Square(Radius + Unit->GetInteractionRange()))
+		{
+			OutUnits.Add(Unit);
+		}
+	});
+}
+
+AStrategyUnit* UStrategyUnitRegistry::FindNearestUnit(const FVector& Center, float Radius)
+{
+	RebuildIfNeeded();
+
+	const FVector2D Center2D(Center);
+
+	AStrategyUnit* Nearest = nullptr;
+	double NearestDistSq = FMath::Square(Radius);
+
+	ForEachUnitInBox(Center2D - FVector2D(Radius), Center2D + FVector2D(Radius), [&](AStrategyUnit* Unit)
+	{
+		const double DistSq = FVector2D::DistSquared(FVector2D(Unit->GetActorLocation()), Center2D);
+
+		if (DistSq <= NearestDistSq)
+		{
+			Nearest = Unit;
+			NearestDistSq = DistSq;
+		}
+	});
+
+	return Nearest;
+}
+
+void UStrategyUnitRegistry::QueryScreenRect(const APlayerController* PC, const FVector2D& RectStart, const FVector2D& RectEnd, TArray<AStrategyUnit*>& OutUnits)
+{
+	if (!PC)
+	{
+		return;
+	}
+
+	UpdateProjectedUnits(PC);
+
+	// the rectangle may have been dragged in any direction
+	const FVector2D RectMin(FMath::Min(RectStart.X, RectEnd.X), FMath::Min(RectStart.Y, RectEnd.Y));
+	const FVector2D RectMax(FMath::Max(RectStart.X, RectEnd.X), FMath::Max(RectStart.Y, RectEnd.Y));
+
+	for (const FStrategyProjectedUnit& Projected : ProjectedUnits)
+	{
+		// test the projected bounds against the closest point of the rectangle
+		const FVector2D ClosestPoint(FMath::Clamp(Projected.ScreenLocation.X, RectMin.X, RectMax.X), FMath::Clamp(Projected.ScreenLocation.Y, RectMin.Y, RectMax.Y));
+
+		if (FVector2D::DistSquared(ClosestPoint, Projected.ScreenLocation) <= FMath::Square(Projected.ScreenRadius))
+		{
+			if (AStrategyUnit* Unit = Projected.Unit.Get())
+			{
+				OutUnits.Add(Unit);
+			}
+		}
+	}
+}
+
+void UStrategyUnitRegistry::QueryOnScreen(const APlayerController* PC, TArray<AStrategyUnit*>& OutUnits)
+{
+	if (!PC)
+	{
+		return;
+	}
+
+	UpdateProjectedUnits(PC);
+
+	for (const FStrategyProjectedUnit& Projected : ProjectedUnits)
+	{
+		// skip the units that are only partially on screen
+		if (!Projected.bLocationOnScreen)
+		{
+			continue;
+		}
+
+		if (AStrategyUnit* Unit = Projected.Unit.Get())
+		{
+			OutUnits.Add(Unit);
+		}
+	}
+}
+
+void UStrategyUnitRegistry::Deinitialize()
+{
+	Units.Empty();
+	Grid.Reset();
+	ProjectedUnits.Empty();
+
+	Super::Deinitialize();
+}
+
+void UStrategyUnitRegistry::RebuildIfNeeded()
+{
+	if (!bDirty && BuiltFrame == GFrameCounter)
+	{
+		return;
+	}
+
+	BuiltFrame = GFrameCounter;
+	bDirty = false;
+
+	// drop units that were destroyed without unregistering
+	Units.RemoveAllSwap([](const TWeakObjectPtr<AStrategyUnit>& Registered) { return !Registered.IsValid(); });
+
+	MinUnitZ = TNumericLimits<double>::Max();
+	MaxUnitZ = TNumericLimits<double>::Lowest();
+	MaxInteractionRange = 0.0f;
+
+	Grid.Build(CellSize, Units.Num(), [this](int32 Index, FVector2D& OutLocation)
+	{
+		const FVector Location = Units[Index]->GetActorLocation();
+
+		MinUnitZ = FMath::Min(MinUnitZ, Location.Z);
+		MaxUnitZ = FMath::Max(MaxUnitZ, Location.Z);
+		MaxInteractionRange = FMath::Max(MaxInteractionRange, Units[Index]->GetInteractionRange());
+
+		OutLocation = FVector2D(Location);
+		return true;
+	});
+}
+
+void UStrategyUnitRegistry::UpdateProjectedUnits(const APlayerController* PC)
+{
+	RebuildIfNeeded();
+
+	if (ProjectedFrame == GFrameCounter && ProjectedController.Get() == PC)
+	{
+		return;
+	}
+
+	ProjectedFrame = GFrameCounter;
+	ProjectedController = PC;
+	ProjectedUnits.Reset();
+
+	if (Grid.IsEmpty())
+	{
+		return;
+	}
+
+	int32 ViewportX, ViewportY;
+	PC->GetViewportSize(ViewportX, ViewportY);
+
+	// deproject the viewport corners and clip the view rays between the lowest and highest unit.
+	// The XY bounds of those points contain every unit location that can project on screen
+	const FVector2D Corners[] = { FVector2D::ZeroVector, FVector2D(ViewportX, 0.0f), FVector2D(ViewportX, ViewportY), FVector2D(0.0f, ViewportY) };
+	const double PlaneHeights[] = { MinUnitZ, MaxUnitZ };
+
+	FBox2D WorldBounds(ForceInit);
+	bool bBounded = true;
+
+	for (const FVector2D& Corner : Corners)
+	{
+		FVector RayOrigin, RayDirection;
+
+		// a ray that doesn't point down at the units can't be bounded, so fall back to projecting every unit
+		if (!PC->DeprojectScreenPositionToWorld(Corner.X, Corner.Y, RayOrigin, RayDirection) || RayDirection.Z > -UE_KINDA_SMALL_NUMBER)
+		{
+			bBounded = false;
+			break;
+		}
+
+		for (const double PlaneZ : PlaneHeights)
+		{
+			WorldBounds += FVector2D(RayOrigin + RayDirection * FMath::Max((PlaneZ - RayOrigin.Z) / RayDirection.Z, 0.0));
+		}
+	}
+
+	// offsetting a location along the view's right axis projects to a screen distance of the same world size
+	FVector ViewLocation;
+	FRotator ViewRotation;
+	PC->GetPlayerViewPoint(ViewLocation, ViewRotation);
+
+	const FVector ViewRight = FRotationMatrix(ViewRotation).GetUnitAxis(EAxis::Y);
+
+	// project each candidate and keep the ones whose bounds overlap the viewport
+	auto ProjectUnit = [&](AStrategyUnit* Unit)
+	{
+		const FVector Location = Unit->GetActorLocation();
+		FVector2D ScreenLocation;
+
+		if (!PC->ProjectWorldLocationToScreen(Location, ScreenLocation, true))
+		{
+			return;
+		}
+
+		// project the sphere around the collision cylinder, so partially boxed units are found like with the actor bounds
+		float CollisionRadius, CollisionHalfHeight;
+		Unit->GetSimpleCollisionCylinder(CollisionRadius, CollisionHalfHeight);
+
+		FVector2D EdgeLocation;
+		double ScreenRadius = 0.0;
+
+		if (PC->ProjectWorldLocationToScreen(Location + ViewRight * FMath::Sqrt(FMath::Square(CollisionRadius) + FMath::Square(CollisionHalfHeight)), EdgeLocation, true))
+		{
+			ScreenRadius = FVector2D::Distance(ScreenLocation, EdgeLocation);
+		}
+
+		if (ScreenLocation.X >= -ScreenRadius && ScreenLocation.X <= ViewportX + ScreenRadius
+			&& ScreenLocation.Y >= -ScreenRadius && ScreenLocation.Y <= ViewportY + ScreenRadius)
+		{
+			const bool bLocationOnScreen = ScreenLocation.X >= 0.0f && ScreenLocation.X <= ViewportX
+				&& ScreenLocation.Y >= 0.0f && ScreenLocation.Y <= ViewportY;
+
+			ProjectedUnits.Add({ Unit, ScreenLocation, ScreenRadius, bLocationOnScreen });
+		}
+	};
+
+	if (bBounded)
+	{
+		// pad by a cell so units that moved since the rebuild are still found
+		ForEachUnitInBox(WorldBounds.Min - FVector2D(CellSize), WorldBounds.Max + FVector2D(CellSize), ProjectUnit);
+
+	} else {
+
+		for (const TWeakObjectPtr<AStrategyUnit>& Unit : Units)
+		{
+			if (Unit.IsValid())
+			{
+				ProjectUnit(Unit.Get());
+			}
+		}
+	}
+}
+
+template<typename VisitorType>
+void UStrategyUnitRegistry::ForEachUnitInBox(const FVector2D& BoxMin, const FVector2D& BoxMax, VisitorType&& Visitor)
+{
+	Grid.ForEachInBox(BoxMin, BoxMax, [&](int32 Index)
+	{
+		if (AStrategyUnit* Unit = Units[Index].Get())
+		{
+			Visitor(Unit);
+		}
+	});
+}
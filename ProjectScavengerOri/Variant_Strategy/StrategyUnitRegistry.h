@@ -0,0 +1,114 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Managers/UniformGrid.h"
+#include "StrategyUnitRegistry.generated.h"
+
+class AStrategyUnit;
+class APlayerController;
+
+/** Screen location of an on-screen unit, cached for the frame it was projected on */
+struct FStrategyProjectedUnit
+{
+	/** Projected unit */
+	TWeakObjectPtr<AStrategyUnit> Unit;
+
+	/** Viewport relative screen location */
+	FVector2D ScreenLocation;
+
+	/** Screen space radius of the unit's collision bounds */
+	double ScreenRadius = 0.0;
+
+	/** True if the unit's location is inside the viewport, not just part of its bounds */
+	bool bLocationOnScreen = false;
+};
+
+/**
+ *  Registry of the strategy units in the world
+ *  Units are bucketed into a uniform 2D grid on the XY plane, so radius and screen rectangle queries
+ *  only visit the units in the cells they overlap instead of every actor in the level.
+ *  Units move every frame, so the grid is rebuilt on the first query of each frame instead of on every move.
+ *  Screen queries project the on-screen units in bulk once per frame, and further queries that frame reuse the projection
+ */
+UCLASS(Config = Game)
+class UStrategyUnitRegistry : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+protected:
+
+	/** Size of a grid cell. Should be close to the typical selection radius */
+	UPROPERTY(Config)
+	float CellSize = 500.0f;
+
+	/** Registered units */
+	TArray<TWeakObjectPtr<AStrategyUnit>> Units;
+
+	/** Grid of the unit indices, as of the last rebuild */
+	FUniformGrid2D Grid;
+
+	/** Largest unit interaction range as of the last rebuild, used to pad interaction range queries */
+	float MaxInteractionRange = 0.0f;
+
+	/** Lowest and highest unit Z as of the last rebuild, used to bound screen queries */
+	double MinUnitZ = 0.0;
+	double MaxUnitZ = 0.0;
+
+	/** Units on screen as of the last projection */
+	TArray<FStrategyProjectedUnit> ProjectedUnits;
+
+	/** Player the units were last projected for */
+	TWeakObjectPtr<const APlayerController> ProjectedController;
+
+	/** Frame the units were last projected on */
+	uint64 ProjectedFrame = 0;
+
+	/** Frame the grid was last rebuilt on */
+	uint64 BuiltFrame = 0;
+
+	/** True if units were added or removed since the last rebuild */
+	bool bDirty = true;
+
+public:
+
+	/** Adds a unit to the registry */
+	void AddUnit(AStrategyUnit* Unit);
+
+	/** Removes a unit from the registry */
+	void RemoveUnit(AStrategyUnit* Unit);
+
+	/** Appends the units within Radius of Center on the XY plane to OutUnits */
+	void QueryRadius(const FVector& Center, float Radius, TArray<AStrategyUnit*>& OutUnits);
+
+	/** Appends the units whose interaction range overlaps the circle of Radius around Center on the XY plane to OutUnits */
+	void QueryInteractionRange(const FVector& Center, float Radius, TArray<AStrategyUnit*>& OutUnits);
+
+	/** Returns the unit closest to Center on the XY plane within Radius, or nullptr if there isn't one */
+	AStrategyUnit* FindNearestUnit(const FVector& Center, float Radius);
+
+	/** Appends the units whose projected bounds overlap the given screen rectangle of the player's view to OutUnits.
+	 *  The bounds are the sphere around the unit's collision cylinder, so a box only needs to touch a unit to select it.
+	 *  Uses this frame's projection of the on-screen units, so repeated queries only test cached screen locations */
+	void QueryScreenRect(const APlayerController* PC, const FVector2D& RectStart, const FVector2D& RectEnd, TArray<AStrategyUnit*>& OutUnits);
+
+	/** Appends the units whose location projects inside the player's viewport to OutUnits */
+	void QueryOnScreen(const APlayerController* PC, TArray<AStrategyUnit*>& OutUnits);
+
+	/** Subsystem cleanup */
+	virtual void Deinitialize() override;
+
+protected:
+
+	/** Rebuilds the grid from the current unit locations if it hasn't been rebuilt this frame */
+	void RebuildIfNeeded();
+
+	/** Projects the units on the player's screen if they haven't been projected for this player this frame */
+	void UpdateProjectedUnits(const APlayerController* PC);
+
+	/** Calls the visitor for every unit registered in the cells overlapping the XY box */
+	template<typename VisitorType>
+	void ForEachUnitInBox(const FVector2D& BoxMin, const FVector2D& BoxMax, VisitorType&& Visitor);
+};
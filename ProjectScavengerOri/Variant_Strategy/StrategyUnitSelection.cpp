@@ -0,0 +1,82 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+
+#include "StrategyUnitSelection.h"
+#include "StrategyUnit.h"
+
+bool FStrategyUnitSelection::Add(AStrategyUnit* Unit)
+{
+	if (!IsValid(Unit))
+	{
+		return false;
+	}
+
+	const FObjectKey Key(Unit);
+
+	if (Indices.Contains(Key))
+	{
+		return false;
+	}
+
+	Indices.Add(Key, Units.Num());
+	Units.Add(Unit);
+	Keys.Add(Key);
+
+	return true;
+}
+
+bool FStrategyUnitSelection::Remove(const AStrategyUnit* Unit)
+{
+	const int32* Index = Indices.Find(FObjectKey(Unit));
+
+	if (!Index)
+	{
+		return false;
+	}
+
+	RemoveAtSwap(*Index);
+
+	return true;
+}
+
+void FStrategyUnitSelection::Reset()
+{
+	Units.Reset();
+	Keys.Reset();
+	Indices.Reset();
+}
+
+int32 FStrategyUnitSelection::RemoveInvalid()
+{
+	int32 Removed = 0;
+
+	// walk backwards so the swapped in units have already been checked
+	for (int32 Index = Units.Num() - 1; Index >= 0; --Index)
+	{
+		if (!Units[Index].IsValid())
+		{
+			RemoveAtSwap(Index);
+			++Removed;
+		}
+	}
+
+	return Removed;
+}
+
+void FStrategyUnitSelection::RemoveAtSwap(int32 Index)
+{
+	Indices.Remove(Keys[Index]);
+
+	// move the last unit into the freed slot
+	const int32 LastIndex = Units.Num() - 1;
+
+	if (Index != LastIndex)
+	{
+		Units[Index] = Units[LastIndex];
+		Keys[Index] = Keys[LastIndex];
+		Indices.FindChecked(Keys[Index]) = Index;
+	}
+
+	Units.RemoveAt(LastIndex, EAllowShrinking::No);
+	Keys.RemoveAt(LastIndex, EAllowShrinking::No);
+}
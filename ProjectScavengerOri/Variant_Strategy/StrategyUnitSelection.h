@@ -0,0 +1,95 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/ObjectKey.h"
+
+class AStrategyUnit;
+
+/**
+ *  Set of selected strategy units
+ *  Units are stored densely for cheap iteration, with a lookup from each unit to its dense index,
+ *  so membership tests, adds and removes are constant time regardless of the selection size.
+ *  Units are held through weak pointers, so destroyed units are skipped instead of dereferenced
+ */
+class FStrategyUnitSelection
+{
+public:
+
+	/** Iterates the units that are still valid */
+	class FIterator
+	{
+	public:
+
+		FIterator(const TArray<TWeakObjectPtr<AStrategyUnit>>& InUnits, int32 InIndex)
+			: Units(InUnits)
+			, Index(InIndex)
+		{
+			SkipInvalid();
+		}
+
+		AStrategyUnit* operator*() const { return Units[Index].Get(); }
+
+		FIterator& operator++()
+		{
+			++Index;
+			SkipInvalid();
+			return *this;
+		}
+
+		bool operator!=(const FIterator& Other) const { return Index != Other.Index; }
+
+	private:
+
+		/** Advances past destroyed units */
+		void SkipInvalid()
+		{
+			while (Index < Units.Num() && !Units[Index].IsValid())
+			{
+				++Index;
+			}
+		}
+
+		const TArray<TWeakObjectPtr<AStrategyUnit>>& Units;
+		int32 Index;
+	};
+
+	/** Adds a unit. Returns true if it wasn't already in the set */
+	bool Add(AStrategyUnit* Unit);
+
+	/** Removes a unit. Returns true if it was in the set */
+	bool Remove(const AStrategyUnit* Unit);
+
+	/** Returns true if the unit is in the set */
+	bool Contains(const AStrategyUnit* Unit) const { return Indices.Contains(FObjectKey(Unit)); }
+
+	/** Drops every unit */
+	void Reset();
+
+	/** Drops destroyed units. Returns the number of units removed */
+	int32 RemoveInvalid();
+
+	/** Returns the number of units in the set, including any destroyed since the last RemoveInvalid */
+	int32 Num() const { return Units.Num(); }
+
+	/** Returns true if the set is empty */
+	bool IsEmpty() const { return Units.IsEmpty(); }
+
+	FIterator begin() const { return FIterator(Units, 0); }
+	FIterator end() const { return FIterator(Units, Units.Num()); }
+
+private:
+
+	/** Removes the unit at the given dense index, moving the last unit into its place */
+	void RemoveAtSwap(int32 Index);
+
+	/** Selected units, densely packed */
+	TArray<TWeakObjectPtr<AStrategyUnit>> Units;
+
+	/** Key of each selected unit, parallel to Units. Saved so destroyed units can still be found in Indices */
+	TArray<FObjectKey> Keys;
+
+	/** Dense index of each selected unit */
+	TMap<FObjectKey, int32> Indices;
+};
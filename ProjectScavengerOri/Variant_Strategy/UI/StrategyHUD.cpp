@@ -28,6 +28,15 @@ void AStrategyHUD::DragSelectUpdate(FVector2D Start, FVector2D WidthAndHeight, F
 
 }
 
+void AStrategyHUD::SetSelectedUnitsCount(int32 Count)
+{
+	// the widget may not exist yet if the selection changes before BeginPlay
+	if (UIWidget)
+	{
+		UIWidget->SetSelectedUnitsCount(Count);
+	}
+}
+
 void AStrategyHUD::DrawHUD()
 {
 	// draw all debug information, etc.
@@ -39,21 +48,12 @@ void AStrategyHUD::DrawHUD()
 		// draw the selection box
 		if (bDrawBox)
 		{
+			// the units in the box are selected by the player controller while dragging
 			DrawRect(SelectionBoxColor, BoxStart.X, BoxStart.Y, BoxSize.X, BoxSize.Y);
-
-			// get all the units in the selection box
-			TArray<AStrategyUnit*> BoxedUnits;
-			GetActorsInSelectionRectangle(BoxStart, BoxCurrentPosition, BoxedUnits, true);
-
-			// update the unit selection on the player controller
-			PC->DragSelectUnits(BoxedUnits);
 		}
 
-		// get the currently selected units
-		TArray<AStrategyUnit*> SelectedUnits = PC->GetSelectedUnits();
-
-		// update the selection count on the UI widget
-		UIWidget->SetSelectedUnitsCount(SelectedUnits.Num());
+		// get the currently selected units. The UI count is pushed by the controller when the selection changes
+		const FStrategyUnitSelection& SelectedUnits = PC->GetSelectedUnits();
 
 		// process each selected unit
 		for (AStrategyUnit* CurrentUnit : SelectedUnits)
@@ -51,6 +51,9 @@ public:
 	/** Updates the drag selection box */
 	void DragSelectUpdate(FVector2D Start, FVector2D WidthAndHeight, FVector2D CurrentPosition, bool bDraw);
 
+	/** Updates the selected units count on the UI widget. Called when the selection changes */
+	void SetSelectedUnitsCount(int32 Count);
+
 protected:
 
 	/** Draws the HUD */
@@ -2,6 +2,38 @@
 
 
 #include "StrategyUI.h"
+#include "Blueprint/WidgetTree.h"
+#include "Components/InvalidationBox.h"
+#include "Engine/World.h"
+#include "TimerManager.h"
+
+void UStrategyUI::NativeOnInitialized()
+{
+	Super::NativeOnInitialized();
+
+	// the selection counter rarely changes, so let Slate reuse the cached tree between changes
+	if (bUseInvalidationBox && WidgetTree && WidgetTree->RootWidget && !WidgetTree->RootWidget->IsA<UInvalidationBox>())
+	{
+		UWidget* Content = WidgetTree->RootWidget;
+
+		UInvalidationBox* InvalidationBox = WidgetTree->ConstructWidget<UInvalidationBox>(UInvalidationBox::StaticClass(), TEXT("RootInvalidationBox"));
+		InvalidationBox->SetCanCache(true);
+
+		WidgetTree->RootWidget = InvalidationBox;
+		InvalidationBox->SetContent(Content);
+	}
+}
+
+void UStrategyUI::NativeDestruct()
+{
+	// stop any pending update
+	if (UWorld* World = GetWorld())
+	{
+		World->GetTimerManager().ClearTimer(UpdateTimer);
+	}
+
+	Super::NativeDestruct();
+}
 
 void UStrategyUI::SetSelectedUnitsCount(int32 Count)
 {
@@ -11,9 +43,25 @@ void UStrategyUI::SetSelectedUnitsCount(int32 Count)
 	// update the counter
 	SelectedUnitCount = Count;
 
-	// if the count changed, call the BP handler
+	// if the count changed, call the BP handler on the next frame.
+	// A selection change can set the count several times in a frame, so only the last value is shown
 	if (bChanged)
 	{
-		BP_UpdateUnitsCount();
+		if (UWorld* World = GetWorld())
+		{
+			FTimerManager& TimerManager = World->GetTimerManager();
+
+			if (!TimerManager.TimerExists(UpdateTimer))
+			{
+				UpdateTimer = TimerManager.SetTimerForNextTick(this, &UStrategyUI::FlushUnitsCount);
+			}
+		}
 	}
 }
+
+void UStrategyUI::FlushUnitsCount()
+{
+	UpdateTimer.Invalidate();
+
+	BP_UpdateUnitsCount();
+}
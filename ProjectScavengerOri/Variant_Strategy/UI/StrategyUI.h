@@ -9,6 +9,8 @@
 /**
  *  Simple UI widget for the strategy game
  *	Keeps track of the number of units currently selected
+ *	Count changes are coalesced and pushed to Blueprint once per frame,
+ *	and the widget tree is cached in an invalidation box so it's only repainted on change
  */
 UCLASS(abstract)
 class UStrategyUI : public UUserWidget
@@ -17,9 +19,27 @@ class UStrategyUI : public UUserWidget
 	
 protected:
 
+	/** If true, the widget tree is wrapped in an invalidation box on initialization */
+	UPROPERTY(EditDefaultsOnly, Category="Performance")
+	bool bUseInvalidationBox = true;
+
 	/** Number of units currently selected */
 	int32 SelectedUnitCount = 0;
 
+	/** Timer for the next Blueprint update */
+	FTimerHandle UpdateTimer;
+
+protected:
+
+	/** Wraps the widget tree in an invalidation box */
+	virtual void NativeOnInitialized() override;
+
+	/** Cleanup */
+	virtual void NativeDestruct() override;
+
+	/** Calls the Blueprint handler with the latest count */
+	void FlushUnitsCount();
+
 public:
 
 	/** Sets the number of units selected */
@@ -2,12 +2,26 @@
 
 
 #include "TwinStickAIController.h"
-#include "Components/StateTreeAIComponent.h"
+#include "TwinStickStateTreeAIComponent.h"
+#include "TwinStickGameMode.h"
+#include "TwinStickCharacter.h"
+#include "TwinStickNPC.h"
+#include "GameFramework/Character.h"
+#include "Engine/World.h"
+#include "TimerManager.h"
+
+namespace TwinStickAITags
+{
+	UE_DEFINE_GAMEPLAY_TAG_COMMENT(PlayerInRange, "TwinStick.AI.Event.PlayerInRange", "Sent when the nearest player comes within range of the NPC.");
+	UE_DEFINE_GAMEPLAY_TAG_COMMENT(PlayerOutOfRange, "TwinStick.AI.Event.PlayerOutOfRange", "Sent when the nearest player leaves the NPC's range.");
+	UE_DEFINE_GAMEPLAY_TAG_COMMENT(Hit, "TwinStick.AI.Event.Hit", "Sent when the NPC is hit by a projectile.");
+	UE_DEFINE_GAMEPLAY_TAG_COMMENT(Retarget, "TwinStick.AI.Event.Retarget", "Sent when the NPC should pick its target player again.");
+}
 
 ATwinStickAIController::ATwinStickAIController()
 {
 	// create the StateTree AI Component
-	StateTreeAI = CreateDefaultSubobject<UStateTreeAIComponent>(TEXT("StateTreeAI"));
+	StateTreeAI = CreateDefaultSubobject<UTwinStickStateTreeAIComponent>(TEXT("StateTreeAI"));
 	check(StateTreeAI);
 
 	// ensure we start the StateTree when we possess the pawn
@@ -16,4 +30,166 @@ ATwinStickAIController::ATwinStickAIController()
 	// ensure we're attached to the possessed character.
 	// this is necessary for EnvQueries to work correctly
 	bAttachToPawn = true;
-}
\ No newline at end of file
+}
+
+void ATwinStickAIController::BeginPlay()
+{
+	Super::BeginPlay();
+
+	// retarget when a player is possessed or dies instead of polling the registry
+	if (ATwinStickGameMode* GM = Cast<ATwinStickGameMode>(GetWorld()->GetAuthGameMode()))
+	{
+		GM->OnPlayersChanged.AddUObject(this, &ATwinStickAIController::RequestRetarget);
+	}
+}
+
+void ATwinStickAIController::OnPossess(APawn* InPawn)
+{
+	// NPCs spawned by the pool start asleep, so don't start the StateTree until they're acquired
+	const ATwinStickNPC* NPC = Cast<ATwinStickNPC>(InPawn);
+	const bool bInPool = NPC && NPC->IsInPool();
+	bStartAILogicOnPossess = !bInPool;
+
+	Super::OnPossess(InPawn);
+
+	bStartAILogicOnPossess = true;
+
+	// ResumeFromPool starts the StateTree and the distance checks on acquire
+	if (bInPool)
+	{
+		return;
+	}
+
+	// start checking the player distance. Use a random first delay so NPCs spawned together don't all update on the same frame
+	GetWorld()->GetTimerManager().SetTimer(UpdateTimer, this, &ATwinStickAIController::UpdateTickRate, UpdateInterval, true, FMath::FRandRange(0.0f, UpdateInterval));
+}
+
+void ATwinStickAIController::OnUnPossess()
+{
+	Super::OnUnPossess();
+
+	// stop checking the player distance
+	GetWorld()->GetTimerManager().ClearTimer(UpdateTimer);
+}
+
+void ATwinStickAIController::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	Super::EndPlay(EndPlayReason);
+
+	// clear the update timer
+	GetWorld()->GetTimerManager().ClearTimer(UpdateTimer);
+
+	// stop listening for player changes
+	if (ATwinStickGameMode* GM = Cast<ATwinStickGameMode>(GetWorld()->GetAuthGameMode()))
+	{
+		GM->OnPlayersChanged.RemoveAll(this);
+	}
+}
+
+void ATwinStickAIController::UpdateTickRate()
+{
+	APawn* ControlledPawn = GetPawn();
+
+	if (!ControlledPawn)
+	{
+		return;
+	}
+
+	// find the distance to the nearest player. Treat no players as far away
+	float Distance = FarDistance;
+
+	if (ATwinStickGameMode* GM = Cast<ATwinStickGameMode>(GetWorld()->GetAuthGameMode()))
+	{
+		if (ATwinStickCharacter* PlayerCharacter = GM->GetNearestPlayerCharacter(ControlledPawn->GetActorLocation()))
+		{
+			Distance = FVector::Dist(PlayerCharacter->GetActorLocation(), ControlledPawn->GetActorLocation());
+		}
+	}
+
+	// send range events only when the range state changes
+	if (!bPlayerInRange && Distance <= PlayerInRangeDistance)
+	{
+		bPlayerInRange = true;
+		StateTreeAI->SendStateTreeEvent(TwinStickAITags::PlayerInRange);
+
+	} else if (bPlayerInRange && Distance > PlayerInRangeDistance + PlayerRangeHysteresis) {
+
+		bPlayerInRange = false;
+		StateTreeAI->SendStateTreeEvent(TwinStickAITags::PlayerOutOfRange);
+	}
+
+	// start from the active state's interval, and slow down as the player gets farther away
+	const float StateInterval = StateTickInterval >= 0.0f ? StateTickInterval : DefaultTickInterval;
+	const float DistanceAlpha = FMath::Clamp(FMath::GetRangePct(NearDistance, FarDistance, Distance), 0.0f, 1.0f);
+
+	float Interval = FMath::Max(StateInterval, DistanceAlpha * FarTickInterval);
+
+	// never tick faster than the significance manager allows. The manager leaves the interval to us, see OnSignificanceChanged
+	if (const UAISignificanceManager* SignificanceManager = GetWorld()->GetSubsystem<UAISignificanceManager>())
+	{
+		if (const ACharacter* ControlledCharacter = Cast<ACharacter>(ControlledPawn))
+		{
+			Interval = FMath::Max(Interval, SignificanceManager->GetSettings(SignificanceManager->GetSignificance(ControlledCharacter)).BrainTickInterval);
+		}
+	}
+
+	StateTreeAI->SetComponentTickInterval(Interval);
+}
+
+void ATwinStickAIController::SetStateTickInterval(float Interval)
+{
+	// save the interval and apply it right away
+	StateTickInterval = FMath::Max(Interval, 0.0f);
+	UpdateTickRate();
+}
+
+void ATwinStickAIController::ClearStateTickInterval()
+{
+	// go back to the default interval
+	StateTickInterval = -1.0f;
+	UpdateTickRate();
+}
+
+void ATwinStickAIController::OnSignificanceChanged(EAISignificance NewSignificance)
+{
+	// this controller is the only owner of the StateTree tick interval
+	UpdateTickRate();
+}
+
+void ATwinStickAIController::NotifyHit()
+{
+	// let the StateTree react on its next tick
+	StateTreeAI->SendStateTreeEvent(TwinStickAITags::Hit);
+}
+
+void ATwinStickAIController::RequestRetarget()
+{
+	// pooled NPCs resolve their target when the StateTree restarts
+	if (StateTreeAI->IsRunning())
+	{
+		StateTreeAI->SendStateTreeEvent(TwinStickAITags::Retarget);
+	}
+}
+
+void ATwinStickAIController::SuspendForPool()
+{
+	// stop checking the player distance
+	GetWorld()->GetTimerManager().ClearTimer(UpdateTimer);
+
+	// stop any move in progress and the StateTree
+	StopMovement();
+	StateTreeAI->StopLogic(TEXT("Returned to pool"));
+
+	// forget the range state so the next activation starts fresh
+	bPlayerInRange = false;
+	StateTickInterval = -1.0f;
+}
+
+void ATwinStickAIController::ResumeFromPool()
+{
+	// restart the StateTree from its root state
+	StateTreeAI->RestartLogic();
+
+	// restart the distance checks with a random first delay, like on possess
+	GetWorld()->GetTimerManager().SetTimer(UpdateTimer, this, &ATwinStickAIController::UpdateTickRate, UpdateInterval, true, FMath::FRandRange(0.0f, UpdateInterval));
+}
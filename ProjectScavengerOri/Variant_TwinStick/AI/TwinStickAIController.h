@@ -4,25 +4,120 @@
 
 #include "CoreMinimal.h"
 #include "AIController.h"
+#include "NativeGameplayTags.h"
+#include "Managers/AISignificanceManager.h"
 #include "TwinStickAIController.generated.h"
 
-class UStateTreeAIComponent;
+class UTwinStickStateTreeAIComponent;
+
+/** StateTree events sent by the Twin Stick AI Controller. Use them for event driven transitions instead of per tick conditions */
+namespace TwinStickAITags
+{
+	UE_DECLARE_GAMEPLAY_TAG_EXTERN(PlayerInRange);
+	UE_DECLARE_GAMEPLAY_TAG_EXTERN(PlayerOutOfRange);
+	UE_DECLARE_GAMEPLAY_TAG_EXTERN(Hit);
+	UE_DECLARE_GAMEPLAY_TAG_EXTERN(Retarget);
+}
 
 /**
  *  A StateTree-Enabled AI Controller for a Twin Stick Shooter game
  *  Runs NPC logic through a StateTree
+ *  The StateTree tick interval is set per state, scaled up with distance from the nearest player,
+ *  and gameplay changes are pushed to the StateTree as events
  */
 UCLASS(abstract)
-class ATwinStickAIController : public AAIController
+class ATwinStickAIController : public AAIController, public IAISignificanceBrainTickOwner
 {
 	GENERATED_BODY()
 	
 	/** StateTree Component */
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category="Components", meta = (AllowPrivateAccess = "true"))
-	UStateTreeAIComponent* StateTreeAI;
+	UTwinStickStateTreeAIComponent* StateTreeAI;
+
+protected:
+
+	/** StateTree tick interval used when the active state doesn't set one. Zero ticks every frame */
+	UPROPERTY(EditAnywhere, Category="AI|Tick", meta = (ClampMin = 0, ClampMax = 2, Units = "s"))
+	float DefaultTickInterval = 0.0f;
+
+	/** The state tick interval is used unscaled while the nearest player is closer than this */
+	UPROPERTY(EditAnywhere, Category="AI|Tick", meta = (ClampMin = 0, Units = "cm"))
+	float NearDistance = 1000.0f;
+
+	/** The StateTree ticks no faster than Far Tick Interval once the nearest player is this far away */
+	UPROPERTY(EditAnywhere, Category="AI|Tick", meta = (ClampMin = 0, Units = "cm"))
+	float FarDistance = 4000.0f;
+
+	/** Minimum StateTree tick interval at Far Distance. Blended in from Near Distance */
+	UPROPERTY(EditAnywhere, Category="AI|Tick", meta = (ClampMin = 0, ClampMax = 2, Units = "s"))
+	float FarTickInterval = 0.5f;
+
+	/** Time between player distance checks */
+	UPROPERTY(EditAnywhere, Category="AI|Tick", meta = (ClampMin = 0.05, ClampMax = 2, Units = "s"))
+	float UpdateInterval = 0.25f;
+
+	/** Distance at which the PlayerInRange event is sent */
+	UPROPERTY(EditAnywhere, Category="AI|Events", meta = (ClampMin = 0, Units = "cm"))
+	float PlayerInRangeDistance = 800.0f;
+
+	/** Extra distance the player must move away before PlayerOutOfRange is sent, to avoid event spam at the edge */
+	UPROPERTY(EditAnywhere, Category="AI|Events", meta = (ClampMin = 0, Units = "cm"))
+	float PlayerRangeHysteresis = 100.0f;
+
+	/** Tick interval requested by the active state, or a negative value if none */
+	float StateTickInterval = -1.0f;
+
+	/** True if the nearest player was in range on the last check */
+	bool bPlayerInRange = false;
+
+	/** Distance check timer */
+	FTimerHandle UpdateTimer;
 
 public:
 
 	/** Constructor */
 	ATwinStickAIController();
+
+protected:
+
+	/** Gameplay initialization */
+	virtual void BeginPlay() override;
+
+	/** Starts the distance checks */
+	virtual void OnPossess(APawn* InPawn) override;
+
+	/** Stops the distance checks */
+	virtual void OnUnPossess() override;
+
+	/** Gameplay cleanup */
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+	/** Checks the distance to the nearest player, sends range events and updates the StateTree tick interval */
+	void UpdateTickRate();
+
+public:
+
+	/** Returns the tick interval requested by the active state, or a negative value if none is set */
+	float GetStateTickInterval() const { return StateTickInterval; }
+
+	/** Sets the tick interval requested by the active state */
+	void SetStateTickInterval(float Interval);
+
+	/** Clears the tick interval requested by the active state */
+	void ClearStateTickInterval();
+
+	/** Notifies the StateTree that the NPC has been hit */
+	void NotifyHit();
+
+	/** Asks the StateTree to pick its target player again. Called when the player registry changes */
+	void RequestRetarget();
+
+	/** Stops the StateTree and distance checks while the NPC waits in the actor pool */
+	void SuspendForPool();
+
+	/** Restarts the StateTree and distance checks when the NPC is reused from the actor pool */
+	void ResumeFromPool();
+
+	/** The significance manager leaves the StateTree tick interval to us, so fold in the new bucket's interval right away */
+	virtual void OnSignificanceChanged(EAISignificance NewSignificance) override;
 };
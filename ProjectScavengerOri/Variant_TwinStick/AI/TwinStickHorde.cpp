@@ -0,0 +1,417 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+
+#include "TwinStickHorde.h"
+#include "Components/InstancedStaticMeshComponent.h"
+#include "Components/CapsuleComponent.h"
+#include "Engine/World.h"
+#include "GameFramework/PlayerController.h"
+#include "Async/ParallelFor.h"
+#include "NavigationSystem.h"
+#include "NavigationData.h"
+#include "TwinStickNPC.h"
+#include "TwinStickCharacter.h"
+#include "TwinStickGameMode.h"
+#include "Managers/FlowFieldManager.h"
+#include "Managers/PoolSubsystem.h"
+
+ATwinStickHorde::ATwinStickHorde()
+{
+	PrimaryActorTick.bCanEverTick = true;
+
+	// create the instanced mesh that draws the entities
+	Instances = CreateDefaultSubobject<UInstancedStaticMeshComponent>(TEXT("Instances"));
+	RootComponent = Instances;
+
+	// entities never collide and never affect navigation
+	Instances->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+	Instances->SetCanEverAffectNavigation(false);
+}
+
+void ATwinStickHorde::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	// gather the players
+	TArray<ATwinStickCharacter*> Players;
+	TArray<FVector> PlayerLocations;
+
+	for (FConstPlayerControllerIterator It = GetWorld()->GetPlayerControllerIterator(); It; ++It)
+	{
+		if (ATwinStickCharacter* PlayerCharacter = It->IsValid() ? Cast<ATwinStickCharacter>((*It)->GetPawn()) : nullptr)
+		{
+			Players.Add(PlayerCharacter);
+			PlayerLocations.Add(PlayerCharacter->GetActorLocation());
+		}
+	}
+
+	// only simulate while there's someone to chase
+	if (Players.Num() > 0)
+	{
+		// gather the desired directions on the game thread, since the flow field isn't thread safe
+		GatherDesiredDirections(PlayerLocations);
+
+		// sort the entities into a grid so avoidance only looks at nearby entities
+		Grid.Build(AvoidanceRadius, Positions.Num(), [this](int32 Index, FVector2D& OutLocation)
+		{
+			OutLocation = FVector2D(Positions[Index]);
+			return true;
+		});
+
+		// process the entities in parallel chunks. Each chunk only writes to its own entities
+		const int32 NumChunks = FMath::DivideAndRoundUp(Positions.Num(), ChunkSize);
+
+		ParallelFor(NumChunks, [this, DeltaTime, &PlayerLocations](int32 ChunkIndex)
+		{
+			ProcessChunk(ChunkIndex, DeltaTime, PlayerLocations);
+		});
+
+		// the new positions become current
+		Swap(Positions, NextPositions);
+
+		// keep the entities on the navmesh
+		ProjectToNavigation();
+
+		// apply damage and spawn or despawn actors on the game thread
+		ApplyContactDamage(Players);
+		UpdatePromotions(PlayerLocations);
+	}
+
+	// update the visuals
+	UpdateInstances();
+}
+
+bool ATwinStickHorde::AddEntity(const FVector& Location)
+{
+	// is the horde full?
+	if (!CanAddEntities())
+	{
+		return false;
+	}
+
+	// add the entity to every array
+	Positions.Add(Location);
+	NextPositions.Add(Location);
+	NavPositions.Add(Location);
+	Velocities.Add(FVector::ZeroVector);
+	DesiredDirections.Add(FVector::ZeroVector);
+	ContactTimers.Add(0.0f);
+	ContactPlayers.Add(INDEX_NONE);
+	InstanceTransforms.Add(FTransform(Location));
+
+	return true;
+}
+
+bool ATwinStickHorde::CanAddEntities() const
+{
+	return Positions.Num() < MaxEntities;
+}
+
+void ATwinStickHorde::GatherDesiredDirections(const TArray<FVector>& PlayerLocations)
+{
+	UFlowFieldManager* FlowFieldManager = bUseFlowField ? GetWorld()->GetSubsystem<UFlowFieldManager>() : nullptr;
+
+	for (int32 Index = 0; Index < Positions.Num(); ++Index)
+	{
+		const FVector& Position = Positions[Index];
+
+		// try the flow field first
+		if (FlowFieldManager && FlowFieldManager->SampleDirection(Position, DesiredDirections[Index]))
+		{
+			continue;
+		}
+
+		// fall back to heading straight for the nearest player
+		FVector NearestPlayer = PlayerLocations[0];
+
+		for (const FVector& PlayerLocation : PlayerLocations)
+		{
+			if (FVector::DistSquared2D(Position, PlayerLocation) < FVector::DistSquared2D(Position, NearestPlayer))
+			{
+				NearestPlayer = PlayerLocation;
+			}
+		}
+
+		DesiredDirections[Index] = (NearestPlayer - Position).GetSafeNormal2D();
+	}
+}
+
+void ATwinStickHorde::ProcessChunk(int32 ChunkIndex, float DeltaTime, const TArray<FVector>& PlayerLocations)
+{
+	const int32 Start = ChunkIndex * ChunkSize;
+	const int32 End = FMath::Min(Start + ChunkSize, Positions.Num());
+	const float AvoidanceRadiusSq = FMath::Square(AvoidanceRadius);
+	const float ContactRadiusSq = FMath::Square(ContactRadius);
+
+	for (int32 Index = Start; Index < End; ++Index)
+	{
+		const FVector& Position = Positions[Index];
+
+		// push away from nearby entities in the surrounding cells
+		FVector Separation = FVector::ZeroVector;
+		int32 NumNeighbors = 0;
+
+		const FVector2D Extent(AvoidanceRadius);
+
+		Grid.ForEachInBox(FVector2D(Position) - Extent, FVector2D(Position) + Extent, [&](int32 Other)
+		{
+			if (Other == Index || NumNeighbors >= MaxAvoidanceNeighbors)
+			{
+				return;
+			}
+
+			// cells may hold entities outside the radius, so check the actual distance
+			FVector Offset = Position - Positions[Other];
+			Offset.Z = 0.0f;
+
+			const float DistSq = Offset.SizeSquared();
+
+			if (DistSq >= AvoidanceRadiusSq || DistSq < KINDA_SMALL_NUMBER)
+			{
+				return;
+			}
+
+			const float Dist = FMath::Sqrt(DistSq);
+			Separation += (Offset / Dist) * (1.0f - Dist / AvoidanceRadius);
+			++NumNeighbors;
+		});
+
+		// combine the desired direction with the avoidance push and move
+		const FVector Velocity = (DesiredDirections[Index] + Separation * AvoidanceStrength).GetClampedToMaxSize(1.0f) * MoveSpeed;
+		const FVector NewPosition = Position + Velocity * DeltaTime;
+
+		Velocities[Index] = Velocity;
+		NextPositions[Index] = NewPosition;
+
+		// check for player contact once the cooldown has expired
+		ContactTimers[Index] = FMath::Max(ContactTimers[Index] - DeltaTime, 0.0f);
+		ContactPlayers[Index] = INDEX_NONE;
+
+		if (ContactTimers[Index] <= 0.0f)
+		{
+			for (int32 PlayerIndex = 0; PlayerIndex < PlayerLocations.Num(); ++PlayerIndex)
+			{
+				if (FVector::DistSquared2D(NewPosition, PlayerLocations[PlayerIndex]) <= ContactRadiusSq)
+				{
+					ContactPlayers[Index] = PlayerIndex;
+					break;
+				}
+			}
+		}
+
+		// face the movement direction
+		const FQuat Rotation = Velocity.IsNearlyZero() ? InstanceTransforms[Index].GetRotation() : FRotator(0.0f, Velocity.Rotation().Yaw, 0.0f).Quaternion();
+		InstanceTransforms[Index] = FTransform(Rotation, NewPosition);
+	}
+}
+
+void ATwinStickHorde::ProjectToNavigation()
+{
+	const int32 NumEntities = Positions.Num();
+
+	if (NumEntities == 0)
+	{
+		return;
+	}
+
+	const UNavigationSystemV1* NavSys = FNavigationSystem::GetCurrent<UNavigationSystemV1>(GetWorld());
+	const ANavigationData* NavData = NavSys ? NavSys->GetDefaultNavDataInstance(FNavigationSystem::DontCreate) : nullptr;
+
+	if (!NavData)
+	{
+		return;
+	}
+
+	// project the next slice of entities in a single batch, wrapping around the entity list
+	const int32 NumProjections = FMath::Min(MaxProjectionsPerFrame, NumEntities);
+	ProjectionCursor %= NumEntities;
+
+	TArray<FNavigationProjectionWork> Workload;
+	Workload.Reserve(NumProjections);
+
+	for (int32 Slice = 0; Slice < NumProjections; ++Slice)
+	{
+		Workload.Emplace(Positions[(ProjectionCursor + Slice) % NumEntities]);
+	}
+
+	NavData->BatchProjectPoints(Workload, NavProjectionExtent, NavData->GetDefaultQueryFilter());
+
+	for (int32 Slice = 0; Slice < NumProjections; ++Slice)
+	{
+		const int32 Index = (ProjectionCursor + Slice) % NumEntities;
+
+		// snap to the navmesh, or go back to the last location on it if the entity drifted off
+		if (Workload[Slice].bResult)
+		{
+			Positions[Index] = Workload[Slice].OutLocation.Location;
+			NavPositions[Index] = Positions[Index];
+
+		} else {
+
+			Positions[Index] = NavPositions[Index];
+		}
+
+		InstanceTransforms[Index].SetLocation(Positions[Index]);
+	}
+
+	ProjectionCursor = (ProjectionCursor + NumProjections) % NumEntities;
+}
+
+void ATwinStickHorde::ApplyContactDamage(const TArray<ATwinStickCharacter*>& Players)
+{
+	for (int32 Index = 0; Index < ContactPlayers.Num(); ++Index)
+	{
+		if (ContactPlayers[Index] == INDEX_NONE)
+		{
+			continue;
+		}
+
+		// apply damage to the character in the direction the entity is moving, like a colliding NPC would
+		Players[ContactPlayers[Index]]->HandleDamage(ContactDamage, Velocities[Index].GetSafeNormal2D());
+
+		// reset the contact cooldown
+		ContactTimers[Index] = ContactCooldown;
+	}
+}
+
+void ATwinStickHorde::UpdatePromotions(const TArray<FVector>& PlayerLocations)
+{
+	auto IsNearPlayer = [&PlayerLocations](const FVector& Location, float Radius)
+	{
+		const float RadiusSq = FMath::Square(Radius);
+
+		return PlayerLocations.ContainsByPredicate([&Location, RadiusSq](const FVector& PlayerLocation)
+		{
+			return FVector::DistSquared2D(Location, PlayerLocation) <= RadiusSq;
+		});
+	};
+
+	UPoolSubsystem* PoolSubsystem = GetWorld()->GetSubsystem<UPoolSubsystem>();
+
+	if (!PoolSubsystem)
+	{
+		return;
+	}
+
+	int32 Budget = MaxPromotionsPerFrame;
+
+	// demote promoted NPCs that are far away from every player
+	for (int32 Index = PromotedNPCs.Num() - 1; Index >= 0 && Budget > 0; --Index)
+	{
+		ATwinStickNPC* NPC = PromotedNPCs[Index].Get();
+
+		// forget NPCs that have been destroyed or returned to the pool
+		if (!IsValid(NPC) || NPC->IsInPool())
+		{
+			PromotedNPCs.RemoveAtSwap(Index);
+			continue;
+		}
+
+		// leave NPCs that are dying or still close by alone
+		if (NPC->bHit || IsNearPlayer(NPC->GetActorLocation(), DemotionRadius) || !CanAddEntities())
+		{
+			continue;
+		}
+
+		// return the NPC to the pool so it can be promoted again later
+		AddEntity(NPC->GetNavAgentLocation());
+		PoolSubsystem->ReleaseToPool(NPC);
+
+		PromotedNPCs.RemoveAtSwap(Index);
+		--Budget;
+	}
+
+	// promote entities that are close to a player, while under the NPC cap
+	ATwinStickGameMode* GM = Cast<ATwinStickGameMode>(GetWorld()->GetAuthGameMode());
+
+	const UNavigationSystemV1* NavSys = FNavigationSystem::GetCurrent<UNavigationSystemV1>(GetWorld());
+
+	if (!NPCClass || !GM || !NavSys)
+	{
+		return;
+	}
+
+	// the NPC's capsule is placed on the navmesh. The default object is used to test for room, like spawning does
+	const ATwinStickNPC* NPCTemplate = NPCClass->GetDefaultObject<ATwinStickNPC>();
+	const float HalfHeight = NPCTemplate->GetCapsuleComponent()->GetScaledCapsuleHalfHeight();
+
+	// freshly spawned NPCs are also skipped if there's no room for them
+	FPoolSpawnInfo SpawnInfo;
+	SpawnInfo.CollisionHandlingMethodOverride = ESpawnActorCollisionHandlingMethod::AdjustIfPossibleButDontSpawnIfColliding;
+
+	for (int32 Index = Positions.Num() - 1; Index >= 0 && Budget > 0 && GM->CanSpawnNPCs(); --Index)
+	{
+		if (!IsNearPlayer(Positions[Index], PromotionRadius))
+		{
+			continue;
+		}
+
+		// only promote at a location on the navmesh, so the NPC can find paths from there
+		FNavLocation NavLocation;
+
+		if (!NavSys->ProjectPointToNavigation(Positions[Index], NavLocation, NavProjectionExtent))
+		{
+			continue;
+		}
+
+		// nudge the capsule out of blocking geometry and other NPCs. Try again on a later frame if there's no room
+		FVector SpawnLocation = NavLocation.Location + FVector(0.0f, 0.0f, HalfHeight);
+		const FRotator SpawnRotation = InstanceTransforms[Index].Rotator();
+
+		if (!GetWorld()->FindTeleportSpot(NPCTemplate, SpawnLocation, SpawnRotation))
+		{
+			continue;
+		}
+
+		// reuse a pooled NPC, or spawn one if the pool is empty
+		SpawnInfo.Transform = FTransform(SpawnRotation, SpawnLocation);
+
+		if (ATwinStickNPC* NPC = Cast<ATwinStickNPC>(PoolSubsystem->AcquireFromPool(NPCClass, SpawnInfo, FPoolSpawnOptions())))
+		{
+			PromotedNPCs.Add(NPC);
+			RemoveEntityAtSwap(Index);
+			--Budget;
+		}
+	}
+}
+
+void ATwinStickHorde::RemoveEntityAtSwap(int32 Index)
+{
+	Positions.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+	NextPositions.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+	NavPositions.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+	Velocities.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+	DesiredDirections.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+	ContactTimers.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+	ContactPlayers.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+	InstanceTransforms.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+}
+
+void ATwinStickHorde::UpdateInstances()
+{
+	const int32 NumEntities = InstanceTransforms.Num();
+	const int32 NumInstances = Instances->GetInstanceCount();
+
+	// entity N always maps to instance N, so only the tail ever needs adding or removing
+	if (NumInstances > NumEntities)
+	{
+		TArray<int32> InstancesToRemove;
+
+		for (int32 Index = NumEntities; Index < NumInstances; ++Index)
+		{
+			InstancesToRemove.Add(Index);
+		}
+
+		Instances->RemoveInstances(InstancesToRemove);
+
+	} else if (NumInstances < NumEntities) {
+
+		Instances->AddInstances(TArray<FTransform>(InstanceTransforms.GetData() + NumInstances, NumEntities - NumInstances), false, true);
+	}
+
+	// update all transforms in a single batch
+	if (NumEntities > 0)
+	{
+		Instances->BatchUpdateInstancesTransforms(0, InstanceTransforms, true, true, true);
+	}
+}
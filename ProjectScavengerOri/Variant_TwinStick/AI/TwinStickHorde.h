@@ -0,0 +1,171 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Actor.h"
+#include "Managers/UniformGrid.h"
+#include "TwinStickHorde.generated.h"
+
+class ATwinStickNPC;
+class ATwinStickCharacter;
+class UInstancedStaticMeshComponent;
+
+/**
+ *  Data-only horde for a Twin Stick Shooter game
+ *  Most NPCs live here as plain structure-of-arrays entities drawn with a single instanced mesh,
+ *  and are processed in parallel chunks for movement, avoidance and player contact damage.
+ *  Entities are projected back onto the navmesh a few at a time, so they can't drift through walls for long.
+ *  Entities close to a player are promoted to full ATwinStickNPC actors so they can be shot,
+ *  and promoted NPCs that wander far away are demoted back into the horde.
+ */
+UCLASS(abstract)
+class ATwinStickHorde : public AActor
+{
+	GENERATED_BODY()
+
+	/** Draws the data-only entities */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category="Components", meta = (AllowPrivateAccess = "true"))
+	UInstancedStaticMeshComponent* Instances;
+
+protected:
+
+	/** Type of NPC to promote entities into */
+	UPROPERTY(EditAnywhere, Category="Horde")
+	TSubclassOf<ATwinStickNPC> NPCClass;
+
+	/** Max number of data-only entities in the horde */
+	UPROPERTY(EditAnywhere, Category="Horde", meta = (ClampMin = 0, ClampMax = 10000))
+	int32 MaxEntities = 2000;
+
+	/** Number of entities processed per parallel task */
+	UPROPERTY(EditAnywhere, Category="Horde", meta = (ClampMin = 16, ClampMax = 4096))
+	int32 ChunkSize = 256;
+
+	/** Entities closer than this to a player are promoted to actors */
+	UPROPERTY(EditAnywhere, Category="Horde|Promotion", meta = (ClampMin = 0, Units = "cm"))
+	float PromotionRadius = 1500.0f;
+
+	/** Promoted NPCs farther than this from every player are demoted back to entities. Should be larger than the promotion radius */
+	UPROPERTY(EditAnywhere, Category="Horde|Promotion", meta = (ClampMin = 0, Units = "cm"))
+	float DemotionRadius = 2000.0f;
+
+	/** Max number of entities to promote or demote per frame */
+	UPROPERTY(EditAnywhere, Category="Horde|Promotion", meta = (ClampMin = 1, ClampMax = 100))
+	int32 MaxPromotionsPerFrame = 4;
+
+	/** Entity movement speed. Should match the NPC max walk speed */
+	UPROPERTY(EditAnywhere, Category="Horde|Movement", meta = (ClampMin = 0, Units = "cm/s"))
+	float MoveSpeed = 200.0f;
+
+	/** If true, entities follow the shared flow field towards players instead of moving in a straight line */
+	UPROPERTY(EditAnywhere, Category="Horde|Movement")
+	bool bUseFlowField = true;
+
+	/** Max number of entities projected onto the navmesh per frame. Every entity is projected once every few frames */
+	UPROPERTY(EditAnywhere, Category="Horde|Navigation", meta = (ClampMin = 1, ClampMax = 4096))
+	int32 MaxProjectionsPerFrame = 256;
+
+	/** Extent of the navmesh projection around each entity */
+	UPROPERTY(EditAnywhere, Category="Horde|Navigation")
+	FVector NavProjectionExtent = FVector(50.0f, 50.0f, 250.0f);
+
+	/** Entities closer than this push each other apart */
+	UPROPERTY(EditAnywhere, Category="Horde|Avoidance", meta = (ClampMin = 1, Units = "cm"))
+	float AvoidanceRadius = 90.0f;
+
+	/** Strength of the avoidance push relative to the move speed */
+	UPROPERTY(EditAnywhere, Category="Horde|Avoidance", meta = (ClampMin = 0, ClampMax = 5))
+	float AvoidanceStrength = 1.0f;
+
+	/** Max number of neighbors considered per entity for avoidance */
+	UPROPERTY(EditAnywhere, Category="Horde|Avoidance", meta = (ClampMin = 1, ClampMax = 32))
+	int32 MaxAvoidanceNeighbors = 8;
+
+	/** Entities closer than this to a player damage them */
+	UPROPERTY(EditAnywhere, Category="Horde|Damage", meta = (ClampMin = 0, Units = "cm"))
+	float ContactRadius = 100.0f;
+
+	/** Damage applied to the player on contact */
+	UPROPERTY(EditAnywhere, Category="Horde|Damage", meta = (ClampMin = 0))
+	float ContactDamage = 1.0f;
+
+	/** Time before the same entity can damage a player again */
+	UPROPERTY(EditAnywhere, Category="Horde|Damage", meta = (ClampMin = 0, Units = "s"))
+	float ContactCooldown = 1.0f;
+
+	/** Entity locations */
+	TArray<FVector> Positions;
+
+	/** Entity locations for the next frame, written by the parallel processing pass */
+	TArray<FVector> NextPositions;
+
+	/** Last location of each entity that was on the navmesh. Entities that leave the navmesh are moved back here */
+	TArray<FVector> NavPositions;
+
+	/** Entity velocities */
+	TArray<FVector> Velocities;
+
+	/** Desired movement directions, gathered on the game thread before the parallel pass */
+	TArray<FVector> DesiredDirections;
+
+	/** Time left before each entity can deal contact damage again */
+	TArray<float> ContactTimers;
+
+	/** Index of the player each entity touched this frame, or INDEX_NONE */
+	TArray<int32> ContactPlayers;
+
+	/** Instance transforms, written by the parallel processing pass */
+	TArray<FTransform> InstanceTransforms;
+
+	/** Spatial grid of the entities, rebuilt every frame */
+	FUniformGrid2D Grid;
+
+	/** NPC actors promoted from the horde */
+	TArray<TWeakObjectPtr<ATwinStickNPC>> PromotedNPCs;
+
+	/** First entity to project onto the navmesh on the next frame */
+	int32 ProjectionCursor = 0;
+
+public:
+
+	/** Constructor */
+	ATwinStickHorde();
+
+	/** Updates the horde */
+	virtual void Tick(float DeltaTime) override;
+
+public:
+
+	/** Adds a data-only entity at the given navigable location. Returns false if the horde is full */
+	bool AddEntity(const FVector& Location);
+
+	/** Returns true if the horde can accept more entities */
+	bool CanAddEntities() const;
+
+	/** Returns the number of data-only entities */
+	int32 GetNumEntities() const { return Positions.Num(); }
+
+protected:
+
+	/** Fills the desired directions towards the nearest player */
+	void GatherDesiredDirections(const TArray<FVector>& PlayerLocations);
+
+	/** Moves, separates and checks contact for one chunk of entities. Safe to run in parallel */
+	void ProcessChunk(int32 ChunkIndex, float DeltaTime, const TArray<FVector>& PlayerLocations);
+
+	/** Projects the next slice of entities onto the navmesh */
+	void ProjectToNavigation();
+
+	/** Applies contact damage on the game thread */
+	void ApplyContactDamage(const TArray<ATwinStickCharacter*>& Players);
+
+	/** Promotes entities near players into NPC actors and demotes faraway NPCs back into entities */
+	void UpdatePromotions(const TArray<FVector>& PlayerLocations);
+
+	/** Removes an entity by swapping it with the last one */
+	void RemoveEntityAtSwap(int32 Index);
+
+	/** Syncs the instanced mesh with the entity data */
+	void UpdateInstances();
+};
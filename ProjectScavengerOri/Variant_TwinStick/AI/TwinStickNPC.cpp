@@ -11,11 +11,22 @@
 #include "Engine/World.h"
 #include "TwinStickNPCDestruction.h"
 #include "TimerManager.h"
-
-ATwinStickNPC::ATwinStickNPC()
+#include "Managers/AISignificanceManager.h"
+#include "TwinStickAIController.h"
+#include "Managers/PoolableComponent.h"
+#include "Managers/PoolSubsystem.h"
+#include "Managers/CrowdAvoidanceMovementComponent.h"
+#include "TwinStickSpawnDirector.h"
+#include "TwinStickNPCSpatialIndex.h"
+
+ATwinStickNPC::ATwinStickNPC(const FObjectInitializer& ObjectInitializer)
+	: Super(ObjectInitializer.SetDefaultSubobjectClass<UCrowdAvoidanceMovementComponent>(ACharacter::CharacterMovementComponentName))
 {
 	PrimaryActorTick.bCanEverTick = true;
 
+	// create the poolable component
+	Poolable = CreateDefaultSubobject<UPoolableComponent>(TEXT("Poolable"));
+
 	// ensure we spawn an AI controller when we're spawned
 	AutoPossessAI = EAutoPossessAI::PlacedInWorldOrSpawned;
 
@@ -32,7 +43,6 @@ ATwinStickNPC::ATwinStickNPC()
 	GetCharacterMovement()->MaxWalkSpeedCrouched = 100.0f;
 	GetCharacterMovement()->RotationRate = FRotator(0.0f, 640.0f, 0.0f);
 	GetCharacterMovement()->bOrientRotationToMovement = true;
-	GetCharacterMovement()->bUseRVOAvoidance = true;
 	GetCharacterMovement()->AvoidanceConsiderationRadius = 250.0f;
 	GetCharacterMovement()->AvoidanceWeight = 1.0f;
 	GetCharacterMovement()->bConstrainToPlane = true;
@@ -43,33 +53,27 @@ void ATwinStickNPC::BeginPlay()
 {
 	Super::BeginPlay();
 
-	// increment the NPC counter so we can cap spawning if necessary
-	if (ATwinStickGameMode* GM = Cast<ATwinStickGameMode>(GetWorld()->GetAuthGameMode()))
+	// listen for pool events
+	Poolable->OnAcquireFromPool.AddDynamic(this, &ATwinStickNPC::OnAcquiredFromPool);
+	Poolable->OnReleaseToPool.AddDynamic(this, &ATwinStickNPC::OnReleasedToPool);
+
+	// NPCs spawned by the pool start asleep and register when they're acquired
+	if (!IsInPool())
 	{
-		GM->IncreaseNPCs();
+		RegisterNPC();
 	}
-
 }
 
 void ATwinStickNPC::EndPlay(EEndPlayReason::Type EndPlayReason)
 {
 	Super::EndPlay(EndPlayReason);
 
+	UnregisterNPC();
+
 	// clear the destruction timer
 	GetWorld()->GetTimerManager().ClearTimer(DestructionTimer);
 }
 
-void ATwinStickNPC::Destroyed()
-{
-	// decrease the NPC counter so we can cap spawning if necessary
-	if (ATwinStickGameMode* GM = Cast<ATwinStickGameMode>(GetWorld()->GetAuthGameMode()))
-	{
-		GM->DecreaseNPCs();
-	}
-
-	Super::Destroyed();
-}
-
 void ATwinStickNPC::NotifyHit(class UPrimitiveComponent* MyComp, AActor* Other, class UPrimitiveComponent* OtherComp, bool bSelfMoved, FVector HitLocation, FVector HitNormal, FVector NormalImpulse, const FHitResult& Hit)
 {
 	// have we collided against the player?
@@ -83,31 +87,50 @@ void ATwinStickNPC::NotifyHit(class UPrimitiveComponent* MyComp, AActor* Other,
 void ATwinStickNPC::ProjectileImpact(const FVector& ForwardVector)
 {
 	// only handle damage if we haven't been hit yet
-	if (bHit)
+	if (!Kill())
 	{
 		return;
 	}
 
+	// award points
+	if (ATwinStickGameMode* GM = Cast<ATwinStickGameMode>(GetWorld()->GetAuthGameMode()))
+	{
+		GM->ScoreUpdate(Score);
+	}
+}
+
+bool ATwinStickNPC::Kill()
+{
+	if (bHit)
+	{
+		return false;
+	}
+
 	// raise the hit flag
 	bHit = true;
 
 	// deactivate character movement
 	GetCharacterMovement()->Deactivate();
 
-	// award points
-	if (ATwinStickGameMode* GM = Cast<ATwinStickGameMode>(GetWorld()->GetAuthGameMode()))
+	// let the StateTree react to the hit through an event instead of polling the hit flag
+	if (ATwinStickAIController* AIController = Cast<ATwinStickAIController>(GetController()))
 	{
-		GM->ScoreUpdate(Score);
+		AIController->NotifyHit();
 	}
 
-	// randomly spawn a pickup
-	if (FMath::RandRange(0, 100) < PickupSpawnChance)
+	// queue the pickup and destruction proxy on the spawn director,
+	// so many NPCs dying on the same frame don't spawn all of their actors at once
+	if (UTwinStickSpawnDirector* SpawnDirector = GetWorld()->GetSubsystem<UTwinStickSpawnDirector>())
 	{
-		ATwinStickPickup* Pickup = GetWorld()->SpawnActor<ATwinStickPickup>(PickupClass, GetActorTransform());
+		// randomly spawn a pickup. Pickups affect gameplay, so they're never dropped
+		if (FMath::RandRange(0, 100) < PickupSpawnChance)
+		{
+			SpawnDirector->RequestDeferredSpawn(PickupClass, GetActorTransform(), false);
+		}
+
+		// spawn the NPC destruction proxy
+		SpawnDirector->RequestDeferredSpawn(DestructionProxyClass, GetActorTransform(), true);
 	}
-	
-	// spawn the NPC destruction proxy
-	ATwinStickNPCDestruction* DestructionProxy = GetWorld()->SpawnActor<ATwinStickNPCDestruction>(DestructionProxyClass, GetActorTransform());
 
 	// hide this actor
 	SetActorHiddenInGame(true);
@@ -117,10 +140,113 @@ void ATwinStickNPC::ProjectileImpact(const FVector& ForwardVector)
 
 	// defer destruction
 	GetWorld()->GetTimerManager().SetTimer(DestructionTimer, this, &ATwinStickNPC::DeferredDestroy, DeferredDestructionTime, false);
+
+	return true;
+}
+
+bool ATwinStickNPC::IsInPool() const
+{
+	return Poolable->IsInPool();
 }
 
 void ATwinStickNPC::DeferredDestroy()
 {
+	// return this actor to the pool so it can be reused by the spawners
+	if (UPoolSubsystem* PoolSubsystem = GetWorld()->GetSubsystem<UPoolSubsystem>())
+	{
+		PoolSubsystem->ReleaseToPool(this);
+		return;
+	}
+
 	// destroy this actor
 	Destroy();
 }
+
+void ATwinStickNPC::RegisterNPC()
+{
+	if (bRegistered)
+	{
+		return;
+	}
+
+	bRegistered = true;
+
+	// increment the NPC counter so we can cap spawning if necessary
+	if (ATwinStickGameMode* GM = Cast<ATwinStickGameMode>(GetWorld()->GetAuthGameMode()))
+	{
+		GM->IncreaseNPCs();
+	}
+
+	// register with the significance manager so off-screen NPCs update at a reduced rate
+	if (UAISignificanceManager* SignificanceManager = GetWorld()->GetSubsystem<UAISignificanceManager>())
+	{
+		SignificanceManager->RegCharacter(this);
+	}
+
+	// add to the spatial index so area attacks can find us
+	if (UTwinStickNPCSpatialIndex* SpatialIndex = GetWorld()->GetSubsystem<UTwinStickNPCSpatialIndex>())
+	{
+		SpatialIndex->AddNPC(this);
+	}
+}
+
+void ATwinStickNPC::UnregisterNPC()
+{
+	if (!bRegistered)
+	{
+		return;
+	}
+
+	bRegistered = false;
+
+	// decrease the NPC counter so we can cap spawning if necessary
+	if (ATwinStickGameMode* GM = Cast<ATwinStickGameMode>(GetWorld()->GetAuthGameMode()))
+	{
+		GM->DecreaseNPCs();
+	}
+
+	// unregister from the significance manager
+	if (UAISignificanceManager* SignificanceManager = GetWorld()->GetSubsystem<UAISignificanceManager>())
+	{
+		SignificanceManager->DeregCharacter(this);
+	}
+
+	// remove from the spatial index
+	if (UTwinStickNPCSpatialIndex* SpatialIndex = GetWorld()->GetSubsystem<UTwinStickNPCSpatialIndex>())
+	{
+		SpatialIndex->RemoveNPC(this);
+	}
+}
+
+void ATwinStickNPC::OnAcquiredFromPool()
+{
+	// reset the hit flag
+	bHit = false;
+
+	// reactivate character movement
+	GetCharacterMovement()->Activate(true);
+	GetCharacterMovement()->SetMovementMode(MOVE_Walking);
+
+	RegisterNPC();
+
+	// restart the AI
+	if (ATwinStickAIController* AIController = Cast<ATwinStickAIController>(GetController()))
+	{
+		AIController->ResumeFromPool();
+	}
+}
+
+void ATwinStickNPC::OnReleasedToPool()
+{
+	// stop the AI while we're in the pool
+	if (ATwinStickAIController* AIController = Cast<ATwinStickAIController>(GetController()))
+	{
+		AIController->SuspendForPool();
+	}
+
+	// stop moving
+	GetCharacterMovement()->StopMovementImmediately();
+	GetCharacterMovement()->Deactivate();
+
+	UnregisterNPC();
+}
@@ -8,17 +8,23 @@
 
 class ATwinStickPickup;
 class ATwinStickNPCDestruction;
+class UPoolableComponent;
 
 /**
  *  A simple enemy NPC for a Twin Stick Shooter game
  *  It's driven by an AI Controller running a behavior tree
  *  Awards points and randomly spawns pickups on death
+ *  Returns to the actor pool on death so spawners can reuse it
  */
 UCLASS(abstract)
 class ATwinStickNPC : public ACharacter
 {
 	GENERATED_BODY()
 
+	/** Lets the actor pool reuse this NPC */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category="Components", meta = (AllowPrivateAccess = "true"))
+	UPoolableComponent* Poolable;
+
 protected:
 
 	/** Score to award when this NPC is destroyed */
@@ -44,6 +50,9 @@ protected:
 	/** Deferred destruction timer */
 	FTimerHandle DestructionTimer;
 
+	/** True while this NPC counts towards the NPC cap and is registered with the significance manager */
+	bool bRegistered = false;
+
 public:
 
 	/** If true, this NPC has already been hit by a projectile and is being destroyed. Exposed to BP so it can be read by StateTree */
@@ -53,7 +62,7 @@ public:
 public:
 
 	/** Constructor */
-	ATwinStickNPC();
+	ATwinStickNPC(const FObjectInitializer& ObjectInitializer);
 
 protected:
 
@@ -63,9 +72,6 @@ protected:
 	/** Gameplay cleanup */
 	virtual void EndPlay(EEndPlayReason::Type EndPlayReason) override;
 
-	/** Handle destruction */
-	virtual void Destroyed() override;
-
 	/** Collision handling */
 	virtual void NotifyHit(class UPrimitiveComponent* MyComp, AActor* Other, class UPrimitiveComponent* OtherComp, bool bSelfMoved, FVector HitLocation, FVector HitNormal, FVector NormalImpulse, const FHitResult& Hit) override;
 
@@ -74,8 +80,31 @@ public:
 	/** Tells the NPC to process a projectile impact */
 	void ProjectileImpact(const FVector& ForwardVector);
 
+	/** Kills the NPC without awarding its score, so callers can batch score updates. Returns false if it was already hit */
+	bool Kill();
+
+	/** Returns the score awarded for killing this NPC */
+	int32 GetScore() const { return Score; }
+
+	/** Returns true if this NPC is asleep in the actor pool */
+	bool IsInPool() const;
+
 protected:
 
-	/** Called from timer to complete the destruction process for this NPC */
+	/** Called from timer to complete the destruction process for this NPC. Returns it to the pool if possible */
 	void DeferredDestroy();
+
+	/** Counts this NPC towards the cap and registers it with the significance manager and spatial index */
+	void RegisterNPC();
+
+	/** Undoes RegisterNPC */
+	void UnregisterNPC();
+
+	/** Resets the NPC when it's reused from the pool */
+	UFUNCTION()
+	void OnAcquiredFromPool();
+
+	/** Puts the NPC to sleep when it's returned to the pool */
+	UFUNCTION()
+	void OnReleasedToPool();
 };
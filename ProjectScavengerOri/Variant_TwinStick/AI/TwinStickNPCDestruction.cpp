@@ -2,9 +2,83 @@
 
 
 #include "TwinStickNPCDestruction.h"
+#include "Components/PrimitiveComponent.h"
+#include "Managers/PoolableComponent.h"
 
 ATwinStickNPCDestruction::ATwinStickNPCDestruction()
 {
  	PrimaryActorTick.bCanEverTick = true;
 
+	// create the poolable component
+	Poolable = CreateDefaultSubobject<UPoolableComponent>(TEXT("Poolable"));
+
+}
+
+void ATwinStickNPCDestruction::BeginPlay()
+{
+	Super::BeginPlay();
+
+	// save the initial state of the primitives. Physics moves them around and the pool disables their physics and collision
+	TInlineComponentArray<UPrimitiveComponent*> Primitives(this);
+
+	for (UPrimitiveComponent* Primitive : Primitives)
+	{
+		FTwinStickProxyComponentState& State = InitialComponentStates.AddDefaulted_GetRef();
+		State.Component = Primitive;
+		State.AttachParent = Primitive->GetAttachParent();
+		State.RelativeTransform = Primitive->GetRelativeTransform();
+
+		// read the collision and physics from the body settings. The pool disabled the actor's collision before BeginPlay,
+		// so the component's effective state would read as no collision
+		State.Collision = Primitive->BodyInstance.GetCollisionEnabled(false);
+		State.bSimulatePhysics = Primitive->BodyInstance.bSimulatePhysics;
+	}
+
+	// return to the pool once the effects are done. A life span set on the Blueprint defaults
+	// takes the place of the lifetime, so it returns the proxy to the pool instead of destroying it
+	const float LifeSpan = InitialLifeSpan > 0.0f ? InitialLifeSpan : Lifetime;
+	SetLifeSpan(0.0f);
+
+	Poolable->OnAcquireFromPool.AddDynamic(this, &ATwinStickNPCDestruction::OnAcquiredFromPool);
+	Poolable->SetAutoReturnTime(LifeSpan);
+}
+
+void ATwinStickNPCDestruction::OnAcquiredFromPool()
+{
+	for (const FTwinStickProxyComponentState& State : InitialComponentStates)
+	{
+		UPrimitiveComponent* Primitive = State.Component.Get();
+
+		if (!Primitive)
+		{
+			continue;
+		}
+
+		// reattach primitives that were detached by physics simulation and put them back in place.
+		// The root has no parent and was already moved to the spawn transform by the pool, so it's left where it is
+		if (USceneComponent* AttachParent = State.AttachParent.Get())
+		{
+			if (Primitive->GetAttachParent() != AttachParent)
+			{
+				Primitive->AttachToComponent(AttachParent, FAttachmentTransformRules::KeepRelativeTransform);
+			}
+
+			Primitive->SetRelativeTransform(State.RelativeTransform, false, nullptr, ETeleportType::ResetPhysics);
+		}
+
+		Primitive->SetCollisionEnabled(State.Collision);
+		Primitive->SetSimulatePhysics(State.bSimulatePhysics);
+	}
+
+	// let the Blueprint start its effects
+	BP_OnAcquiredFromPool();
+}
+
+void ATwinStickNPCDestruction::LifeSpanExpired()
+{
+	// a life span set at runtime also returns the proxy to the pool
+	if (!Poolable->IsInPool())
+	{
+		Poolable->ReturnToPool();
+	}
 }
\ No newline at end of file
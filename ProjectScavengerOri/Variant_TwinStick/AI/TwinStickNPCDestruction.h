@@ -6,19 +6,73 @@
 #include "GameFramework/Actor.h"
 #include "TwinStickNPCDestruction.generated.h"
 
+class UPoolableComponent;
+class UPrimitiveComponent;
+
+/** Initial state of a destruction proxy component, restored when the proxy is reused */
+struct FTwinStickProxyComponentState
+{
+	/** Component to restore */
+	TWeakObjectPtr<UPrimitiveComponent> Component;
+
+	/** Component the primitive was attached to. Null for the root, which is placed by the pool instead */
+	TWeakObjectPtr<USceneComponent> AttachParent;
+
+	/** Initial relative transform. Only restored for attached primitives */
+	FTransform RelativeTransform;
+
+	/** Initial collision */
+	ECollisionEnabled::Type Collision = ECollisionEnabled::NoCollision;
+
+	/** True if the component simulated physics initially */
+	bool bSimulatePhysics = false;
+};
+
 /**
  *  A NPC destruction proxy for a Twin Stick Shooter game
  *  Replaces the NPC when it is destroyed,
  *  allowing it to play effects without affecting gameplay 
+ *  Proxies are acquired from the actor pool and return to it after their lifetime.
+ *  Proxies start asleep in the pool, so Blueprint effects should be started from On Acquired From Pool rather than
+ *  BeginPlay. The proxy returns itself to the pool when its lifetime runs out, so Blueprints shouldn't destroy it
  */
 UCLASS(abstract)
 class ATwinStickNPCDestruction : public AActor
 {
 	GENERATED_BODY()
+
+	/** Lets the actor pool reuse this proxy */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category="Components", meta = (AllowPrivateAccess = "true"))
+	UPoolableComponent* Poolable;
+
+protected:
+
+	/** Time before the proxy returns to the pool */
+	UPROPERTY(EditAnywhere, Category="Destruction", meta = (ClampMin = 0.1, ClampMax = 30, Units = "s"))
+	float Lifetime = 3.0f;
+
+	/** Initial state of the primitive components, saved on BeginPlay */
+	TArray<FTwinStickProxyComponentState> InitialComponentStates;
 	
 public:
 
 	/** Constructor */
 	ATwinStickNPCDestruction();
 
+protected:
+
+	/** Gameplay initialization */
+	virtual void BeginPlay() override;
+
+	/** Restores the initial component state when the proxy is reused from the pool */
+	UFUNCTION()
+	void OnAcquiredFromPool();
+
+	/** Returns the proxy to the pool instead of destroying it if a life span was set */
+	virtual void LifeSpanExpired() override;
+
+	/** Called every time the proxy is acquired from the pool, after its components have been reset. Start the effects here */
+	UFUNCTION(BlueprintImplementableEvent, Category="Destruction", meta = (DisplayName="On Acquired From Pool"))
+	void BP_OnAcquiredFromPool();
+
 };
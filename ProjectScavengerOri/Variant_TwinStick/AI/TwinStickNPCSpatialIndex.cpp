@@ -0,0 +1,74 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+
+#include "TwinStickNPCSpatialIndex.h"
+#include "TwinStickNPC.h"
+
+void UTwinStickNPCSpatialIndex::AddNPC(ATwinStickNPC* NPC)
+{
+	if (!IsValid(NPC))
+	{
+		return;
+	}
+
+	NPCs.AddUnique(NPC);
+	bDirty = true;
+}
+
+void UTwinStickNPCSpatialIndex::RemoveNPC(ATwinStickNPC* NPC)
+{
+	// remove the NPC along with any stale entries
+	NPCs.RemoveAllSwap([NPC](const TWeakObjectPtr<ATwinStickNPC>& Registered)
+	{
+		return !Registered.IsValid() || Registered.Get() == NPC;
+	});
+
+	bDirty = true;
+}
+
+void UTwinStickNPCSpatialIndex::QueryRadius(const FVector& Center, float Radius, TArray<ATwinStickNPC*>& OutNPCs)
+{
+	RebuildIfNeeded();
+
+	const FVector2D Center2D(Center);
+	const double RadiusSq = FMath::Square(Radius);
+
+	Grid.ForEachInBox(Center2D - FVector2D(Radius), Center2D + FVector2D(Radius), [&](int32 Index)
+	{
+		ATwinStickNPC* NPC = NPCs[Index].Get();
+
+		// test the current location, the NPC may have moved since the rebuild
+		if (IsValid(NPC) && FVector::DistSquared2D(NPC->GetActorLocation(), Center) <= RadiusSq)
+		{
+			OutNPCs.Add(NPC);
+		}
+	});
+}
+
+void UTwinStickNPCSpatialIndex::Deinitialize()
+{
+	NPCs.Empty();
+	Grid.Reset();
+
+	Super::Deinitialize();
+}
+
+void UTwinStickNPCSpatialIndex::RebuildIfNeeded()
+{
+	if (!bDirty && BuiltFrame == GFrameCounter)
+	{
+		return;
+	}
+
+	BuiltFrame = GFrameCounter;
+	bDirty = false;
+
+	// drop NPCs that were destroyed without unregistering
+	NPCs.RemoveAllSwap([](const TWeakObjectPtr<ATwinStickNPC>& Registered) { return !Registered.IsValid(); });
+
+	Grid.Build(CellSize, NPCs.Num(), [this](int32 Index, FVector2D& OutLocation)
+	{
+		OutLocation = FVector2D(NPCs[Index]->GetActorLocation());
+		return true;
+	});
+}
@@ -0,0 +1,58 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Managers/UniformGrid.h"
+#include "TwinStickNPCSpatialIndex.generated.h"
+
+class ATwinStickNPC;
+
+/**
+ *  2D spatial index of the active NPCs in a Twin Stick Shooter game
+ *  NPCs are bucketed into a uniform grid on the XY plane so radius queries only visit nearby NPCs.
+ *  NPCs move every frame, so the grid is rebuilt on the first query of each frame instead of on every move
+ */
+UCLASS(Config = Game)
+class UTwinStickNPCSpatialIndex : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+protected:
+
+	/** Size of a grid cell. Should be close to the typical query radius */
+	UPROPERTY(Config)
+	float CellSize = 500.0f;
+
+	/** Registered NPCs */
+	TArray<TWeakObjectPtr<ATwinStickNPC>> NPCs;
+
+	/** Grid of the NPC indices, as of the last rebuild */
+	FUniformGrid2D Grid;
+
+	/** Frame the grid was last rebuilt on */
+	uint64 BuiltFrame = 0;
+
+	/** True if NPCs were added or removed since the last rebuild */
+	bool bDirty = true;
+
+public:
+
+	/** Adds an active NPC to the index */
+	void AddNPC(ATwinStickNPC* NPC);
+
+	/** Removes an NPC from the index */
+	void RemoveNPC(ATwinStickNPC* NPC);
+
+	/** Appends the NPCs within Radius of Center on the XY plane to OutNPCs */
+	void QueryRadius(const FVector& Center, float Radius, TArray<ATwinStickNPC*>& OutNPCs);
+
+	/** Subsystem cleanup */
+	virtual void Deinitialize() override;
+
+protected:
+
+	/** Rebuilds the grid from the current NPC locations if it hasn't been rebuilt this frame */
+	void RebuildIfNeeded();
+};
@@ -0,0 +1,298 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+
+#include "TwinStickSpawnDirector.h"
+#include "TwinStickSpawner.h"
+#include "TwinStickGameMode.h"
+#include "TwinStickCharacter.h"
+#include "Engine/World.h"
+#include "TimerManager.h"
+#include "Managers/PoolSubsystem.h"
+
+DECLARE_CYCLE_STAT(TEXT("Process Spawn Queues"), STAT_TwinStickProcessSpawnQueues, STATGROUP_TwinStickSpawn);
+DECLARE_DWORD_COUNTER_STAT(TEXT("NPCs Spawned"), STAT_TwinStickNPCsSpawned, STATGROUP_TwinStickSpawn);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Queue Depth"), STAT_TwinStickSpawnQueueDepth, STATGROUP_TwinStickSpawn);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Deferred Actors Spawned"), STAT_TwinStickDeferredSpawns, STATGROUP_TwinStickSpawn);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Deferred Queue Depth"), STAT_TwinStickDeferredQueueDepth, STATGROUP_TwinStickSpawn);
+
+void UTwinStickSpawnDirector::RequestSpawn(ATwinStickSpawner* Spawner, int32 Count)
+{
+	if (!IsValid(Spawner) || Count <= 0)
+	{
+		return;
+	}
+
+	// merge the request into the spawner's queue
+	FTwinStickSpawnQueue* Queue = Queues.FindByPredicate([Spawner](const FTwinStickSpawnQueue& Candidate) { return Candidate.Spawner.Get() == Spawner; });
+
+	if (!Queue)
+	{
+		Queue = &Queues.AddDefaulted_GetRef();
+		Queue->Spawner = Spawner;
+	}
+
+	const int32 Requested = Queue->Pending + Count;
+	Queue->Pending = FMath::Min(Requested, MaxQueuedPerSpawner);
+
+	if (Requested > Queue->Pending)
+	{
+		UE_LOG(LogTemp, Verbose, TEXT("Spawn queue for %s is full, dropped %d NPCs"), *Spawner->GetName(), Requested - Queue->Pending);
+	}
+
+	UpdateQueueDepthStat();
+
+	// process the queues on the next frame, so requests made on the same frame are budgeted together
+	ScheduleNextTick();
+}
+
+void UTwinStickSpawnDirector::CancelRequests(const ATwinStickSpawner* Spawner)
+{
+	Queues.RemoveAllSwap([Spawner](const FTwinStickSpawnQueue& Queue) { return Queue.Spawner.Get() == Spawner; });
+
+	UpdateQueueDepthStat();
+}
+
+void UTwinStickSpawnDirector::RequestDeferredSpawn(TSubclassOf<AActor> ActorClass, const FTransform& Transform, bool bCosmetic)
+{
+	if (!ActorClass)
+	{
+		return;
+	}
+
+	// cosmetic spawns are pointless once they fall too far behind, so drop them when the queue is full
+	if (bCosmetic && DeferredSpawns.Num() >= MaxQueuedDeferredSpawns)
+	{
+		return;
+	}
+
+	FTwinStickDeferredSpawn& DeferredSpawn = DeferredSpawns.AddDefaulted_GetRef();
+	DeferredSpawn.ActorClass = ActorClass;
+	DeferredSpawn.Transform = Transform;
+	DeferredSpawn.bCosmetic = bCosmetic;
+
+	UpdateQueueDepthStat();
+
+	ScheduleNextTick();
+}
+
+int32 UTwinStickSpawnDirector::GetQueueDepth() const
+{
+	int32 Depth = 0;
+
+	for (const FTwinStickSpawnQueue& Queue : Queues)
+	{
+		Depth += Queue.Pending;
+	}
+
+	return Depth;
+}
+
+void UTwinStickSpawnDirector::Deinitialize()
+{
+	if (UWorld* World = GetWorld())
+	{
+		World->GetTimerManager().ClearTimer(ProcessTimer);
+		World->GetTimerManager().ClearTimer(SleepTimer);
+	}
+
+	ClearQueues();
+	DeferredSpawns.Reset();
+
+	Super::Deinitialize();
+}
+
+void UTwinStickSpawnDirector::ProcessQueues()
+{
+	SCOPE_CYCLE_COUNTER(STAT_TwinStickProcessSpawnQueues);
+
+	UWorld* World = GetWorld();
+
+	if (!World)
+	{
+		return;
+	}
+
+	// the next tick timer is still executing, invalidate it so new requests can schedule another one.
+	// We may also have been woken up early by a new request, so the sleep timer is no longer needed
+	ProcessTimer.Invalidate();
+	World->GetTimerManager().ClearTimer(SleepTimer);
+
+	const double Now = World->GetTimeSeconds();
+	const double StartTime = FPlatformTime::Seconds();
+
+	// NPCs go first, deferred actors use what's left of the time budget
+	bool bOverBudget = ProcessNPCQueues(Cast<ATwinStickGameMode>(World->GetAuthGameMode()), Now, StartTime);
+	bOverBudget |= ProcessDeferredSpawns(StartTime);
+
+	UpdateQueueDepthStat();
+
+	// continue next frame if we ran out of budget or still have deferred actors
+	if (bOverBudget || DeferredSpawns.Num() > 0)
+	{
+		ScheduleNextTick();
+		return;
+	}
+
+	// find when the next queued NPC can be spawned
+	double NextTime = TNumericLimits<double>::Max();
+
+	for (const FTwinStickSpawnQueue& Queue : Queues)
+	{
+		if (Queue.Pending > 0)
+		{
+			NextTime = FMath::Min(NextTime, Queue.NextSpawnTime);
+		}
+	}
+
+	// nothing left to spawn
+	if (NextTime == TNumericLimits<double>::Max())
+	{
+		return;
+	}
+
+	// sleep until the next spawner is ready
+	if (NextTime <= Now)
+	{
+		ScheduleNextTick();
+
+	} else {
+
+		World->GetTimerManager().SetTimer(SleepTimer, this, &UTwinStickSpawnDirector::ProcessQueues, NextTime - Now, false);
+	}
+}
+
+bool UTwinStickSpawnDirector::ProcessNPCQueues(ATwinStickGameMode* GM, double Now, double StartTime)
+{
+	// drop the queues of removed spawners and finished queues
+	Queues.RemoveAllSwap([](const FTwinStickSpawnQueue& Queue) { return !Queue.Spawner.IsValid() || Queue.Pending <= 0; });
+
+	if (Queues.IsEmpty())
+	{
+		return false;
+	}
+
+	// serve the spawners closest to a player first. Spawners with no players around go last
+	for (FTwinStickSpawnQueue& Queue : Queues)
+	{
+		const FVector SpawnerLocation = Queue.Spawner->GetActorLocation();
+		const ATwinStickCharacter* PlayerCharacter = GM ? GM->GetNearestPlayerCharacter(SpawnerLocation) : nullptr;
+
+		Queue.PlayerDistanceSq = PlayerCharacter ? FVector::DistSquared(PlayerCharacter->GetActorLocation(), SpawnerLocation) : TNumericLimits<double>::Max();
+	}
+
+	Queues.Sort([](const FTwinStickSpawnQueue& A, const FTwinStickSpawnQueue& B) { return A.PlayerDistanceSq < B.PlayerDistanceSq; });
+
+	int32 Spawned = 0;
+	bool bOverBudget = false;
+
+	for (FTwinStickSpawnQueue& Queue : Queues)
+	{
+		// wait for this spawner's delay between individual NPCs
+		while (Queue.Pending > 0 && Queue.NextSpawnTime <= Now)
+		{
+			// always spawn at least one NPC per frame so a tight budget can't stall the queue
+			if (Spawned >= MaxSpawnsPerFrame || (Spawned > 0 && IsOverTimeBudget(StartTime)))
+			{
+				bOverBudget = true;
+				break;
+			}
+
+			// like a group starting over the cap, queued NPCs are dropped once the cap is reached
+			if (GM && !GM->CanSpawnNPCs())
+			{
+				INC_DWORD_STAT_BY(STAT_TwinStickNPCsSpawned, Spawned);
+				ClearQueues();
+				return false;
+			}
+
+			--Queue.Pending;
+			++Spawned;
+
+			Queue.Spawner->SpawnQueuedNPC();
+			Queue.NextSpawnTime = Now + Queue.Spawner->GetSpawnDelay();
+		}
+
+		if (bOverBudget)
+		{
+			break;
+		}
+	}
+
+	INC_DWORD_STAT_BY(STAT_TwinStickNPCsSpawned, Spawned);
+
+	return bOverBudget;
+}
+
+bool UTwinStickSpawnDirector::ProcessDeferredSpawns(double StartTime)
+{
+	if (DeferredSpawns.IsEmpty())
+	{
+		return false;
+	}
+
+	UPoolSubsystem* PoolSubsystem = GetWorld()->GetSubsystem<UPoolSubsystem>();
+
+	if (!PoolSubsystem)
+	{
+		DeferredSpawns.Reset();
+		return false;
+	}
+
+	int32 Processed = 0;
+
+	while (Processed < DeferredSpawns.Num())
+	{
+		// always acquire at least one actor per frame so a tight budget can't stall the queue
+		if (Processed >= MaxDeferredSpawnsPerFrame || (Processed > 0 && IsOverTimeBudget(StartTime)))
+		{
+			break;
+		}
+
+		const FTwinStickDeferredSpawn& DeferredSpawn = DeferredSpawns[Processed];
+
+		FPoolSpawnInfo SpawnInfo;
+		SpawnInfo.Transform = DeferredSpawn.Transform;
+
+		PoolSubsystem->AcquireFromPool(DeferredSpawn.ActorClass, SpawnInfo, FPoolSpawnOptions());
+
+		++Processed;
+	}
+
+	INC_DWORD_STAT_BY(STAT_TwinStickDeferredSpawns, Processed);
+
+	// keep the oldest first order
+	DeferredSpawns.RemoveAt(0, Processed, EAllowShrinking::No);
+
+	return DeferredSpawns.Num() > 0;
+}
+
+bool UTwinStickSpawnDirector::IsOverTimeBudget(double StartTime) const
+{
+	return (FPlatformTime::Seconds() - StartTime) * 1000.0 >= MaxSpawnTimePerFrameMs;
+}
+
+void UTwinStickSpawnDirector::ScheduleNextTick()
+{
+	// coalesce all the requests made this frame into a single update
+	FTimerManager& TimerManager = GetWorld()->GetTimerManager();
+
+	if (TimerManager.TimerExists(ProcessTimer))
+	{
+		return;
+	}
+
+	ProcessTimer = TimerManager.SetTimerForNextTick(this, &UTwinStickSpawnDirector::ProcessQueues);
+}
+
+void UTwinStickSpawnDirector::ClearQueues()
+{
+	Queues.Reset();
+
+	UpdateQueueDepthStat();
+}
+
+void UTwinStickSpawnDirector::UpdateQueueDepthStat() const
+{
+	SET_DWORD_STAT(STAT_TwinStickSpawnQueueDepth, GetQueueDepth());
+	SET_DWORD_STAT(STAT_TwinStickDeferredQueueDepth, DeferredSpawns.Num());
+}
@@ -0,0 +1,132 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "TwinStickSpawnDirector.generated.h"
+
+class ATwinStickSpawner;
+class ATwinStickGameMode;
+
+DECLARE_STATS_GROUP(TEXT("TwinStickSpawn"), STATGROUP_TwinStickSpawn, STATCAT_Advanced);
+
+/** NPC spawn requests queued by a single spawner */
+struct FTwinStickSpawnQueue
+{
+	/** Spawner that owns the requests */
+	TWeakObjectPtr<ATwinStickSpawner> Spawner;
+
+	/** Number of NPCs waiting to be spawned */
+	int32 Pending = 0;
+
+	/** World time before which the spawner can't spawn its next NPC */
+	double NextSpawnTime = 0.0;
+
+	/** Squared distance from the spawner to the nearest player, used to sort the queues */
+	double PlayerDistanceSq = 0.0;
+};
+
+/** Actor spawn deferred by the spawn director */
+struct FTwinStickDeferredSpawn
+{
+	/** Type of actor to acquire from the pool */
+	TSubclassOf<AActor> ActorClass;
+
+	/** Spawn transform */
+	FTransform Transform;
+
+	/** If true, the spawn is only cosmetic and can be dropped when the queue is full */
+	bool bCosmetic = true;
+};
+
+/**
+ *  World spawn director for a Twin Stick Shooter game
+ *  Owns the NPC spawn requests of every spawner in the level and spawns them on a per frame budget
+ *  of both NPC count and time, so groups started by several spawners on the same frame are spread out.
+ *  Spawners closer to a player are served first. The queue depth is reported under "stat TwinStickSpawn"
+ *  Also defers death effects and pickups, acquiring them from the actor pool a few per frame,
+ *  so an attack that kills many NPCs at once doesn't spawn all of their actors on the same frame
+ */
+UCLASS(Config = Game)
+class UTwinStickSpawnDirector : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+protected:
+
+	/** Max number of NPCs spawned per frame across all spawners */
+	UPROPERTY(Config)
+	int32 MaxSpawnsPerFrame = 2;
+
+	/** Time budget for spawning per frame. At least one NPC is spawned per frame while requests are ready */
+	UPROPERTY(Config)
+	float MaxSpawnTimePerFrameMs = 1.0f;
+
+	/** Max number of NPCs a single spawner can have queued. Extra requests are dropped */
+	UPROPERTY(Config)
+	int32 MaxQueuedPerSpawner = 10;
+
+	/** Max number of deferred actors acquired per frame */
+	UPROPERTY(Config)
+	int32 MaxDeferredSpawnsPerFrame = 8;
+
+	/** Max number of deferred actors waiting. Cosmetic spawns are dropped once it's reached */
+	UPROPERTY(Config)
+	int32 MaxQueuedDeferredSpawns = 64;
+
+	/** Per spawner request queues */
+	TArray<FTwinStickSpawnQueue> Queues;
+
+	/** Deferred actor spawns, oldest first */
+	TArray<FTwinStickDeferredSpawn> DeferredSpawns;
+
+	/** Timer for the queue update on the next tick */
+	FTimerHandle ProcessTimer;
+
+	/** Timer that wakes the queues up when the next spawner is ready */
+	FTimerHandle SleepTimer;
+
+public:
+
+	/** Queues a number of NPCs to be spawned by the given spawner */
+	void RequestSpawn(ATwinStickSpawner* Spawner, int32 Count);
+
+	/** Drops all queued requests for the given spawner */
+	void CancelRequests(const ATwinStickSpawner* Spawner);
+
+	/** Queues an actor to be acquired from the pool on a later frame */
+	void RequestDeferredSpawn(TSubclassOf<AActor> ActorClass, const FTransform& Transform, bool bCosmetic);
+
+	/** Returns the total number of NPCs waiting to be spawned */
+	int32 GetQueueDepth() const;
+
+	/** Returns the number of deferred actors waiting to be spawned */
+	int32 GetDeferredQueueDepth() const { return DeferredSpawns.Num(); }
+
+	/** Subsystem cleanup */
+	virtual void Deinitialize() override;
+
+protected:
+
+	/** Spawns queued NPCs and deferred actors within the frame budget and schedules the next update */
+	void ProcessQueues();
+
+	/** Spawns queued NPCs. Returns true if it stopped because the frame budget ran out */
+	bool ProcessNPCQueues(ATwinStickGameMode* GM, double Now, double StartTime);
+
+	/** Acquires deferred actors from the pool. Returns true if it stopped because the frame budget ran out */
+	bool ProcessDeferredSpawns(double StartTime);
+
+	/** Returns true if the per frame time budget has run out since StartTime */
+	bool IsOverTimeBudget(double StartTime) const;
+
+	/** Processes the queues on the next frame */
+	void ScheduleNextTick();
+
+	/** Drops every queued NPC request, used when the NPC cap is reached */
+	void ClearQueues();
+
+	/** Updates the queue depth stats */
+	void UpdateQueueDepthStat() const;
+};
@@ -6,9 +6,11 @@
 #include "TimerManager.h"
 #include "NavigationSystem.h"
 #include "NavMesh/RecastNavMesh.h"
-#include "Kismet/GameplayStatics.h"
 #include "TwinStickNPC.h"
 #include "TwinStickGameMode.h"
+#include "TwinStickHorde.h"
+#include "TwinStickSpawnDirector.h"
+#include "Managers/PoolSubsystem.h"
 
 ATwinStickSpawner::ATwinStickSpawner()
 {
@@ -20,17 +22,42 @@ void ATwinStickSpawner::BeginPlay()
 {
 	Super::BeginPlay();
 	
-	// find the recast navmesh actor on the level
-	TArray<AActor*> ActorList;
-	UGameplayStatics::GetAllActorsOfClass(GetWorld(), ARecastNavMesh::StaticClass(), ActorList);
-
-	if (ActorList.Num() > 0)
+	// get the default recast navmesh from the navigation system
+	if (UNavigationSystemV1* NavSys = FNavigationSystem::GetCurrent<UNavigationSystemV1>(GetWorld()))
 	{
-		NavData = Cast<ARecastNavMesh>(ActorList[0]);
-	} else {
+		NavData = Cast<ARecastNavMesh>(NavSys->GetDefaultNavDataInstance(FNavigationSystem::DontCreate));
+	}
 
+	if (!NavData)
+	{
 		UE_LOG(LogTemp, Log, TEXT("Could not find recast navmesh"));
+	}
+
+	// fill the spawn point reservoir, then keep refreshing it in small steps
+	SpawnPoints.Reserve(SpawnPointReservoirSize);
+
+	while (SpawnPoints.Num() < SpawnPointReservoirSize)
+	{
+		const int32 NumPoints = SpawnPoints.Num();
 
+		RefreshSpawnPoints();
+
+		// stop if the navmesh can't provide any points
+		if (SpawnPoints.Num() == NumPoints)
+		{
+			break;
+		}
+	}
+
+	GetWorld()->GetTimerManager().SetTimer(SpawnPointTimer, this, &ATwinStickSpawner::RefreshSpawnPoints, SpawnPointRefreshInterval, true);
+
+	// create NPCs up front so group spawns only reuse pooled actors
+	if (NPCClass && !Horde)
+	{
+		if (UPoolSubsystem* PoolSubsystem = GetWorld()->GetSubsystem<UPoolSubsystem>())
+		{
+			PoolSubsystem->Prewarm(NPCClass, PrewarmCount);
+		}
 	}
 
 	// set up the spawn timer
@@ -46,45 +73,117 @@ void ATwinStickSpawner::EndPlay(EEndPlayReason::Type EndPlayReason)
 
 	// clear the spawn timers
 	GetWorld()->GetTimerManager().ClearTimer(SpawnGroupTimer);
-	GetWorld()->GetTimerManager().ClearTimer(SpawnNPCTimer);
+	GetWorld()->GetTimerManager().ClearTimer(SpawnPointTimer);
+
+	// drop any NPCs still queued for this spawner
+	if (UTwinStickSpawnDirector* SpawnDirector = GetWorld()->GetSubsystem<UTwinStickSpawnDirector>())
+	{
+		SpawnDirector->CancelRequests(this);
+	}
 }
 
 void ATwinStickSpawner::SpawnNPCGroup()
 {
-	// reset the group spawn counter
-	SpawnCount = 0;
+	// if we're feeding a horde, the horde enforces its own cap
+	if (Horde)
+	{
+		SpawnHordeGroup();
+		return;
+	}
 
 	// check if we're still under the max NPC cap
 	if (ATwinStickGameMode* GM = Cast<ATwinStickGameMode>(GetWorld()->GetAuthGameMode()))
 	{
 		if (GM->CanSpawnNPCs())
 		{
-			SpawnNPC();
+			// queue the group on the spawn director, which spawns the NPCs over the following frames
+			if (UTwinStickSpawnDirector* SpawnDirector = GetWorld()->GetSubsystem<UTwinStickSpawnDirector>())
+			{
+				SpawnDirector->RequestSpawn(this, SpawnGroupSize);
+			}
 		}
 	}
 }
 
-void ATwinStickSpawner::SpawnNPC()
+void ATwinStickSpawner::SpawnQueuedNPC()
 {
-	FTransform SpawnTransform;
-
-	// find a random point around the spawner
+	// pick a random point around the spawner
 	FVector SpawnLoc;
-	if (UNavigationSystemV1::K2_GetRandomReachablePointInRadius(GetWorld(), GetActorLocation(), SpawnLoc, SpawnRadius, NavData))
+	if (GetSpawnPoint(SpawnLoc))
+	{
+		if (UPoolSubsystem* PoolSubsystem = GetWorld()->GetSubsystem<UPoolSubsystem>())
+		{
+			FPoolSpawnInfo SpawnInfo;
+			SpawnInfo.Transform.SetLocation(SpawnLoc);
+			SpawnInfo.CollisionHandlingMethodOverride = ESpawnActorCollisionHandlingMethod::AdjustIfPossibleButAlwaysSpawn;
+
+			// reuse a pooled NPC, or spawn one if the pool is empty
+			PoolSubsystem->AcquireFromPool(NPCClass, SpawnInfo, FPoolSpawnOptions());
+		}
+	}
+}
+
+float ATwinStickSpawner::GetSpawnDelay() const
+{
+	return FMath::RandRange(MinSpawnDelay, MaxSpawnDelay);
+}
+
+void ATwinStickSpawner::SpawnHordeGroup()
+{
+	// add entities at random points around the spawner until the group is done or the horde is full
+	for (int32 Index = 0; Index < HordeGroupSize && Horde->CanAddEntities(); ++Index)
 	{
-		SpawnTransform.SetLocation(SpawnLoc);
+		FVector SpawnLoc;
+		if (GetSpawnPoint(SpawnLoc))
+		{
+			Horde->AddEntity(SpawnLoc);
+		}
+	}
+}
 
-		// spawn the NPC
-		ATwinStickNPC* NPC = GetWorld()->SpawnActor<ATwinStickNPC>(NPCClass, SpawnTransform);
+void ATwinStickSpawner::RefreshSpawnPoints()
+{
+	UNavigationSystemV1* NavSys = FNavigationSystem::GetCurrent<UNavigationSystemV1>(GetWorld());
+
+	if (!NavSys)
+	{
+		return;
 	}
 
-	// increase the spawn counter
-	++SpawnCount;
+	// the navmesh may not have been registered yet when we started
+	if (!NavData)
+	{
+		NavData = Cast<ARecastNavMesh>(NavSys->GetDefaultNavDataInstance(FNavigationSystem::DontCreate));
+	}
+
+	for (int32 Index = 0; Index < SpawnPointsPerRefresh; ++Index)
+	{
+		FNavLocation SpawnLoc;
+		if (!NavSys->GetRandomReachablePointInRadius(GetActorLocation(), SpawnRadius, SpawnLoc, NavData))
+		{
+			continue;
+		}
+
+		// grow the reservoir until it's full, then replace the oldest points so they track navmesh changes
+		if (SpawnPoints.Num() < SpawnPointReservoirSize)
+		{
+			SpawnPoints.Add(SpawnLoc.Location);
 
-	// do we still have enemies left to spawn?
-	if (SpawnCount < SpawnGroupSize)
+		} else {
+
+			SpawnPoints[NextSpawnPointIndex] = SpawnLoc.Location;
+			NextSpawnPointIndex = (NextSpawnPointIndex + 1) % SpawnPoints.Num();
+		}
+	}
+}
+
+bool ATwinStickSpawner::GetSpawnPoint(FVector& OutLocation) const
+{
+	if (SpawnPoints.IsEmpty())
 	{
-		GetWorld()->GetTimerManager().SetTimer(SpawnNPCTimer, this, &ATwinStickSpawner::SpawnNPC, FMath::RandRange(MinSpawnDelay, MaxSpawnDelay), false);
+		return false;
 	}
 
+	OutLocation = SpawnPoints[FMath::RandHelper(SpawnPoints.Num())];
+	return true;
 }
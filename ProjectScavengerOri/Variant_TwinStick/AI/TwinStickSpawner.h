@@ -8,9 +8,13 @@
 #include "TwinStickSpawner.generated.h"
 
 class ARecastNavMesh;
+class ATwinStickHorde;
 
 /**
  *  A simple NPC spawner for a Twin Stick Shooter game
+ *  NPCs are drawn from the actor pool and placed at points from a reservoir of reachable locations,
+ *  which is refreshed a few points at a time on its own timer so spawning never queries the navmesh.
+ *  Individual NPC spawns are queued on the world spawn director, which spreads them out over a per frame budget
  */
 UCLASS(abstract)
 class ATwinStickSpawner : public AActor
@@ -42,15 +46,42 @@ protected:
 	/** Number of NPCs to spawn per group */
 	UPROPERTY(EditAnywhere, Category="NPC Spawner", meta = (ClampMin = 0, ClampMax = 10))
 	int32 SpawnGroupSize = 3;
-	
-	/** Number of NPCs spawned in the current group */
-	int32 SpawnCount = 0;
 
+	/** Number of NPCs to create up front and put in the actor pool */
+	UPROPERTY(EditAnywhere, Category="NPC Spawner|Pool", meta = (ClampMin = 0, ClampMax = 100))
+	int32 PrewarmCount = 6;
+
+	/** Number of reachable spawn points kept around the spawner */
+	UPROPERTY(EditAnywhere, Category="NPC Spawner|Spawn Points", meta = (ClampMin = 1, ClampMax = 256))
+	int32 SpawnPointReservoirSize = 32;
+
+	/** Number of spawn points replaced per refresh */
+	UPROPERTY(EditAnywhere, Category="NPC Spawner|Spawn Points", meta = (ClampMin = 1, ClampMax = 32))
+	int32 SpawnPointsPerRefresh = 2;
+
+	/** Time between spawn point refreshes */
+	UPROPERTY(EditAnywhere, Category="NPC Spawner|Spawn Points", meta = (ClampMin = 0.05, ClampMax = 10, Units = "s"))
+	float SpawnPointRefreshInterval = 0.5f;
+
+	/** Optional horde to feed instead of spawning NPC actors. Horde entities are added a whole group at a time */
+	UPROPERTY(EditAnywhere, Category="NPC Spawner|Horde")
+	TObjectPtr<ATwinStickHorde> Horde;
+
+	/** Number of entities to add to the horde per group */
+	UPROPERTY(EditAnywhere, Category="NPC Spawner|Horde", meta = (ClampMin = 0, ClampMax = 1000))
+	int32 HordeGroupSize = 50;
+	
 	/** NPC group spawn timer */
 	FTimerHandle SpawnGroupTimer;
 
-	/** NPC spawn timer */
-	FTimerHandle SpawnNPCTimer;
+	/** Spawn point refresh timer */
+	FTimerHandle SpawnPointTimer;
+
+	/** Reachable points around the spawner */
+	TArray<FVector> SpawnPoints;
+
+	/** Index of the next spawn point to replace */
+	int32 NextSpawnPointIndex = 0;
 
 	/** Pointer to the recast nav mesh actor, used to provide NPC spawn locations */
 	TObjectPtr<ARecastNavMesh> NavData;
@@ -70,10 +101,24 @@ protected:
 
 protected:
 
-	/** Spawns a new NPC group */
+	/** Queues a new NPC group on the spawn director */
 	void SpawnNPCGroup();
 
-	/** Spawns an individual NPC */
-	void SpawnNPC();
+	/** Adds a group of entities to the horde */
+	void SpawnHordeGroup();
+
+	/** Fills the spawn point reservoir, or replaces the oldest points once it's full */
+	void RefreshSpawnPoints();
+
+	/** Returns a random point from the spawn point reservoir. Returns false if the reservoir is empty */
+	bool GetSpawnPoint(FVector& OutLocation) const;
+
+public:
+
+	/** Spawns an individual NPC. Called by the spawn director */
+	void SpawnQueuedNPC();
+
+	/** Returns a random delay to wait before this spawner's next individual NPC spawn */
+	float GetSpawnDelay() const;
 
 };
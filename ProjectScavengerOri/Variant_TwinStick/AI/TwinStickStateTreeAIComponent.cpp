@@ -0,0 +1,33 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+
+#include "TwinStickStateTreeAIComponent.h"
+
+DECLARE_CYCLE_STAT(TEXT("StateTree Tick"), STAT_TwinStickStateTreeTick, STATGROUP_TwinStickAI);
+DECLARE_DWORD_COUNTER_STAT(TEXT("StateTree Ticks"), STAT_TwinStickStateTreeTicks, STATGROUP_TwinStickAI);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Active StateTrees"), STAT_TwinStickActiveStateTrees, STATGROUP_TwinStickAI);
+
+void UTwinStickStateTreeAIComponent::TickComponent(float DeltaTime, enum ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
+{
+	// time the StateTree update and count it, so the per NPC cost can be derived
+	SCOPE_CYCLE_COUNTER(STAT_TwinStickStateTreeTick);
+	INC_DWORD_STAT(STAT_TwinStickStateTreeTicks);
+
+	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
+}
+
+void UTwinStickStateTreeAIComponent::BeginPlay()
+{
+	Super::BeginPlay();
+
+	// count the running StateTrees
+	INC_DWORD_STAT(STAT_TwinStickActiveStateTrees);
+}
+
+void UTwinStickStateTreeAIComponent::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	// stop counting this StateTree
+	DEC_DWORD_STAT(STAT_TwinStickActiveStateTrees);
+
+	Super::EndPlay(EndPlayReason);
+}
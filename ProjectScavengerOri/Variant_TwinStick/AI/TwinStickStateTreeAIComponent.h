@@ -0,0 +1,33 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/StateTreeAIComponent.h"
+#include "TwinStickStateTreeAIComponent.generated.h"
+
+DECLARE_STATS_GROUP(TEXT("TwinStickAI"), STATGROUP_TwinStickAI, STATCAT_Advanced);
+
+/**
+ *  StateTree AI Component for Twin Stick Shooter NPCs
+ *  Reports StateTree tick time and tick counts under "stat TwinStickAI",
+ *  so the average StateTree cost per NPC per frame can be read as time / ticks
+ */
+UCLASS()
+class UTwinStickStateTreeAIComponent : public UStateTreeAIComponent
+{
+	GENERATED_BODY()
+
+public:
+
+	/** Ticks the StateTree and records its cost */
+	virtual void TickComponent(float DeltaTime, enum ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
+
+protected:
+
+	/** Gameplay initialization */
+	virtual void BeginPlay() override;
+
+	/** Gameplay cleanup */
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+};
@@ -6,24 +6,187 @@
 #include "StateTreeExecutionTypes.h"
 #include "GameFramework/Character.h"
 #include "Kismet/GameplayStatics.h"
+#include "Managers/FlowFieldManager.h"
+#include "TwinStickGameMode.h"
+#include "TwinStickCharacter.h"
+#include "TwinStickAIController.h"
 
 #define LOCTEXT_NAMESPACE "TopDownTemplate"
 
+FStateTreeGetPlayerTask::FStateTreeGetPlayerTask()
+{
+	// only wake up to handle events, e.g. the controller's retarget event
+	bShouldCallTick = false;
+	bShouldCallTickOnlyOnEvents = true;
+}
+
+EStateTreeRunStatus FStateTreeGetPlayerTask::EnterState(FStateTreeExecutionContext& Context, const FStateTreeTransitionResult& Transition) const
+{
+	// get the instance data
+	FInstanceDataType& InstanceData = Context.GetInstanceData(*this);
+
+	// resolve the target once on enter
+	ResolveTarget(InstanceData);
+
+	// re-pick the nearest player periodically by sending ourselves the retarget event
+	if (InstanceData.RetargetInterval > 0.0f && IsValid(InstanceData.Character))
+	{
+		if (ATwinStickAIController* AIController = Cast<ATwinStickAIController>(InstanceData.Character->GetController()))
+		{
+			AIController->GetWorldTimerManager().SetTimer(InstanceData.RetargetTimer, AIController, &ATwinStickAIController::RequestRetarget, InstanceData.RetargetInterval, true);
+		}
+	}
+
+	// keep the task running
+	return EStateTreeRunStatus::Running;
+}
+
+void FStateTreeGetPlayerTask::ExitState(FStateTreeExecutionContext& Context, const FStateTreeTransitionResult& Transition) const
+{
+	// get the instance data
+	FInstanceDataType& InstanceData = Context.GetInstanceData(*this);
+
+	// stop the retarget timer
+	if (IsValid(InstanceData.Character))
+	{
+		InstanceData.Character->GetWorldTimerManager().ClearTimer(InstanceData.RetargetTimer);
+	}
+}
+
 EStateTreeRunStatus FStateTreeGetPlayerTask::Tick(FStateTreeExecutionContext& Context, const float DeltaTime) const
 {
 	// get the instance data
 	FInstanceDataType& InstanceData = Context.GetInstanceData(*this);
 
-	// get the pawn possessed by the first local player
-	InstanceData.TargetPlayerCharacter = Cast<ACharacter>(UGameplayStatics::GetPlayerPawn(InstanceData.Character, 0));
+	// events are rare, so resolve again on any of them. This also catches a target that has gone away
+	ResolveTarget(InstanceData);
 
 	// keep the task running
 	return EStateTreeRunStatus::Running;
 }
 
+void FStateTreeGetPlayerTask::ResolveTarget(FInstanceDataType& InstanceData) const
+{
+	if (!IsValid(InstanceData.Character))
+	{
+		InstanceData.TargetPlayerCharacter = nullptr;
+		return;
+	}
+
+	// query the game mode's player registry for the nearest player
+	if (const ATwinStickGameMode* GM = Cast<ATwinStickGameMode>(InstanceData.Character->GetWorld()->GetAuthGameMode()))
+	{
+		InstanceData.TargetPlayerCharacter = GM->GetNearestPlayerCharacter(InstanceData.Character->GetActorLocation());
+		return;
+	}
+
+	// fall back to the pawn possessed by the first local player
+	InstanceData.TargetPlayerCharacter = Cast<ACharacter>(UGameplayStatics::GetPlayerPawn(InstanceData.Character, 0));
+}
+
 #if WITH_EDITOR
 FText FStateTreeGetPlayerTask::GetDescription(const FGuid& ID, FStateTreeDataView InstanceDataView, const IStateTreeBindingLookup& BindingLookup, EStateTreeNodeFormatting Formatting /*= EStateTreeNodeFormatting::Text*/) const
 {
 	return LOCTEXT("StateTreeTaskGetPlayerDescription", "<b>Get Player</b>");
 }
-#endif // WITH_EDITOR
\ No newline at end of file
+#endif // WITH_EDITOR
+
+////////////////////////////////////////////////////////////////////
+
+EStateTreeRunStatus FStateTreeFollowFlowFieldTask::Tick(FStateTreeExecutionContext& Context, const float DeltaTime) const
+{
+	// get the instance data
+	FInstanceDataType& InstanceData = Context.GetInstanceData(*this);
+
+	// ensure we have a character and a target
+	if (!IsValid(InstanceData.Character) || !IsValid(InstanceData.Target))
+	{
+		return EStateTreeRunStatus::Failed;
+	}
+
+	// have we reached the target?
+	if (FVector::Dist2D(InstanceData.Character->GetActorLocation(), InstanceData.Target->GetActorLocation()) <= InstanceData.AcceptanceRadius)
+	{
+		return EStateTreeRunStatus::Succeeded;
+	}
+
+	// sample the flow field at our location. Fail if it's not available so the tree can fall back to pathfinding
+	UFlowFieldManager* FlowFieldManager = InstanceData.Character->GetWorld()->GetSubsystem<UFlowFieldManager>();
+
+	FVector Direction;
+
+	if (!FlowFieldManager || !FlowFieldManager->SampleDirection(InstanceData.Character->GetNavAgentLocation(), Direction))
+	{
+		return EStateTreeRunStatus::Failed;
+	}
+
+	// steer along the flow field
+	InstanceData.Character->AddMovementInput(Direction);
+
+	// keep the task running
+	return EStateTreeRunStatus::Running;
+}
+
+#if WITH_EDITOR
+FText FStateTreeFollowFlowFieldTask::GetDescription(const FGuid& ID, FStateTreeDataView InstanceDataView, const IStateTreeBindingLookup& BindingLookup, EStateTreeNodeFormatting Formatting /*= EStateTreeNodeFormatting::Text*/) const
+{
+	return LOCTEXT("StateTreeTaskFollowFlowFieldDescription", "<b>Follow Flow Field</b>");
+}
+#endif // WITH_EDITOR
+
+////////////////////////////////////////////////////////////////////
+
+FStateTreeSetTickIntervalTask::FStateTreeSetTickIntervalTask()
+{
+	// this task only does work on enter and exit
+	bShouldCallTick = false;
+}
+
+EStateTreeRunStatus FStateTreeSetTickIntervalTask::EnterState(FStateTreeExecutionContext& Context, const FStateTreeTransitionResult& Transition) const
+{
+	// get the instance data
+	FInstanceDataType& InstanceData = Context.GetInstanceData(*this);
+
+	// apply the state's tick interval to the controller
+	if (IsValid(InstanceData.Character))
+	{
+		if (ATwinStickAIController* AIController = Cast<ATwinStickAIController>(InstanceData.Character->GetController()))
+		{
+			// remember the interval set by a parent state, so it can be restored on exit
+			InstanceData.PreviousTickInterval = AIController->GetStateTickInterval();
+			AIController->SetStateTickInterval(InstanceData.TickInterval);
+		}
+	}
+
+	// keep the task running
+	return EStateTreeRunStatus::Running;
+}
+
+void FStateTreeSetTickIntervalTask::ExitState(FStateTreeExecutionContext& Context, const FStateTreeTransitionResult& Transition) const
+{
+	// get the instance data
+	FInstanceDataType& InstanceData = Context.GetInstanceData(*this);
+
+	// restore the interval that was set before this state was entered
+	if (IsValid(InstanceData.Character))
+	{
+		if (ATwinStickAIController* AIController = Cast<ATwinStickAIController>(InstanceData.Character->GetController()))
+		{
+			if (InstanceData.PreviousTickInterval >= 0.0f)
+			{
+				AIController->SetStateTickInterval(InstanceData.PreviousTickInterval);
+
+			} else {
+
+				AIController->ClearStateTickInterval();
+			}
+		}
+	}
+}
+
+#if WITH_EDITOR
+FText FStateTreeSetTickIntervalTask::GetDescription(const FGuid& ID, FStateTreeDataView InstanceDataView, const IStateTreeBindingLookup& BindingLookup, EStateTreeNodeFormatting Formatting /*= EStateTreeNodeFormatting::Text*/) const
+{
+	return LOCTEXT("StateTreeTaskSetTickIntervalDescription", "<b>Set Tick Interval</b>");
+}
+#endif // WITH_EDITOR
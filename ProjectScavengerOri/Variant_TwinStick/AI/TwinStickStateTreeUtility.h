@@ -4,6 +4,7 @@
 
 #include "CoreMinimal.h"
 #include "StateTreeTaskBase.h"
+#include "Engine/TimerHandle.h"
 
 #include "TwinStickStateTreeUtility.generated.h"
 
@@ -24,10 +25,19 @@ struct FStateTreeGetPlayerInstanceData
 	/** Character that owns this task */
 	UPROPERTY(VisibleAnywhere, Category="Output")
 	TObjectPtr<ACharacter> TargetPlayerCharacter;
+
+	/** If greater than zero, re-pick the nearest player at this interval. Otherwise the target only changes on possession or death */
+	UPROPERTY(EditAnywhere, Category="Parameter", meta=(ClampMin = 0, Units = "s"))
+	float RetargetInterval = 0.0f;
+
+	/** Sends the retarget event every Retarget Interval while the state is active */
+	FTimerHandle RetargetTimer;
 };
 
 /**
  *  StateTree task to get the player character
+ *  Resolves the nearest player on state enter, then only again on StateTree events, e.g. the Retarget event
+ *  the Twin Stick AI Controller sends when the game mode reports a possession or death. Doesn't tick otherwise
  */
 USTRUCT(meta=(DisplayName="GetPlayer", Category="TwinStick"))
 struct FStateTreeGetPlayerTask : public FStateTreeTaskCommonBase
@@ -38,10 +48,118 @@ struct FStateTreeGetPlayerTask : public FStateTreeTaskCommonBase
 	using FInstanceDataType = FStateTreeGetPlayerInstanceData;
 	virtual const UStruct* GetInstanceDataType() const override { return FInstanceDataType::StaticStruct(); }
 
+	/** Constructor */
+	FStateTreeGetPlayerTask();
+
+	/** Runs when the owning state is entered */
+	virtual EStateTreeRunStatus EnterState(FStateTreeExecutionContext& Context, const FStateTreeTransitionResult& Transition) const override;
+
+	/** Runs when the owning state is exited */
+	virtual void ExitState(FStateTreeExecutionContext& Context, const FStateTreeTransitionResult& Transition) const override;
+
+	/** Runs only when the StateTree has events to process */
+	virtual EStateTreeRunStatus Tick(FStateTreeExecutionContext& Context, const float DeltaTime) const override;
+
+#if WITH_EDITOR
+	virtual FText GetDescription(const FGuid& ID, FStateTreeDataView InstanceDataView, const IStateTreeBindingLookup& BindingLookup, EStateTreeNodeFormatting Formatting = EStateTreeNodeFormatting::Text) const override;
+#endif // WITH_EDITOR
+
+protected:
+
+	/** Resolves the nearest player character */
+	void ResolveTarget(FInstanceDataType& InstanceData) const;
+};
+
+////////////////////////////////////////////////////////////////////
+
+/**
+ *  Instance data struct for the Follow Flow Field task
+ */
+USTRUCT()
+struct FStateTreeFollowFlowFieldInstanceData
+{
+	GENERATED_BODY()
+
+	/** Character that owns this task */
+	UPROPERTY(EditAnywhere, Category="Context")
+	TObjectPtr<ACharacter> Character;
+
+	/** Character to chase */
+	UPROPERTY(EditAnywhere, Category="Input")
+	TObjectPtr<ACharacter> Target;
+
+	/** The task succeeds once the character is within this distance of the target */
+	UPROPERTY(EditAnywhere, Category="Parameter", meta=(ClampMin = 0, Units = "cm"))
+	float AcceptanceRadius = 100.0f;
+};
+
+/**
+ *  StateTree task to chase a player by sampling the shared flow field instead of pathfinding
+ *  Fails if the flow field is unavailable at the character's location so the tree can fall back to a regular MoveTo
+ */
+USTRUCT(meta=(DisplayName="Follow Flow Field", Category="TwinStick"))
+struct FStateTreeFollowFlowFieldTask : public FStateTreeTaskCommonBase
+{
+	GENERATED_BODY()
+
+	/* Ensure we're using the correct instance data struct */
+	using FInstanceDataType = FStateTreeFollowFlowFieldInstanceData;
+	virtual const UStruct* GetInstanceDataType() const override { return FInstanceDataType::StaticStruct(); }
+
 	/** Runs while the owning state is active */
 	virtual EStateTreeRunStatus Tick(FStateTreeExecutionContext& Context, const float DeltaTime) const override;
 
 #if WITH_EDITOR
 	virtual FText GetDescription(const FGuid& ID, FStateTreeDataView InstanceDataView, const IStateTreeBindingLookup& BindingLookup, EStateTreeNodeFormatting Formatting = EStateTreeNodeFormatting::Text) const override;
 #endif // WITH_EDITOR
-};
\ No newline at end of file
+};
+
+////////////////////////////////////////////////////////////////////
+
+/**
+ *  Instance data struct for the Set Tick Interval task
+ */
+USTRUCT()
+struct FStateTreeSetTickIntervalInstanceData
+{
+	GENERATED_BODY()
+
+	/** Character that owns this task */
+	UPROPERTY(EditAnywhere, Category="Context")
+	TObjectPtr<ACharacter> Character;
+
+	/** StateTree tick interval to use while this state is active. Zero ticks every frame */
+	UPROPERTY(EditAnywhere, Category="Parameter", meta=(ClampMin = 0, ClampMax = 2, Units = "s"))
+	float TickInterval = 0.1f;
+
+	/** Interval requested before this state was entered, restored on exit. Negative if none was set */
+	UPROPERTY()
+	float PreviousTickInterval = -1.0f;
+};
+
+/**
+ *  StateTree task that sets the NPC's StateTree tick interval while its state is active
+ *  The interval is still scaled up with distance by the Twin Stick AI Controller. Exiting the state restores the interval set before it, e.g. by a parent state
+ */
+USTRUCT(meta=(DisplayName="Set Tick Interval", Category="TwinStick"))
+struct FStateTreeSetTickIntervalTask : public FStateTreeTaskCommonBase
+{
+	GENERATED_BODY()
+
+	/* Ensure we're using the correct instance data struct */
+	using FInstanceDataType = FStateTreeSetTickIntervalInstanceData;
+	virtual const UStruct* GetInstanceDataType() const override { return FInstanceDataType::StaticStruct(); }
+
+	/** Constructor */
+	FStateTreeSetTickIntervalTask();
+
+	/** Runs when the owning state is entered */
+	virtual EStateTreeRunStatus EnterState(FStateTreeExecutionContext& Context, const FStateTreeTransitionResult& Transition) const override;
+
+	/** Runs when the owning state is exited */
+	virtual void ExitState(FStateTreeExecutionContext& Context, const FStateTreeTransitionResult& Transition) const override;
+
+#if WITH_EDITOR
+	virtual FText GetDescription(const FGuid& ID, FStateTreeDataView InstanceDataView, const IStateTreeBindingLookup& BindingLookup, EStateTreeNodeFormatting Formatting = EStateTreeNodeFormatting::Text) const override;
+#endif // WITH_EDITOR
+};
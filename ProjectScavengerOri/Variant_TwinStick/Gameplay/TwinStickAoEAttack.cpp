@@ -8,11 +8,16 @@
 #include "Engine/World.h"
 #include "TimerManager.h"
 #include "TwinStickNPC.h"
+#include "TwinStickNPCSpatialIndex.h"
+#include "TwinStickGameMode.h"
 
 ATwinStickAoEAttack::ATwinStickAoEAttack()
 {
  	PrimaryActorTick.bCanEverTick = true;
 
+	// only tick while the AoE is active
+	PrimaryActorTick.bStartWithTickEnabled = false;
+
 	// create the root component
 	RootComponent = CreateDefaultSubobject<USceneComponent>(TEXT("Root"));
 
@@ -27,13 +32,10 @@ ATwinStickAoEAttack::ATwinStickAoEAttack()
 	CollisionSphere->SetupAttachment(RootComponent);
 
 	CollisionSphere->SetSphereRadius(750.0f);
-	CollisionSphere->SetNotifyRigidBodyCollision(true);
-	CollisionSphere->SetCollisionEnabled(ECollisionEnabled::QueryOnly);
-	CollisionSphere->SetCollisionObjectType(ECC_WorldDynamic);
-	CollisionSphere->SetCollisionResponseToAllChannels(ECR_Ignore);
-	CollisionSphere->SetCollisionResponseToChannel(ECC_Pawn, ECR_Overlap);
 
-	CollisionSphere->OnComponentBeginOverlap.AddDynamic(this, &ATwinStickAoEAttack::OnAoEOverlap);
+	// the sphere only provides the radius, so keep it out of the physics scene
+	CollisionSphere->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+	CollisionSphere->SetGenerateOverlapEvents(false);
 }
 
 void ATwinStickAoEAttack::BeginPlay()
@@ -55,24 +57,25 @@ void ATwinStickAoEAttack::EndPlay(EEndPlayReason::Type EndPlayReason)
 	GetWorld()->GetTimerManager().ClearTimer(StopAoETimer);
 }
 
+void ATwinStickAoEAttack::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	// catch NPCs that entered the AoE since the last tick
+	if (bIsAoEActive)
+	{
+		ApplyAoE();
+	}
+}
+
 void ATwinStickAoEAttack::StartAoE()
 {
 	// raise the active flag
 	bIsAoEActive = true;
 
-	// find all actors overlapping the NPC
-	TArray<AActor*> Overlaps;
-	CollisionSphere->GetOverlappingActors(Overlaps, ATwinStickNPC::StaticClass());
-
-	// process each overlapping actor
-	for (AActor* Current : Overlaps)
-	{
-		if (ATwinStickNPC* NPC = Cast<ATwinStickNPC>(Current))
-		{
-			// tell the NPC it's been hit
-			NPC->ProjectileImpact(FVector::ZeroVector);
-		}
-	}
+	// hit everything that's already inside, then keep checking every tick
+	ApplyAoE();
+	SetActorTickEnabled(true);
 }
 
 void ATwinStickAoEAttack::StopAoE()
@@ -80,6 +83,9 @@ void ATwinStickAoEAttack::StopAoE()
 	// drop the active flag
 	bIsAoEActive = false;
 
+	// stop checking for NPCs
+	SetActorTickEnabled(false);
+
 	// stop the damage tick timer
 	GetWorld()->GetTimerManager().ClearTimer(StartAoETimer);
 
@@ -87,16 +93,37 @@ void ATwinStickAoEAttack::StopAoE()
 	BP_AoEFinished();
 }
 
-void ATwinStickAoEAttack::OnAoEOverlap(UPrimitiveComponent* OverlappedComponent, AActor* OtherActor, UPrimitiveComponent* OtherComp, int32 OtherBodyIndex, bool bFromSweep, const FHitResult& SweepResult)
+void ATwinStickAoEAttack::ApplyAoE()
 {
-	// is the explosion active?
-	if (bIsAoEActive)
+	UTwinStickNPCSpatialIndex* SpatialIndex = GetWorld()->GetSubsystem<UTwinStickNPCSpatialIndex>();
+
+	if (!SpatialIndex)
+	{
+		return;
+	}
+
+	// find the NPCs inside the AoE radius
+	QueryResults.Reset();
+	SpatialIndex->QueryRadius(CollisionSphere->GetComponentLocation(), CollisionSphere->GetScaledSphereRadius(), QueryResults);
+
+	KillScores.Reset();
+
+	for (ATwinStickNPC* NPC : QueryResults)
+	{
+		// kill the NPC and save its score for the batch update.
+		// NPCs that were already hit are rejected by Kill, and pooled NPCs reused while the AoE is active can be hit again
+		if (NPC->Kill())
+		{
+			KillScores.Add(NPC->GetScore());
+		}
+	}
+
+	// award all the points at once
+	if (KillScores.Num() > 0)
 	{
-		// did we overlap an NPC?
-		if (ATwinStickNPC* NPC = Cast<ATwinStickNPC>(OtherActor))
+		if (ATwinStickGameMode* GM = Cast<ATwinStickGameMode>(GetWorld()->GetAuthGameMode()))
 		{
-			// tell the NPC it's been hit
-			NPC->ProjectileImpact(FVector::ZeroVector);
+			GM->ScoreKills(KillScores);
 		}
 	}
 }
@@ -8,10 +8,13 @@
 
 class UStaticMeshComponent;
 class USphereComponent;
+class ATwinStickNPC;
 
 /**
  *  A simple persistent AoE attack.
  *  Damages characters that enter for as long as it's active
+ *  While active, NPCs inside are found with one radius query against the NPC spatial index per tick
+ *  instead of tracking physics overlaps, and their kills are scored as a single batch
  */
 UCLASS(abstract)
 class ATwinStickAoEAttack : public AActor
@@ -22,7 +25,7 @@ class ATwinStickAoEAttack : public AActor
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category="Components", meta = (AllowPrivateAccess = "true"))
 	UStaticMeshComponent* SphereVisual;
 
-	/** Provides the collision volume for the AoE attack */
+	/** Provides the radius of the AoE attack. Collision is disabled, the radius is queried against the NPC spatial index */
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category="Components", meta = (AllowPrivateAccess = "true"))
 	USphereComponent* CollisionSphere;
 
@@ -45,6 +48,12 @@ protected:
 	/** While true, the AoE will damage anything that overlaps it */
 	bool bIsAoEActive = false;
 
+	/** NPCs found by the current radius query. Kept around to avoid reallocating every tick */
+	TArray<ATwinStickNPC*> QueryResults;
+
+	/** Scores of the NPCs killed by the current query. Kept around to avoid reallocating every tick */
+	TArray<int32> KillScores;
+
 public:	
 	
 	/** Constructor */
@@ -58,6 +67,9 @@ protected:
 	/** Cleanup */
 	virtual void EndPlay(EEndPlayReason::Type EndPlayReason) override;
 
+	/** Damages NPCs inside the AoE while it's active */
+	virtual void Tick(float DeltaTime) override;
+
 protected:
 
 	/** Called when the start AoE timer triggers */
@@ -70,7 +82,6 @@ protected:
 	UFUNCTION(BlueprintImplementableEvent, Category="AoE Attack")
 	void BP_AoEFinished();
 
-	/** Handles collision with the AoE while it's active */
-	UFUNCTION()
-	void OnAoEOverlap(UPrimitiveComponent* OverlappedComponent, AActor* OtherActor, UPrimitiveComponent* OtherComp, int32 OtherBodyIndex, bool bFromSweep, const FHitResult& SweepResult);
+	/** Kills every NPC inside the AoE that hasn't been hit by it yet and scores them in one batch */
+	void ApplyAoE();
 };
@@ -6,6 +6,7 @@
 #include "Components/SphereComponent.h"
 #include "TwinStickCharacter.h"
 #include "Components/StaticMeshComponent.h"
+#include "Managers/PoolableComponent.h"
 
 ATwinStickPickup::ATwinStickPickup()
 {
@@ -31,6 +32,9 @@ ATwinStickPickup::ATwinStickPickup()
 
 	Mesh->SetCollisionProfileName(FName("NoCollision"));
 
+	// create the poolable component
+	Poolable = CreateDefaultSubobject<UPoolableComponent>(TEXT("Poolable"));
+
 }
 
 void ATwinStickPickup::NotifyActorBeginOverlap(AActor* OtherActor)
@@ -43,7 +47,7 @@ void ATwinStickPickup::NotifyActorBeginOverlap(AActor* OtherActor)
 		// give the pickup to the player
 		PlayerCharacter->AddPickup();
 
-		// destroy this pickup
-		Destroy();
+		// return this pickup to the pool
+		Poolable->ReturnToPool();
 	}
 }
\ No newline at end of file
@@ -8,9 +8,11 @@
 
 class USphereComponent;
 class UStaticMeshComponent;
+class UPoolableComponent;
 
 /**
  *  A simple pickup for a Twin Stick Shooter game
+ *  Pickups are acquired from the actor pool and return to it when collected
  */
 UCLASS(abstract)
 class ATwinStickPickup : public AActor
@@ -25,6 +27,10 @@ class ATwinStickPickup : public AActor
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Components", meta = (AllowPrivateAccess = "true"))
 	UStaticMeshComponent* Mesh;
 
+	/** Lets the actor pool reuse this pickup */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Components", meta = (AllowPrivateAccess = "true"))
+	UPoolableComponent* Poolable;
+
 public:	
 
 	/** Constructor */
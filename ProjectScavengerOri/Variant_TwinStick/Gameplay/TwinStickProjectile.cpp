@@ -6,14 +6,19 @@
 #include "GameFramework/ProjectileMovementComponent.h"
 #include "Components/StaticMeshComponent.h"
 #include "TwinStickNPC.h"
+#include "Managers/PoolableComponent.h"
+#include "Managers/PoolSubsystem.h"
 
 ATwinStickProjectile::ATwinStickProjectile()
 {
  	PrimaryActorTick.bCanEverTick = true;
 
-	// this actor will be destroyed automatically once InitialLifeSpan expires
+	// this actor will be returned to the pool automatically once InitialLifeSpan expires
 	InitialLifeSpan = 2.0f;
 
+	// create the poolable component
+	Poolable = CreateDefaultSubobject<UPoolableComponent>(TEXT("Poolable"));
+
 	// create the collision sphere and set it as the root component
 	RootComponent = CollisionSphere = CreateDefaultSubobject<USphereComponent>(TEXT("Collision Sphere"));
 
@@ -40,9 +45,34 @@ ATwinStickProjectile::ATwinStickProjectile()
 	ProjectileMovement->bShouldBounce = true;
 	ProjectileMovement->bForceSubStepping = true;
 
+	// prewarmed projectiles are spawned straight into the pool, so movement is only activated once we're in flight
+	ProjectileMovement->bAutoActivate = false;
+
 	ProjectileMovement->OnProjectileStop.AddDynamic(this, &ATwinStickProjectile::OnProjectileStop);
 }
 
+void ATwinStickProjectile::BeginPlay()
+{
+	Super::BeginPlay();
+
+	// the pool returns the projectile when its life span expires, so it isn't destroyed by the actor life span
+	const float LifeSpan = InitialLifeSpan;
+	SetLifeSpan(0.0f);
+	Poolable->SetAutoReturnTime(LifeSpan);
+
+	// prewarmed projectiles stay asleep until the pool activates them. Projectiles spawned without a pool start flying now
+	if (!Poolable->IsInPool())
+	{
+		ProjectileMovement->Activate(true);
+	}
+}
+
+void ATwinStickProjectile::AdvanceFlight(float DeltaSeconds)
+{
+	// sweep so the catch up still hits whatever is in the way
+	AddActorWorldOffset(ProjectileMovement->Velocity * DeltaSeconds, true);
+}
+
 void ATwinStickProjectile::NotifyHit(class UPrimitiveComponent* MyComp, AActor* Other, class UPrimitiveComponent* OtherComp, bool bSelfMoved, FVector HitLocation, FVector HitNormal, FVector NormalImpulse, const FHitResult& Hit)
 {
 	Super::NotifyHit(MyComp, Other, OtherComp, bSelfMoved, HitLocation, HitNormal, NormalImpulse, Hit);
@@ -53,13 +83,31 @@ void ATwinStickProjectile::NotifyHit(class UPrimitiveComponent* MyComp, AActor*
 		// tell the NPC it's been hit
 		NPC->ProjectileImpact(FVector::ZeroVector);
 
-		// destroy this projectile
-		Destroy();
+		// return this projectile to the pool
+		ReleaseProjectile();
 	}
 }
 
 void ATwinStickProjectile::OnProjectileStop(const FHitResult& ImpactResult)
 {
-	// destroy this actor immediately
+	// return this projectile to the pool immediately
+	ReleaseProjectile();
+}
+
+void ATwinStickProjectile::ReleaseProjectile()
+{
+	// we may be hit again in the same frame after we've already been returned
+	if (Poolable->IsInPool())
+	{
+		return;
+	}
+
+	if (UPoolSubsystem* PoolSubsystem = GetWorld()->GetSubsystem<UPoolSubsystem>())
+	{
+		PoolSubsystem->ReleaseToPool(this);
+		return;
+	}
+
+	// destroy this actor
 	Destroy();
 }
@@ -9,9 +9,11 @@
 class USphereComponent;
 class UStaticMeshComponent;
 class UProjectileMovementComponent;
+class UPoolableComponent;
 
 /**
  *  A simple bouncing projectile for a Twin Stick shooter game
+ *  Returns to the actor pool instead of being destroyed, so shooting doesn't spawn actors
  */
 UCLASS(abstract)
 class ATwinStickProjectile : public AActor
@@ -30,18 +32,31 @@ class ATwinStickProjectile : public AActor
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Components", meta = (AllowPrivateAccess = "true"))
 	UProjectileMovementComponent* ProjectileMovement;
 
+	/** Lets the actor pool reuse this projectile */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Components", meta = (AllowPrivateAccess = "true"))
+	UPoolableComponent* Poolable;
+
 public:	
 
 	/** Constructor */
 	ATwinStickProjectile();
 
+	/** Moves the projectile along its flight by the given time. Used to catch up shots fired between frames */
+	void AdvanceFlight(float DeltaSeconds);
+
 	/** Handles collisions */
 	virtual void NotifyHit(class UPrimitiveComponent* MyComp, AActor* Other, class UPrimitiveComponent* OtherComp, bool bSelfMoved, FVector HitLocation, FVector HitNormal, FVector NormalImpulse, const FHitResult& Hit) override;
 
 protected:
+
+	/** Gameplay initialization */
+	virtual void BeginPlay() override;
 	
 	/** Handles collisions that stop this projectile from moving */
 	UFUNCTION()
 	void OnProjectileStop(const FHitResult& ImpactResult);
 
+	/** Returns this projectile to the pool, or destroys it if there's no pool */
+	void ReleaseProjectile();
+
 };
@@ -12,7 +12,8 @@
 #include "Kismet/KismetMathLibrary.h"
 #include "TwinStickProjectile.h"
 #include "Engine/World.h"
-#include "TimerManager.h"
+#include "Managers/CursorService.h"
+#include "Managers/PoolSubsystem.h"
 
 ATwinStickCharacter::ATwinStickCharacter()
 {
@@ -52,14 +53,20 @@ void ATwinStickCharacter::BeginPlay()
 	
 	// update the items count
 	UpdateItems();
+
+	// create the projectiles up front so shooting doesn't spawn actors
+	if (UPoolSubsystem* PoolSubsystem = GetWorld()->GetSubsystem<UPoolSubsystem>())
+	{
+		PoolSubsystem->Prewarm(ProjectileClass, ProjectilePoolSize);
+	}
+
+	// the first auto fire shot is available immediately
+	AutoFireAccumulator = 1.0f / RoundsPerSecond;
 }
 
 void ATwinStickCharacter::EndPlay(EEndPlayReason::Type EndPlayReason)
 {
 	Super::EndPlay(EndPlayReason);
-
-	/** Clear the autofire timer */
-	GetWorld()->GetTimerManager().ClearTimer(AutoFireTimer);
 }
 
 void ATwinStickCharacter::NotifyControllerChanged()
@@ -74,6 +81,9 @@ void ATwinStickCharacter::Tick(float DeltaTime)
 {
 	Super::Tick(DeltaTime);
 
+	// fire any auto fire shots that are due
+	UpdateAutoFire(DeltaTime);
+
 	// get the current rotation
 	const FRotator OldRotation = GetActorRotation();
 
@@ -83,16 +93,16 @@ void ATwinStickCharacter::Tick(float DeltaTime)
 		if (PlayerController)
 		{
 			// get the cursor world location
-			FHitResult OutHit; 
-			PlayerController->GetHitResultUnderCursorByChannel(MouseAimTraceChannel, true, OutHit);
-
-			// find the aim rotation 
-			const FRotator AimRot = UKismetMathLibrary::FindLookAtRotation(GetActorLocation(), OutHit.Location);
+			FVector CursorLocation;
 
-			// save the aim angle
-			AimAngle = AimRot.Yaw;
+			if (GetMouseAimLocation(CursorLocation))
+			{
+				// find the aim rotation 
+				const FRotator AimRot = UKismetMathLibrary::FindLookAtRotation(GetActorLocation(), CursorLocation);
 
-			
+				// save the aim angle
+				AimAngle = AimRot.Yaw;
+			}
 
 			// update the yaw, reuse the pitch and roll
 			SetActorRotation(FRotator(OldRotation.Pitch, AimAngle, OldRotation.Roll));
@@ -109,6 +119,55 @@ void ATwinStickCharacter::Tick(float DeltaTime)
 	}
 }
 
+bool ATwinStickCharacter::GetMouseAimLocation(FVector& OutLocation)
+{
+	UCursorService* CursorService = UCursorService::Get(PlayerController);
+
+	if (!CursorService)
+	{
+		return false;
+	}
+
+	if (MouseAimMode == ETwinStickMouseAimMode::MovementPlane)
+	{
+		// the character moves on a plane, so intersect the cursor ray with the plane through the character
+		// instead of running a collision query. Only the yaw towards that point matters
+		FVector PlaneNormal = GetCharacterMovement()->bConstrainToPlane ? GetCharacterMovement()->GetPlaneConstraintNormal() : FVector::UpVector;
+
+		if (PlaneNormal.IsNearlyZero())
+		{
+			PlaneNormal = FVector::UpVector;
+		}
+
+		FVector RayOrigin, RayDirection;
+
+		if (CursorService->GetCursorRay(RayOrigin, RayDirection))
+		{
+			const double Denominator = RayDirection | PlaneNormal;
+
+			if (!FMath::IsNearlyZero(Denominator))
+			{
+				const double Distance = ((GetActorLocation() - RayOrigin) | PlaneNormal) / Denominator;
+
+				if (Distance >= 0.0)
+				{
+					OutLocation = RayOrigin + RayDirection * Distance;
+					return true;
+				}
+			}
+		}
+
+		// the ray is parallel to or points away from the plane
+		if (!bMouseAimTraceFallback)
+		{
+			return false;
+		}
+	}
+
+	// use the cursor service's cached trace
+	return CursorService->GetCursorLocation(MouseAimTraceChannel, OutLocation);
+}
+
 void ATwinStickCharacter::SetupPlayerInputComponent(UInputComponent* PlayerInputComponent)
 {
 	Super::SetupPlayerInputComponent(PlayerInputComponent);
@@ -207,18 +266,8 @@ void ATwinStickCharacter::DoAim(float AxisX, float AxisY)
 		PlayerController->SetShowMouseCursor(false);
 	}
 
-	// are we on autofire cooldown?
-	if (!bAutoFireActive)
-	{
-		// set ourselves on cooldown
-		bAutoFireActive = true;
-
-		// fire a projectile
-		DoShoot();
-
-		// schedule autofire cooldown reset
-		GetWorld()->GetTimerManager().SetTimer(AutoFireTimer, this, &ATwinStickCharacter::ResetAutoFire, AutoFireDelay, false);
-	}
+	// auto fire on the next tick. The fire rate is handled there
+	bAutoFireActive = true;
 }
 
 void ATwinStickCharacter::DoDash()
@@ -235,14 +284,8 @@ void ATwinStickCharacter::DoDash()
 
 void ATwinStickCharacter::DoShoot()
 {
-	// get the actor transform
-	FTransform ProjectileTransform = GetActorTransform();
-
-	// apply the projectile spawn offset
-	FVector ProjectileLocation = ProjectileTransform.GetLocation() + ProjectileTransform.GetRotation().RotateVector(FVector::ForwardVector * ProjectileOffset);
-	ProjectileTransform.SetLocation(ProjectileLocation);
-
-	ATwinStickProjectile* Projectile = GetWorld()->SpawnActor<ATwinStickProjectile>(ProjectileClass, ProjectileTransform);
+	// fire a single projectile right away
+	FireProjectile(0.0f);
 }
 
 void ATwinStickCharacter::DoAoEAttack()
@@ -302,9 +345,65 @@ void ATwinStickCharacter::UpdateItems()
 	}
 }
 
-void ATwinStickCharacter::ResetAutoFire()
+void ATwinStickCharacter::UpdateAutoFire(float DeltaTime)
 {
-	// reset the autofire flag
+	const float ShotInterval = 1.0f / RoundsPerSecond;
+
+	AutoFireAccumulator += DeltaTime;
+
+	if (!bAutoFireActive)
+	{
+		// keep at most one shot ready while not firing, so releasing the stick doesn't bank shots
+		AutoFireAccumulator = FMath::Min(AutoFireAccumulator, ShotInterval);
+		return;
+	}
+
+	// the aim input has to keep triggering to keep firing
 	bAutoFireActive = false;
+
+	// fire every shot that came due since the last tick, so the fire rate doesn't depend on the frame rate.
+	// Each shot is moved ahead by the time since it was due, so shots in the same frame don't bunch up
+	int32 Shots = 0;
+
+	while (AutoFireAccumulator >= ShotInterval && Shots < MaxShotsPerFrame)
+	{
+		AutoFireAccumulator -= ShotInterval;
+		FireProjectile(AutoFireAccumulator);
+		++Shots;
+	}
+
+	// drop the shots beyond the per frame cap after a long frame
+	AutoFireAccumulator = FMath::Min(AutoFireAccumulator, ShotInterval);
+}
+
+void ATwinStickCharacter::FireProjectile(float TimeOffset)
+{
+	// get the actor transform
+	FTransform ProjectileTransform = GetActorTransform();
+
+	// apply the projectile spawn offset
+	FVector ProjectileLocation = ProjectileTransform.GetLocation() + ProjectileTransform.GetRotation().RotateVector(FVector::ForwardVector * ProjectileOffset);
+	ProjectileTransform.SetLocation(ProjectileLocation);
+
+	ATwinStickProjectile* Projectile = nullptr;
+
+	// reuse a projectile from the pool if possible
+	if (UPoolSubsystem* PoolSubsystem = GetWorld()->GetSubsystem<UPoolSubsystem>())
+	{
+		FPoolSpawnInfo SpawnInfo;
+		SpawnInfo.Transform = ProjectileTransform;
+
+		Projectile = Cast<ATwinStickProjectile>(PoolSubsystem->AcquireFromPool(ProjectileClass, SpawnInfo, FPoolSpawnOptions()));
+
+	} else {
+
+		Projectile = GetWorld()->SpawnActor<ATwinStickProjectile>(ProjectileClass, ProjectileTransform);
+	}
+
+	// catch up with the time since the shot was due
+	if (Projectile && TimeOffset > 0.0f)
+	{
+		Projectile->AdvanceFlight(TimeOffset);
+	}
 }
 
@@ -15,6 +15,17 @@ class UInputAction;
 class ATwinStickAoEAttack;
 class ATwinStickProjectile;
 
+/** How mouse aim finds the aim point under the cursor */
+UENUM(BlueprintType)
+enum class ETwinStickMouseAimMode : uint8
+{
+	/** Intersects the cursor ray with the character's movement plane, without a collision query */
+	MovementPlane,
+
+	/** Traces the mouse aim channel under the cursor */
+	Trace
+};
+
 /**
  *  A player-controlled character for a Twin Stick Shooter game
  *  Automatically rotates to face the aim direction.
@@ -63,6 +74,14 @@ protected:
 	UPROPERTY(EditAnywhere, Category="Input")
 	TEnumAsByte<ETraceTypeQuery> MouseAimTraceChannel;
 
+	/** How to find the aim point under the cursor. The movement plane is enough for flat arenas */
+	UPROPERTY(EditAnywhere, Category="Input")
+	ETwinStickMouseAimMode MouseAimMode = ETwinStickMouseAimMode::MovementPlane;
+
+	/** If true, movement plane aim falls back to a trace when the cursor ray misses the plane */
+	UPROPERTY(EditAnywhere, Category="Input", meta = (EditCondition = "MouseAimMode == ETwinStickMouseAimMode::MovementPlane"))
+	bool bMouseAimTraceFallback = false;
+
 	/** Impulse to apply to the character when dashing */
 	UPROPERTY(EditAnywhere, Category="Dash", meta = (ClampMin = 0, ClampMax = 10000, Units = "cm/s"))
 	float DashImpulse = 2500.0f;
@@ -110,15 +129,23 @@ protected:
 	/** Last held move input */
 	FVector2D LastMoveInput;
 
-	/** If true, the player is auto firing while stick aiming */
+	/** If true, the player has stick aimed since the last tick and should auto fire */
 	bool bAutoFireActive = false;
 
-	/** Time to wait between autofire attempts */
-	UPROPERTY(EditAnywhere, Category="Aim", meta = (ClampMin = 0, ClampMax = 5, Units = "s"))
-	float AutoFireDelay = 0.2f;
+	/** Number of projectiles fired per second while stick aiming */
+	UPROPERTY(EditAnywhere, Category="Aim", meta = (ClampMin = 0.1, ClampMax = 100))
+	float RoundsPerSecond = 5.0f;
+
+	/** Max projectiles fired in a single frame while stick aiming. Shots beyond this after a long frame are dropped */
+	UPROPERTY(EditAnywhere, Category="Aim", meta = (ClampMin = 1, ClampMax = 32))
+	int32 MaxShotsPerFrame = 8;
+
+	/** Time accumulated towards the next auto fire shot. Capped at one shot interval while not firing */
+	float AutoFireAccumulator = 0.0f;
 
-	/** Timer to handle stick autofire */
-	FTimerHandle AutoFireTimer;
+	/** Number of projectiles to create in the actor pool when play starts */
+	UPROPERTY(EditAnywhere, Category="Projectile", meta = (ClampMin = 0, ClampMax = 200))
+	int32 ProjectilePoolSize = 16;
 
 public:
 	
@@ -164,6 +191,9 @@ protected:
 	/** Performs an AoE Attack */
 	void AoEAttack(const FInputActionValue& Value);
 
+	/** Finds the world location the mouse is aiming at. Returns false if there is none */
+	bool GetMouseAimLocation(FVector& OutLocation);
+
 public:
 
 	/** Handles move inputs from both input actions and touch interface */
@@ -207,6 +237,9 @@ protected:
 	/** Updates the items counter on the Game Mode */
 	void UpdateItems();
 
-	/** Resets stick the aim autofire flag after the autofire timer has expired */
-	void ResetAutoFire();
+	/** Fires the auto fire shots accumulated since the last tick */
+	void UpdateAutoFire(float DeltaTime);
+
+	/** Fires a projectile from the actor pool. TimeOffset moves it ahead by the time since it should have been fired */
+	void FireProjectile(float TimeOffset);
 };
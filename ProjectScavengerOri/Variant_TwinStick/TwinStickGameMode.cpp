@@ -3,6 +3,7 @@
 
 #include "TwinStickGameMode.h"
 #include "TwinStickUI.h"
+#include "TwinStickCharacter.h"
 #include "Engine/World.h"
 #include "TimerManager.h"
 #include "Kismet/GameplayStatics.h"
@@ -11,6 +12,9 @@ void ATwinStickGameMode::BeginPlay()
 {
 	// create the UI widget if it hasn't already
 	CreateUI();
+
+	// score the kills buffered during each frame once all actors have ticked
+	PostActorTickHandle = FWorldDelegates::OnWorldPostActorTick.AddUObject(this, &ATwinStickGameMode::OnWorldPostActorTick);
 }
 
 void ATwinStickGameMode::EndPlay(EEndPlayReason::Type EndPlayReason)
@@ -19,6 +23,10 @@ void ATwinStickGameMode::EndPlay(EEndPlayReason::Type EndPlayReason)
 	
 	// clear the combo timer
 	GetWorld()->GetTimerManager().ClearTimer(ComboTimer);
+
+	// stop scoring buffered kills
+	FWorldDelegates::OnWorldPostActorTick.Remove(PostActorTickHandle);
+	PendingKillScores.Reset();
 }
 
 void ATwinStickGameMode::ItemUsed(int32 Value)
@@ -30,19 +38,59 @@ void ATwinStickGameMode::ItemUsed(int32 Value)
 	}
 
 	// update the UI
-	UIWidget->UpdateItems(Value);
+	UIWidget->SetItems(Value);
 }
 
 void ATwinStickGameMode::ScoreUpdate(int32 Value)
 {
-	// multiply the base score by the combo multiplier and add it to the score
-	Score += Value * Combo;
+	// buffer the kill until the end of the frame
+	PendingKillScores.Add(Value);
+}
 
-	// update the UI
-	UIWidget->UpdateScore(Score);
+void ATwinStickGameMode::ScoreKills(TConstArrayView<int32> Values)
+{
+	// buffer the kills until the end of the frame
+	PendingKillScores.Append(Values);
+}
 
-	// update the combo multiplier
-	ComboUpdate();
+void ATwinStickGameMode::OnWorldPostActorTick(UWorld* World, ELevelTick TickType, float DeltaSeconds)
+{
+	// only handle our own world
+	if (World == GetWorld() && PendingKillScores.Num() > 0)
+	{
+		ApplyPendingKills();
+	}
+}
+
+void ATwinStickGameMode::ApplyPendingKills()
+{
+	// kills only extend the combo cooldown while the multiplier hasn't gone past the cap
+	const int32 PreviousCombo = Combo;
+	const bool bResetCooldown = Combo <= ComboCap;
+
+	// score the kills in the order they were made
+	ComboUpdate(PendingKillScores);
+	PendingKillScores.Reset();
+
+	// ensure the UI widget is available
+	if (!UIWidget)
+	{
+		CreateUI();
+	}
+
+	// update the UI once for the whole frame
+	UIWidget->SetScore(Score);
+
+	if (Combo != PreviousCombo)
+	{
+		UIWidget->SetCombo(Combo);
+	}
+
+	// reset the cooldown timer once
+	if (bResetCooldown)
+	{
+		ResetComboCooldown();
+	}
 }
 
 void ATwinStickGameMode::CreateUI()
@@ -56,33 +104,54 @@ void ATwinStickGameMode::CreateUI()
 	UIWidget->AddToViewport(0);
 }
 
-void ATwinStickGameMode::ComboUpdate()
+void ATwinStickGameMode::ComboUpdate(TConstArrayView<int32> Values)
 {
-	// return
-	if (Combo > ComboCap)
+	// each kill adds its base score times the current multiplier, then advances the combo increment.
+	// The multiplier goes up on the kill that takes the increment past the max, so kills are scored in
+	// runs that share the same multiplier, one run per combo level
+	int32 First = 0;
+
+	while (First < Values.Num())
 	{
-		return;
-	}
+		int32 RunLength = Values.Num() - First;
 
-	// update the combo increment
-	++ComboIncrement;
+		// the multiplier no longer changes once it's past the cap
+		const bool bAdvancing = Combo <= ComboCap;
 
-	// is it time to increase the multiplier?
-	if (ComboIncrement > ComboIncrementMax)
-	{
-		// reset the combo increment
-		ComboIncrement = 0;
+		if (bAdvancing)
+		{
+			RunLength = FMath::Min(RunLength, ComboIncrementMax + 1 - ComboIncrement);
+		}
 
-		// increase the combo multiplier
-		++Combo;
+		// multiply the base scores in this run by the combo multiplier and add them to the score
+		int32 RunScore = 0;
 
-		// update the UI
-		UIWidget->UpdateCombo(Combo);
+		for (int32 Index = First; Index < First + RunLength; ++Index)
+		{
+			RunScore += Values[Index];
+		}
 
-	}
+		Score += RunScore * Combo;
+		First += RunLength;
 
-	// reset the cooldown timer
-	ResetComboCooldown();
+		if (!bAdvancing)
+		{
+			break;
+		}
+
+		// update the combo increment
+		ComboIncrement += RunLength;
+
+		// is it time to increase the multiplier?
+		if (ComboIncrement > ComboIncrementMax)
+		{
+			// reset the combo increment
+			ComboIncrement = 0;
+
+			// increase the combo multiplier
+			++Combo;
+		}
+	}
 }
 
 void ATwinStickGameMode::ResetComboCooldown()
@@ -103,7 +172,7 @@ void ATwinStickGameMode::ResetCombo()
 		--Combo;
 
 		// update the UI
-		UIWidget->UpdateCombo(Combo);
+		UIWidget->SetCombo(Combo);
 
 		// reset the cooldown timer
 		ResetComboCooldown();
@@ -127,3 +196,56 @@ void ATwinStickGameMode::DecreaseNPCs()
 	// decrease the NPC counter
 	--NPCCount;
 }
+
+void ATwinStickGameMode::RegisterPlayerCharacter(ATwinStickCharacter* PlayerCharacter)
+{
+	// ignore invalid or already registered characters
+	if (!PlayerCharacter || PlayerCharacters.Contains(PlayerCharacter))
+	{
+		return;
+	}
+
+	PlayerCharacters.Add(PlayerCharacter);
+
+	// let listeners know the registry changed
+	OnPlayersChanged.Broadcast();
+}
+
+void ATwinStickGameMode::UnregisterPlayerCharacter(ATwinStickCharacter* PlayerCharacter)
+{
+	// remove the character along with any stale entries
+	const int32 NumRemoved = PlayerCharacters.RemoveAllSwap([PlayerCharacter](const TWeakObjectPtr<ATwinStickCharacter>& Registered)
+	{
+		return !Registered.IsValid() || Registered.Get() == PlayerCharacter;
+	});
+
+	// let listeners know the registry changed
+	if (NumRemoved > 0)
+	{
+		OnPlayersChanged.Broadcast();
+	}
+}
+
+ATwinStickCharacter* ATwinStickGameMode::GetNearestPlayerCharacter(const FVector& Location) const
+{
+	ATwinStickCharacter* NearestCharacter = nullptr;
+	double NearestDistSq = TNumericLimits<double>::Max();
+
+	for (const TWeakObjectPtr<ATwinStickCharacter>& PlayerCharacter : PlayerCharacters)
+	{
+		if (!PlayerCharacter.IsValid())
+		{
+			continue;
+		}
+
+		const double DistSq = FVector::DistSquared(PlayerCharacter->GetActorLocation(), Location);
+
+		if (DistSq < NearestDistSq)
+		{
+			NearestDistSq = DistSq;
+			NearestCharacter = PlayerCharacter.Get();
+		}
+	}
+
+	return NearestCharacter;
+}
@@ -7,10 +7,15 @@
 #include "TwinStickGameMode.generated.h"
 
 class UTwinStickUI;
+class ATwinStickCharacter;
+
+DECLARE_MULTICAST_DELEGATE(FOnTwinStickPlayersChanged);
 
 /**
  *  Simple Game Mode for a Twin Stick Shooter game.
  *  Manages the score and UI
+ *  Kills are buffered and scored once at the end of the frame, with a single combo, timer and UI update
+ *  Keeps a registry of player characters so AI can find the nearest player without per-frame lookups
  */
 UCLASS(abstract)
 class ATwinStickGameMode : public AGameModeBase
@@ -52,15 +57,27 @@ protected:
 
 	FTimerHandle ComboTimer;
 
-	/** Max number of NPCs to allow in the level at once */
+	/** Base scores of the kills made this frame, in order */
+	TArray<int32> PendingKillScores;
+
+	/** Handle for the end of frame callback that scores the buffered kills */
+	FDelegateHandle PostActorTickHandle;
+
+	/** Max number of NPC actors to allow in the level at once. Data-only horde entities don't count towards this cap */
 	UPROPERTY(EditAnywhere, Category="Twin Stick", meta=(ClampMin = 0, ClampMax = 100))
 	int32 NPCCap = 20;
 
 	/** Current number of NPCs in the level */
 	int32 NPCCount = 0;
 
+	/** Player characters currently possessed by a player controller */
+	TArray<TWeakObjectPtr<ATwinStickCharacter>> PlayerCharacters;
+
 public:
 
+	/** Broadcast every time a player character is registered or unregistered */
+	FOnTwinStickPlayersChanged OnPlayersChanged;
+
 	/** Gameplay initialization */
 	virtual void BeginPlay() override;
 
@@ -72,16 +89,25 @@ public:
 	/** Called when an item has been used */
 	void ItemUsed(int32 Value);
 
-	/** Increments the score by the given value */
+	/** Buffers a kill worth the given base score. Scored at the end of the frame */
 	void ScoreUpdate(int32 Value);
 
+	/** Buffers a batch of kills. Scored at the end of the frame as if they happened one after another */
+	void ScoreKills(TConstArrayView<int32> Values);
+
 protected:
 
 	/** Creates the UI widget if it hasn't been created already */
 	void CreateUI();
 
-	/** Updates the combo multiplier */
-	void ComboUpdate();
+	/** Scores the buffered kills and updates the combo, timer and UI once */
+	void ApplyPendingKills();
+
+	/** Scores a sequence of kills and advances the combo multiplier. Runs in one step per combo level instead of per kill */
+	void ComboUpdate(TConstArrayView<int32> Values);
+
+	/** Called at the end of every frame's actor tick */
+	void OnWorldPostActorTick(UWorld* World, ELevelTick TickType, float DeltaSeconds);
 
 	/** Resets the combo cooldown timer */
 	void ResetComboCooldown();
@@ -99,4 +125,15 @@ public:
 
 	/** Decreases the NPC count */
 	void DecreaseNPCs();
+
+public:
+
+	/** Adds a player character to the registry. Called on possession */
+	void RegisterPlayerCharacter(ATwinStickCharacter* PlayerCharacter);
+
+	/** Removes a player character from the registry. Called on death */
+	void UnregisterPlayerCharacter(ATwinStickCharacter* PlayerCharacter);
+
+	/** Returns the registered player character nearest to the given location, or nullptr if there are none */
+	ATwinStickCharacter* GetNearestPlayerCharacter(const FVector& Location) const;
 };
@@ -7,6 +7,7 @@
 #include "Kismet/GameplayStatics.h"
 #include "GameFramework/PlayerStart.h"
 #include "TwinStickCharacter.h"
+#include "TwinStickGameMode.h"
 #include "Engine/LocalPlayer.h"
 #include "Engine/World.h"
 #include "Blueprint/UserWidget.h"
@@ -70,10 +71,22 @@ void ATwinStickPlayerController::OnPossess(APawn* InPawn)
 
 	// subscribe to the pawn's OnDestroyed delegate
 	InPawn->OnDestroyed.AddDynamic(this, &ATwinStickPlayerController::OnPawnDestroyed);
+
+	// register the character so AI can target it
+	if (ATwinStickGameMode* GM = Cast<ATwinStickGameMode>(GetWorld()->GetAuthGameMode()))
+	{
+		GM->RegisterPlayerCharacter(Cast<ATwinStickCharacter>(InPawn));
+	}
 }
 
 void ATwinStickPlayerController::OnPawnDestroyed(AActor* DestroyedActor)
 {
+	// unregister the dead character so AI stops targeting it
+	if (ATwinStickGameMode* GM = Cast<ATwinStickGameMode>(GetWorld()->GetAuthGameMode()))
+	{
+		GM->UnregisterPlayerCharacter(Cast<ATwinStickCharacter>(DestroyedActor));
+	}
+
 	// find the player start
 	TArray<AActor*> ActorList;
 	UGameplayStatics::GetAllActorsOfClass(GetWorld(), APlayerStart::StaticClass(), ActorList);
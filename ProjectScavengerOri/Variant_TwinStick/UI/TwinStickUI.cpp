@@ -2,4 +2,127 @@
 
 
 #include "TwinStickUI.h"
+#include "Blueprint/WidgetTree.h"
+#include "Components/InvalidationBox.h"
+#include "Engine/World.h"
+#include "TimerManager.h"
 
+void UTwinStickUI::NativeOnInitialized()
+{
+	Super::NativeOnInitialized();
+
+	// the score widgets only change on kills and pickups, so cache their paint output
+	// and let Slate skip prepass and paint for the whole tree until a value changes
+	if (bUseInvalidationBox && WidgetTree && WidgetTree->RootWidget && !WidgetTree->RootWidget->IsA<UInvalidationBox>())
+	{
+		UWidget* Content = WidgetTree->RootWidget;
+
+		UInvalidationBox* InvalidationBox = WidgetTree->ConstructWidget<UInvalidationBox>(UInvalidationBox::StaticClass(), TEXT("RootInvalidationBox"));
+		InvalidationBox->SetCanCache(true);
+
+		WidgetTree->RootWidget = InvalidationBox;
+		InvalidationBox->SetContent(Content);
+	}
+
+	// push the initial values once, so the setters can drop values that match them
+	bItemsDirty = true;
+	bScoreDirty = true;
+	bComboDirty = true;
+
+	RequestFlush();
+}
+
+void UTwinStickUI::NativeDestruct()
+{
+	// stop any pending flush
+	if (UWorld* World = GetWorld())
+	{
+		World->GetTimerManager().ClearTimer(FlushTimer);
+	}
+
+	Super::NativeDestruct();
+}
+
+void UTwinStickUI::SetItems(int32 Value)
+{
+	// ignore values that didn't change
+	if (Items == Value)
+	{
+		return;
+	}
+
+	Items = Value;
+	bItemsDirty = true;
+
+	RequestFlush();
+}
+
+void UTwinStickUI::SetScore(int32 Value)
+{
+	// ignore values that didn't change
+	if (Score == Value)
+	{
+		return;
+	}
+
+	Score = Value;
+	bScoreDirty = true;
+
+	RequestFlush();
+}
+
+void UTwinStickUI::SetCombo(int32 Value)
+{
+	// ignore values that didn't change
+	if (Combo == Value)
+	{
+		return;
+	}
+
+	Combo = Value;
+	bComboDirty = true;
+
+	RequestFlush();
+}
+
+void UTwinStickUI::RequestFlush()
+{
+	UWorld* World = GetWorld();
+
+	if (!World)
+	{
+		return;
+	}
+
+	// coalesce all the changes made this frame into a single update
+	FTimerManager& TimerManager = World->GetTimerManager();
+
+	if (!TimerManager.TimerExists(FlushTimer))
+	{
+		FlushTimer = TimerManager.SetTimerForNextTick(this, &UTwinStickUI::FlushChanges);
+	}
+}
+
+void UTwinStickUI::FlushChanges()
+{
+	FlushTimer.Invalidate();
+
+	// only call the handlers for the values that changed
+	if (bItemsDirty)
+	{
+		bItemsDirty = false;
+		UpdateItems(Items);
+	}
+
+	if (bScoreDirty)
+	{
+		bScoreDirty = false;
+		UpdateScore(Score);
+	}
+
+	if (bComboDirty)
+	{
+		bComboDirty = false;
+		UpdateCombo(Combo);
+	}
+}
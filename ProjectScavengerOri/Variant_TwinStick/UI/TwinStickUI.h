@@ -9,14 +9,66 @@
 /**
  *  A simple Twin Stick Shooter UI widget
  *  Provides a blueprint interface to expose score values to the UI
+ *  Values set from code are coalesced and pushed to Blueprint at most once per frame, and only when they change.
+ *  The widget tree is wrapped in an invalidation box so it's only repainted when a value actually changes
  */
 UCLASS(abstract)
 class UTwinStickUI : public UUserWidget
 {
 	GENERATED_BODY()
-	
+
+protected:
+
+	/** If true, the widget tree is wrapped in an invalidation box on initialization */
+	UPROPERTY(EditDefaultsOnly, Category="Performance")
+	bool bUseInvalidationBox = true;
+
+	/** Latest items value */
+	int32 Items = 0;
+
+	/** Latest score value */
+	int32 Score = 0;
+
+	/** Latest combo value */
+	int32 Combo = 1;
+
+	/** True if the items value changed since the last flush */
+	bool bItemsDirty = false;
+
+	/** True if the score value changed since the last flush */
+	bool bScoreDirty = false;
+
+	/** True if the combo value changed since the last flush */
+	bool bComboDirty = false;
+
+	/** Timer for the next flush */
+	FTimerHandle FlushTimer;
+
+protected:
+
+	/** Wraps the widget tree in an invalidation box */
+	virtual void NativeOnInitialized() override;
+
+	/** Cleanup */
+	virtual void NativeDestruct() override;
+
+	/** Schedules a flush for the next frame, if one isn't pending already */
+	void RequestFlush();
+
+	/** Calls the Blueprint handlers for the values that changed */
+	void FlushChanges();
+
 public:
 
+	/** Sets the items counter. Blueprint is updated on the next frame */
+	void SetItems(int32 Value);
+
+	/** Sets the score. Blueprint is updated on the next frame */
+	void SetScore(int32 Value);
+
+	/** Sets the combo multiplier. Blueprint is updated on the next frame */
+	void SetCombo(int32 Value);
+
 	/** Blueprint handler to update the items counter */
 	UFUNCTION(BlueprintImplementableEvent, Category="Score")
 	void UpdateItems(int32 Score);